@@ -79,6 +79,11 @@ class Alpr:
         self._recognize_array_func.restype = ctypes.c_void_p
         self._recognize_array_func.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_ubyte), ctypes.c_uint]
 
+        self._recognize_array_batch_func = self._openalprpy_lib.recognizeArrayBatch
+        self._recognize_array_batch_func.restype = ctypes.c_void_p
+        self._recognize_array_batch_func.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.POINTER(ctypes.c_ubyte)),
+                                                     ctypes.POINTER(ctypes.c_int), ctypes.c_int]
+
         try:
             import numpy as np
             import numpy.ctypeslib as npct
@@ -170,6 +175,28 @@ class Alpr:
         self._free_json_mem_func(ctypes.c_void_p(ptr))
         return response_obj
 
+    def recognize_array_batch(self, byte_arrays):
+        """
+        This causes OpenALPR to recognize a list of images, each passed in as a byte array.
+        The plates in all of the images are analyzed in parallel.
+
+        :param byte_arrays: A list of strings (Python 2) or bytes objects (Python 3)
+        :return: A list of OpenALPR response dictionaries, in the same order as byte_arrays
+        """
+        for byte_array in byte_arrays:
+            if type(byte_array) != bytes:
+                raise TypeError("Expected a list of byte arrays (string in Python 2, bytes in Python 3)")
+        count = len(byte_arrays)
+        bufs = (ctypes.POINTER(ctypes.c_ubyte) * count)(
+            *[ctypes.cast(byte_array, ctypes.POINTER(ctypes.c_ubyte)) for byte_array in byte_arrays])
+        lens = (ctypes.c_int * count)(*[len(byte_array) for byte_array in byte_arrays])
+        ptr = self._recognize_array_batch_func(self.alpr_pointer, bufs, lens, count)
+        json_data = ctypes.cast(ptr, ctypes.c_char_p).value
+        json_data = _convert_from_charp(json_data)
+        response_obj = json.loads(json_data)
+        self._free_json_mem_func(ctypes.c_void_p(ptr))
+        return response_obj
+
     def recognize_ndarray(self, ndarray):
         """
         This causes OpenALPR to attempt to recognize an image passed in as a numpy array.
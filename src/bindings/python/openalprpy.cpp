@@ -96,6 +96,34 @@ extern "C" {
       return membuffer;
     }
 
+  OPENALPR_EXPORT char* recognizeArrayBatch(Alpr* nativeAlpr, unsigned char** bufs, int* lens, int count)
+    {
+      std::vector<AlprFrame> frames;
+      for (int i = 0; i < count; i++)
+      {
+        std::vector<char> cvec(bufs[i], bufs[i]+lens[i]);
+        frames.push_back(AlprFrame(cvec));
+      }
+
+      std::vector<AlprResults> results = nativeAlpr->recognizeBatch(frames);
+
+      // Respond with a JSON array with one entry per image
+      std::string json = "[";
+      for (unsigned int i = 0; i < results.size(); i++)
+      {
+        if (i > 0)
+          json += ",";
+        json += Alpr::toJson(results[i]);
+      }
+      json += "]";
+
+      int strsize = sizeof(char) * (strlen(json.c_str()) + 1);
+      char* membuffer = (char*)malloc(strsize);
+      strcpy(membuffer, json.c_str());
+
+      return membuffer;
+    }
+
   // AlprResults recognize(unsigned char* pixelData,
   // int bytesPerPixel, int imgWidth, int imgHeight,
   // std::vector<AlprRegionOfInterest> regionsOfInterest);
@@ -7,10 +7,13 @@
 #include "daemon/beanstalk.hpp"
 #include "video/logging_videobuffer.h"
 #include "daemon/daemonconfig.h"
+#include "daemon/framechangegate.h"
 #include "inc/safequeue.h"
 
 #include "tclap/CmdLine.h"
 #include "alpr.h"
+#include "openalpr/platetracker.h"
+#include "openalpr/motiondetector.h"
 #include "openalpr/cjson.h"
 #include "support/tinythread.h"
 #include <curl/curl.h>
@@ -24,8 +27,15 @@
 
 using namespace alpr;
 
+// A frame waiting to be analyzed, with the areas that moved if motion detection is on
+struct QueuedFrame
+{
+  cv::Mat frame;
+  std::vector<cv::Rect> motion_regions;
+};
+
 // Variables
-SafeQueue<cv::Mat> framesQueue;
+SafeQueue<QueuedFrame> framesQueue;
 
 // Prototypes
 void streamRecognitionThread(void* arg);
@@ -42,6 +52,9 @@ const std::string BEANSTALK_QUEUE_HOST="127.0.0.1";
 const int BEANSTALK_PORT=11300;
 const std::string BEANSTALK_TUBE_NAME="alprd";
 
+// How often the change gate counts are logged
+const int64_t CHANGE_GATE_LOG_INTERVAL_MS = 60000;
+
 
 struct CaptureThreadData
 {
@@ -59,6 +72,17 @@ struct CaptureThreadData
   bool output_images;
   std::string output_image_folder;
   int top_n;
+  bool plate_tracking;
+  bool motion_detection;
+  bool change_gate;
+  float change_gate_min_changed_percent;
+
+  // Shared by all of the analysis threads for this stream
+  Alpr* alpr;
+  PlateTracker* tracker;
+
+  // Only used by the capture thread
+  MotionDetector* motion;
 };
 
 struct UploadThreadData
@@ -186,6 +210,11 @@ int main( int argc, const char** argv )
   
   LOG4CPLUS_INFO(logger, "Using: " << daemon_config.imageFolder << " for storing valid plate images");
   
+  // Load the models before forking, so each stream's process starts with them already in the
+  // model registry.  The pages stay shared between the processes until one of them writes to them
+  Alpr* shared_models = new Alpr(daemon_config.country, openAlprConfigFile);
+  LOG4CPLUS_INFO(logger, "Loaded models for " << daemon_config.country << " before starting " << daemon_config.stream_urls.size() << " streams");
+
   pid_t pid;
   
   std::vector<tthread::thread*> threads;
@@ -208,6 +237,10 @@ int main( int argc, const char** argv )
       tdata->analysis_threads = daemon_config.analysis_threads;
       tdata->top_n = daemon_config.topn;
       tdata->pattern = daemon_config.pattern;
+      tdata->plate_tracking = daemon_config.plateTracking;
+      tdata->motion_detection = daemon_config.motionDetection;
+      tdata->change_gate = daemon_config.changeGate;
+      tdata->change_gate_min_changed_percent = daemon_config.changeGateMinChangedPercent;
       tdata->clock_on = clockOn;
       
       tthread::thread* thread_recognize = new tthread::thread(streamRecognitionThread, (void*) tdata);
@@ -233,6 +266,8 @@ int main( int argc, const char** argv )
 
   for (uint16_t i = 0; i < threads.size(); i++)
     delete threads[i];
+
+  delete shared_models;
   
   return 0;
 }
@@ -241,23 +276,40 @@ int main( int argc, const char** argv )
 void processingThread(void* arg)
 {
   CaptureThreadData* tdata = (CaptureThreadData*) arg;
-  Alpr alpr(tdata->country_code, tdata->config_file);
-  alpr.setTopN(tdata->top_n);
-  alpr.setDefaultRegion(tdata->pattern);
+  Alpr* alpr = tdata->alpr;
 
   while (daemon_active) {
 
     // Wait for a new frame
-    cv::Mat frame = framesQueue.pop();
+    QueuedFrame queued_frame = framesQueue.pop();
+    cv::Mat frame = queued_frame.frame;
 
     // Process new frame
     timespec startTime;
     getTimeMonotonic(&startTime);
 
     std::vector<AlprRegionOfInterest> regionsOfInterest;
-    regionsOfInterest.push_back(AlprRegionOfInterest(0,0, frame.cols, frame.rows));
+    if (tdata->tracker != NULL)
+      regionsOfInterest = tdata->tracker->getRegionsOfInterest(frame.cols, frame.rows, MotionDetector::getBounds(queued_frame.motion_regions));
+    else if (tdata->motion != NULL)
+    {
+      // Search each moving area separately
+      for (unsigned int i = 0; i < queued_frame.motion_regions.size(); i++)
+      {
+        cv::Rect motion_region = queued_frame.motion_regions[i];
+        regionsOfInterest.push_back(AlprRegionOfInterest(motion_region.x, motion_region.y, motion_region.width, motion_region.height));
+      }
+    }
+    else
+      regionsOfInterest.push_back(AlprRegionOfInterest(0,0, frame.cols, frame.rows));
+
+    // Nothing to search until the next full scan
+    AlprResults results;
+    if (regionsOfInterest.size() > 0)
+      results = alpr->recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, regionsOfInterest);
 
-    AlprResults results = alpr.recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, regionsOfInterest);
+    if (tdata->tracker != NULL)
+      tdata->tracker->update(results);
 
     timespec endTime;
     getTimeMonotonic(&endTime);
@@ -281,7 +333,7 @@ void processingThread(void* arg)
       }
 
       // Update the JSON content to include UUID and camera ID
-      std::string json = alpr.toJson(results);
+      std::string json = Alpr::toJson(results);
       cJSON *root = cJSON_Parse(json.c_str());
       cJSON_AddStringToObject(root,	"uuid",		uuid.c_str());
       cJSON_AddNumberToObject(root,	"camera_id",	tdata->camera_id);
@@ -322,6 +374,19 @@ void streamRecognitionThread(void* arg)
   LOG4CPLUS_INFO(logger, "pattern: " << tdata->pattern);
   LOG4CPLUS_INFO(logger, "Stream " << tdata->camera_id << ": " << tdata->stream_url);
   
+  // Load the recognition data once.  The analysis threads share this instance
+  tdata->alpr = new Alpr(tdata->country_code, tdata->config_file);
+  tdata->alpr->setTopN(tdata->top_n);
+  tdata->alpr->setDefaultRegion(tdata->pattern);
+
+  tdata->tracker = NULL;
+  if (tdata->plate_tracking)
+    tdata->tracker = new PlateTracker(tdata->alpr->getConfig());
+
+  tdata->motion = NULL;
+  if (tdata->motion_detection)
+    tdata->motion = new MotionDetector(tdata->alpr->getConfig());
+
   /* Create processing threads */
   const int num_threads = tdata->analysis_threads;
   tthread::thread* threads[num_threads];
@@ -336,6 +401,13 @@ void streamRecognitionThread(void* arg)
   LoggingVideoBuffer videoBuffer(logger);
   videoBuffer.connect(tdata->stream_url, 5);
   LOG4CPLUS_INFO(logger, "Starting camera " << tdata->camera_id);
+
+  bool motion_started = false;
+
+  FrameChangeGate* change_gate = NULL;
+  if (tdata->change_gate)
+    change_gate = new FrameChangeGate(tdata->change_gate_min_changed_percent);
+  int64_t last_gate_log_time = getEpochTimeMs();
   
   while (daemon_active)
   {
@@ -343,20 +415,52 @@ void streamRecognitionThread(void* arg)
     int response = videoBuffer.getLatestFrame(&frame, regionsOfInterest);
     
     if (response != -1) {
-      if (framesQueue.empty()) {
-        framesQueue.push(frame.clone());
+      // Every frame updates the motion background, including the ones that are not analyzed
+      QueuedFrame queued_frame;
+      bool has_work = true;
+      if (tdata->motion != NULL)
+      {
+        if (!motion_started)
+        {
+          tdata->motion->ResetMotionDetection(&frame);
+          motion_started = true;
+        }
+        queued_frame.motion_regions = tdata->motion->MotionDetect(frame);
+
+        // Without motion, only the tracker has anything to search
+        has_work = queued_frame.motion_regions.size() > 0 || tdata->tracker != NULL;
+      }
+
+      // Only frames that would be analyzed are compared, so the gate compares against the last analyzed frame
+      if (has_work && framesQueue.empty() && change_gate != NULL)
+        has_work = change_gate->accept(frame);
+
+      if (has_work && framesQueue.empty()) {
+        queued_frame.frame = frame.clone();
+        framesQueue.push(queued_frame);
       }
     }
+
+    if (change_gate != NULL && getEpochTimeMs() - last_gate_log_time >= CHANGE_GATE_LOG_INTERVAL_MS)
+    {
+      LOG4CPLUS_INFO(logger, "Camera " << tdata->camera_id << " change gate: " << change_gate->getProcessedCount() << " frames processed, " 
+                     << change_gate->getSkippedCount() << " skipped as unchanged");
+      last_gate_log_time = getEpochTimeMs();
+    }
     
     usleep(10000);
   }
   
   videoBuffer.disconnect();
   LOG4CPLUS_INFO(logger, "Video processing ended");
-  delete tdata;
   for (int i = 0; i < num_threads; i++) {
     delete threads[i];
   }
+  delete tdata->tracker;
+  delete tdata->motion;
+  delete change_gate;
+  delete tdata->alpr;
+  delete tdata;
 }
 
 
@@ -55,6 +55,10 @@ DaemonConfig::DaemonConfig(std::string config_file, std::string config_defaults_
   company_id = getString(&ini, &defaultIni, "daemon", "company_id", "");
   site_id = getString(&ini, &defaultIni, "daemon", "site_id", "");
   pattern = getString(&ini, &defaultIni, "daemon", "pattern", "");
+  plateTracking = getBoolean(&ini, &defaultIni, "daemon", "plate_tracking", false);
+  motionDetection = getBoolean(&ini, &defaultIni, "daemon", "motion_detection", false);
+  changeGate = getBoolean(&ini, &defaultIni, "daemon", "change_gate", false);
+  changeGateMinChangedPercent = getFloat(&ini, &defaultIni, "daemon", "change_gate_min_changed_percent", 1.0);
 }
 
 DaemonConfig::~DaemonConfig() {
@@ -24,6 +24,10 @@ public:
   std::string company_id;
   std::string site_id;
   std::string pattern;
+  bool plateTracking;
+  bool motionDetection;
+  bool changeGate;
+  float changeGateMinChangedPercent;
   
 private:
 
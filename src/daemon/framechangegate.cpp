@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2016 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framechangegate.h"
+
+#include <algorithm>
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+// Width of the image that frames are compared at.  Shrinking averages away sensor noise and
+// compression artifacts as well as making the comparison cheap
+const int THUMBNAIL_WIDTH = 64;
+
+// A pixel of the small image has changed if its brightness moved by more than this
+const int PIXEL_CHANGE_THRESHOLD = 20;
+
+FrameChangeGate::FrameChangeGate(float min_changed_percent) {
+  this->min_changed_percent = min_changed_percent;
+  
+  processed_count = 0;
+  skipped_count = 0;
+}
+
+FrameChangeGate::~FrameChangeGate() {
+}
+
+bool FrameChangeGate::accept(cv::Mat frame) {
+  // Shrink before converting to gray, so that the conversion works on the small image
+  int thumbnail_height = std::max(1, frame.rows * THUMBNAIL_WIDTH / std::max(1, frame.cols));
+  cv::Mat small_frame;
+  cv::resize(frame, small_frame, cv::Size(THUMBNAIL_WIDTH, thumbnail_height), 0, 0, cv::INTER_AREA);
+
+  if (small_frame.channels() > 1)
+    cv::cvtColor(small_frame, thumbnail, CV_BGR2GRAY);
+  else
+    small_frame.copyTo(thumbnail);
+
+  bool changed = true;
+  if (last_thumbnail.size() == thumbnail.size())
+  {
+    cv::absdiff(thumbnail, last_thumbnail, difference);
+    cv::threshold(difference, difference, PIXEL_CHANGE_THRESHOLD, 255, cv::THRESH_BINARY);
+
+    float changed_percent = 100.0 * cv::countNonZero(difference) / difference.total();
+    changed = changed_percent >= min_changed_percent;
+  }
+
+  if (changed)
+  {
+    thumbnail.copyTo(last_thumbnail);
+    processed_count++;
+  }
+  else
+  {
+    skipped_count++;
+  }
+
+  return changed;
+}
+
+int FrameChangeGate::getProcessedCount() {
+  return processed_count;
+}
+
+int FrameChangeGate::getSkippedCount() {
+  return skipped_count;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2016 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_FRAMECHANGEGATE_H
+#define	OPENALPR_FRAMECHANGEGATE_H
+
+#include "opencv2/core/core.hpp"
+
+// Decides whether a video frame is worth analyzing by comparing a small grayscale copy of it
+// to the last frame that was analyzed.  Frames of a static scene are skipped.
+class FrameChangeGate {
+public:
+  // min_changed_percent is the share of the small image that must change for a frame to be analyzed
+  FrameChangeGate(float min_changed_percent);
+  virtual ~FrameChangeGate();
+
+  // True if the frame should be analyzed.  The frame becomes the one later frames are compared to
+  bool accept(cv::Mat frame);
+
+  int getProcessedCount();
+  int getSkippedCount();
+  
+private:
+  float min_changed_percent;
+
+  cv::Mat last_thumbnail;
+  cv::Mat thumbnail;
+  cv::Mat difference;
+
+  int processed_count;
+  int skipped_count;
+};
+
+#endif	/* OPENALPR_FRAMECHANGEGATE_H */
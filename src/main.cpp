@@ -32,6 +32,7 @@
 #include "support/platform.h"
 #include "video/videobuffer.h"
 #include "motiondetector.h"
+#include "platetracker.h"
 #include "alpr.h"
 
 using namespace alpr;
@@ -41,9 +42,13 @@ const std::string MAIN_WINDOW_NAME = "ALPR main window";
 const bool SAVE_LAST_VIDEO_STILL = false;
 const std::string LAST_VIDEO_STILL_LOCATION = "/tmp/laststill.jpg";
 const std::string WEBCAM_PREFIX = "/dev/video";
-MotionDetector motiondetector;
+MotionDetector* motiondetector = NULL;
 bool do_motiondetection = true;
 
+// Set while processing a video, if tracking is enabled
+PlateTracker* platetracker = NULL;
+bool do_tracking = false;
+
 /** Function Headers */
 bool detectandshow(Alpr* alpr, cv::Mat frame, std::string region, bool writeJson);
 bool is_supported_image(std::string image_file);
@@ -82,6 +87,7 @@ int main( int argc, const char** argv )
   TCLAP::SwitchArg detectRegionSwitch("d","detect_region","Attempt to detect the region of the plate image.  [Experimental]  Default=off", cmd, false);
   TCLAP::SwitchArg clockSwitch("","clock","Measure/print the total time to process image and all plates.  Default=off", cmd, false);
   TCLAP::SwitchArg motiondetect("", "motion", "Use motion detection on video file or stream.  Default=off", cmd, false);
+  TCLAP::SwitchArg trackSwitch("", "track", "Track plates in a video file or stream and only search where they are expected between full scans.  Default=off", cmd, false);
 
   try
   {
@@ -111,6 +117,7 @@ int main( int argc, const char** argv )
     topn = topNArg.getValue();
     measureProcessingTime = clockSwitch.getValue();
 	do_motiondetection = motiondetect.getValue();
+    do_tracking = trackSwitch.getValue();
   }
   catch (TCLAP::ArgException &e)    // catch any exceptions
   {
@@ -127,6 +134,7 @@ int main( int argc, const char** argv )
   if (debug_mode)
   {
     alpr.getConfig()->setDebug(true);
+    alpr.applyConfig();
   }
 
   if (detectRegion)
@@ -141,9 +149,14 @@ int main( int argc, const char** argv )
     return 1;
   }
 
+  PlateTracker tracker(alpr.getConfig());
+  MotionDetector motion(alpr.getConfig());
+  motiondetector = &motion;
+
   for (unsigned int i = 0; i < filenames.size(); i++)
   {
     std::string filename = filenames[i];
+    platetracker = NULL;
 
     if (filename == "-")
     {
@@ -200,10 +213,16 @@ int main( int argc, const char** argv )
         return 1;
       }
 
+      if (do_tracking)
+      {
+        tracker.reset();
+        platetracker = &tracker;
+      }
+
       while (cap.read(frame))
       {
         if (framenum == 0)
-          motiondetector.ResetMotionDetection(&frame);
+          motiondetector->ResetMotionDetection(&frame);
         detectandshow(&alpr, frame, "", outputJson);
         sleep_ms(10);
         framenum++;
@@ -219,6 +238,12 @@ int main( int argc, const char** argv )
 
       cv::Mat latestFrame;
 
+      if (do_tracking)
+      {
+        tracker.reset();
+        platetracker = &tracker;
+      }
+
       while (program_active)
       {
         std::vector<cv::Rect> regionsOfInterest;
@@ -227,7 +252,7 @@ int main( int argc, const char** argv )
         if (response != -1)
         {
           if (framenum == 0)
-            motiondetector.ResetMotionDetection(&latestFrame);
+            motiondetector->ResetMotionDetection(&latestFrame);
           detectandshow(&alpr, latestFrame, "", outputJson);
         }
 
@@ -255,6 +280,12 @@ int main( int argc, const char** argv )
         cap.open(filename);
         cap.set(CV_CAP_PROP_POS_MSEC, seektoms);
 
+        if (do_tracking)
+        {
+          tracker.reset();
+          platetracker = &tracker;
+        }
+
         while (cap.read(frame))
         {
           if (SAVE_LAST_VIDEO_STILL)
@@ -265,7 +296,7 @@ int main( int argc, const char** argv )
             std::cout << "Frame: " << framenum << std::endl;
           
           if (framenum == 0)
-            motiondetector.ResetMotionDetection(&frame);
+            motiondetector->ResetMotionDetection(&frame);
           detectandshow(&alpr, frame, "", outputJson);
           //create a 1ms delay
           sleep_ms(1);
@@ -342,15 +373,26 @@ bool detectandshow( Alpr* alpr, cv::Mat frame, std::string region, bool writeJso
   getTimeMonotonic(&startTime);
 
   std::vector<AlprRegionOfInterest> regionsOfInterest;
+  std::vector<cv::Rect> motionRegions;
   if (do_motiondetection)
   {
-	  cv::Rect rectan = motiondetector.MotionDetect(&frame);
-	  if (rectan.width>0) regionsOfInterest.push_back(AlprRegionOfInterest(rectan.x, rectan.y, rectan.width, rectan.height));
+    // Search each moving area separately
+    motionRegions = motiondetector->MotionDetect(frame);
+    for (unsigned int i = 0; i < motionRegions.size(); i++)
+      regionsOfInterest.push_back(AlprRegionOfInterest(motionRegions[i].x, motionRegions[i].y, motionRegions[i].width, motionRegions[i].height));
   }
   else regionsOfInterest.push_back(AlprRegionOfInterest(0, 0, frame.cols, frame.rows));
+
+  // The tracker decides where to search.  New motion triggers a full scan
+  if (platetracker != NULL)
+    regionsOfInterest = platetracker->getRegionsOfInterest(frame.cols, frame.rows, MotionDetector::getBounds(motionRegions));
+
   AlprResults results;
   if (regionsOfInterest.size()>0) results = alpr->recognize(frame.data, frame.elemSize(), frame.cols, frame.rows, regionsOfInterest);
 
+  if (platetracker != NULL)
+    platetracker->update(results);
+
   timespec endTime;
   getTimeMonotonic(&endTime);
   double totalProcessingTime = diffclock(startTime, endTime);
@@ -32,6 +32,9 @@
 
 #include "detection/detectorfactory.h"
 #include "ocr/ocrfactory.h"
+#include "ocr/segmentation/charactersegmenter.h"
+#include "ocr/segmentation/histogramvertical.h"
+#include "ocr/segmentation/histogramhorizontal.h"
 #include "support/filesystem.h"
 
 using namespace std;
@@ -68,7 +71,7 @@ int main( int argc, const char** argv )
     printf("Use:\n\t%s [country] [benchmark name] [img input dir] [results output dir]\n",argv[0]);
     printf("\tex: %s us speed ./speed/usimages ./speed\n",argv[0]);
     printf("\n");
-    printf("\ttest names are: speed, segocr, detection\n\n" );
+    printf("\ttest names are: speed, segocr, detection, ocrmode, histogram\n\n" );
     return 0;
   }
 
@@ -88,12 +91,10 @@ int main( int argc, const char** argv )
 
   if (benchmarkName.compare("segocr") == 0)
   {
-    Config* config = new Config(country);
-    config->setDebug(false);
-    config->skipDetection = true;
-
     AlprImpl alpr(country);
-    alpr.config = config;
+    alpr.getConfig()->setDebug(false);
+    alpr.getConfig()->skipDetection = true;
+    alpr.applyConfig();
     
     for (int i = 0; i< files.size(); i++)
     {
@@ -129,8 +130,6 @@ int main( int argc, const char** argv )
         waitKey(5);
       }
     }
-
-    delete config;
   }
   else if (benchmarkName.compare("detection") == 0)
   {
@@ -165,7 +164,8 @@ int main( int argc, const char** argv )
     config.setDebug(false);
 
     AlprImpl alpr(country);
-    alpr.config->setDebug(false);
+    alpr.getConfig()->setDebug(false);
+    alpr.applyConfig();
     alpr.setDetectRegion(true);
 
     PreWarp prewarp(&config);
@@ -284,6 +284,241 @@ int main( int argc, const char** argv )
     outputStats(postProcessTimes);
     cout << endl;
   }
+  else if (benchmarkName.compare("ocrmode") == 0)
+  {
+    // Compares the speed and results of recognizing each character box separately (the default) 
+    // with recognizing all of the boxes on a line as one strip (ocr_strip_mode)
+
+    timespec startTime;
+    timespec endTime;
+
+    Config boxConfig(country);
+    boxConfig.setDebug(false);
+    boxConfig.ocrStripMode = false;
+
+    Config stripConfig(country);
+    stripConfig.setDebug(false);
+    stripConfig.ocrStripMode = true;
+
+    PreWarp prewarp(&boxConfig);
+    Detector* plateDetector = createDetector(&boxConfig, &prewarp);
+
+    Config* configs[2] = { &boxConfig, &stripConfig };
+    OCR* ocrs[2] = { createOcr(&boxConfig), createOcr(&stripConfig) };
+    vector<double> ocrTimes[2];
+
+    int plates = 0;
+    int matchingPlates = 0;
+
+    for (int i = 0; i< files.size(); i++)
+    {
+      if (hasEnding(files[i], ".png") || hasEnding(files[i], ".jpg"))
+      {
+        string fullpath = inDir + "/" + files[i];
+        frame = imread( fullpath.c_str() );
+
+        vector<PlateRegion> regions = plateDetector->detect(frame);
+
+        for (int z = 0; z < regions.size(); z++)
+        {
+          string bestPlates[2];
+          bool disqualified = false;
+
+          for (int mode = 0; mode < 2; mode++)
+          {
+            // OCR changes the thresholds, so each mode analyzes the plate from scratch
+            PipelineData pipeline_data(frame, regions[z].rect, configs[mode]);
+            LicensePlateCandidate lp(&pipeline_data);
+            lp.recognize();
+
+            if (pipeline_data.disqualified)
+            {
+              disqualified = true;
+              break;
+            }
+
+            getTimeMonotonic(&startTime);
+            ocrs[mode]->performOCR(&pipeline_data);
+            getTimeMonotonic(&endTime);
+            ocrTimes[mode].push_back(diffclock(startTime, endTime));
+
+            ocrs[mode]->postProcessor.analyze("", 10);
+            vector<PPResult> ppResults = ocrs[mode]->postProcessor.getResults();
+            if (ppResults.size() > 0)
+              bestPlates[mode] = ppResults[0].letters;
+          }
+
+          if (disqualified)
+            continue;
+
+          plates++;
+          if (bestPlates[0] == bestPlates[1])
+            matchingPlates++;
+
+          cout << files[i] << "\tRegion " << z << ": per box: " << bestPlates[0] << " (" << ocrTimes[0].back() << "ms), " 
+               << "strip: " << bestPlates[1] << " (" << ocrTimes[1].back() << "ms)" << endl;
+        }
+      }
+    }
+
+    cout << endl << "---------------------" << endl;
+
+    cout << "Per Box OCR Time Statistics:" << endl;
+    outputStats(ocrTimes[0]);
+    cout << endl;
+
+    cout << "Strip OCR Time Statistics:" << endl;
+    outputStats(ocrTimes[1]);
+    cout << endl;
+
+    cout << "Best plate matches per box OCR on " << matchingPlates << " of " << plates << " plates" << endl;
+
+    delete ocrs[0];
+    delete ocrs[1];
+    delete plateDetector;
+  }
+  else if (benchmarkName.compare("histogram") == 0)
+  {
+    // Compares the histograms used by character segmentation with the pixel by pixel counts they replaced,
+    // on the thresholds and text lines of each plate.  Then times the character segmenter on each plate 
+    // with each kind of histogram
+
+    const int REPEAT = 50;
+
+    timespec startTime;
+    timespec endTime;
+
+    Config config(country);
+    config.setDebug(false);
+
+    PreWarp prewarp(&config);
+    Detector* plateDetector = createDetector(&config, &prewarp);
+
+    vector<double> referenceTimes;
+    vector<double> histogramTimes;
+    vector<double> referenceSegmenterTimes;
+    vector<double> segmenterTimes;
+    int mismatches = 0;
+
+    for (int i = 0; i< files.size(); i++)
+    {
+      if (hasEnding(files[i], ".png") || hasEnding(files[i], ".jpg"))
+      {
+        string fullpath = inDir + "/" + files[i];
+        frame = imread( fullpath.c_str() );
+
+        vector<PlateRegion> regions = plateDetector->detect(frame);
+
+        for (int z = 0; z < regions.size(); z++)
+        {
+          // The segmenter changes the plate's images, so each run starts from a new candidate for the same region.
+          // Mode 0 uses the pixel by pixel histograms.  The modes take turns going first, so neither always gets a warm cache
+          double segmenter_times[2];
+          bool disqualified = false;
+          for (int run = 0; run < 2 && !disqualified; run++)
+          {
+            int mode = (run + z) % 2;
+
+            PipelineData pipeline_data(frame, regions[z].rect, &config);
+            LicensePlateCandidate lp(&pipeline_data);
+            lp.recognize();
+
+            disqualified = pipeline_data.disqualified;
+            if (disqualified)
+              break;
+
+            Histogram::setReferenceMode(mode == 0);
+            getTimeMonotonic(&startTime);
+            CharacterSegmenter segmenter(&pipeline_data);
+            segmenter.segment();
+            getTimeMonotonic(&endTime);
+            Histogram::setReferenceMode(false);
+
+            segmenter_times[mode] = diffclock(startTime, endTime);
+          }
+
+          if (disqualified)
+            continue;
+
+          referenceSegmenterTimes.push_back(segmenter_times[0]);
+          segmenterTimes.push_back(segmenter_times[1]);
+
+          PipelineData pipeline_data(frame, regions[z].rect, &config);
+          LicensePlateCandidate lp(&pipeline_data);
+          lp.recognize();
+
+          for (unsigned int lineidx = 0; lineidx < pipeline_data.textLines.size(); lineidx++)
+          {
+            for (unsigned int t = 0; t < pipeline_data.thresholds.size(); t++)
+            {
+              Mat threshold = pipeline_data.thresholds[t];
+              Mat mask = Mat::zeros(threshold.size(), CV_8U);
+              fillConvexPoly(mask, pipeline_data.textLines[lineidx].linePolygon.data(), 
+                             pipeline_data.textLines[lineidx].linePolygon.size(), Scalar(255,255,255));
+
+              Histogram::setReferenceMode(true);
+              HistogramVertical referenceCols(threshold, mask);
+              HistogramHorizontal referenceRows(threshold, mask);
+
+              getTimeMonotonic(&startTime);
+              for (int r = 0; r < REPEAT; r++)
+              {
+                HistogramVertical vertHistogram(threshold, mask);
+                HistogramHorizontal horizHistogram(threshold, mask);
+              }
+              getTimeMonotonic(&endTime);
+              referenceTimes.push_back(diffclock(startTime, endTime) / REPEAT);
+
+              Histogram::setReferenceMode(false);
+              getTimeMonotonic(&startTime);
+              for (int r = 0; r < REPEAT; r++)
+              {
+                HistogramVertical vertHistogram(threshold, mask);
+                HistogramHorizontal horizHistogram(threshold, mask);
+
+                if (r == 0)
+                {
+                  for (int col = 0; col < threshold.cols; col++)
+                    if (vertHistogram.getHeightAt(col) != referenceCols.getHeightAt(col))
+                      mismatches++;
+                  for (int row = 0; row < threshold.rows; row++)
+                    if (horizHistogram.getHeightAt(row) != referenceRows.getHeightAt(row))
+                      mismatches++;
+                }
+              }
+              getTimeMonotonic(&endTime);
+              histogramTimes.push_back(diffclock(startTime, endTime) / REPEAT);
+            }
+          }
+        }
+      }
+    }
+
+    cout << "Pixel by Pixel Histogram Time Statistics (one threshold and line):" << endl;
+    outputStats(referenceTimes);
+    cout << endl;
+
+    cout << "Histogram Time Statistics (one threshold and line):" << endl;
+    outputStats(histogramTimes);
+    cout << endl;
+
+    cout << "Character Segmenter Time Statistics with pixel by pixel histograms (one plate):" << endl;
+    outputStats(referenceSegmenterTimes);
+    cout << endl;
+
+    cout << "Character Segmenter Time Statistics (one plate):" << endl;
+    outputStats(segmenterTimes);
+    cout << endl;
+
+    double referenceTotal = std::accumulate(referenceSegmenterTimes.begin(), referenceSegmenterTimes.end(), 0.0);
+    double segmenterTotal = std::accumulate(segmenterTimes.begin(), segmenterTimes.end(), 0.0);
+    if (segmenterTotal > 0)
+      cout << "Character Segmenter speedup: " << referenceTotal / segmenterTotal << "x" << endl;
+
+    cout << "Histogram counts that differ: " << mismatches << endl;
+
+    delete plateDetector;
+  }
   else if (benchmarkName.compare("endtoend") == 0)
   {
     EndToEndTest e2eTest(inDir, outDir);
@@ -21,7 +21,8 @@ void EndToEndTest::runTest(string country, vector<std::string> files)
   
   
   AlprImpl alpr(country);
-  alpr.config->setDebug(false);
+  alpr.getConfig()->setDebug(false);
+  alpr.applyConfig();
   alpr.setDetectRegion(false);
 
   vector<EndToEndBenchmarkResult> benchmarkResults;
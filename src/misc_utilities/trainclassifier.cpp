@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "opencv2/highgui/highgui.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include <iostream>
+#include <stdio.h>
+
+#include "ocr/characterclassifier.h"
+#include "support/filesystem.h"
+#include "../tclap/CmdLine.h"
+#include "support/utf8.h"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// Takes a directory full of single char images and builds a model for the classifier OCR engine (ocr_engine = classifier).
+// The images are named the same way as for openalpr-utils-prepcharsfortraining: the first character of the file name 
+// is the character in the image (e.g., the output of openalpr-utils-classifychars)
+int main( int argc, const char** argv )
+{
+  string inDir;
+  string modelFile;
+
+  TCLAP::CmdLine cmd("OpenAlpr Character Classifier Training Utility", ' ', "1.0.0");
+
+  TCLAP::UnlabeledValueArg<std::string>  inputDirArg( "input_dir", "Folder containing individual character images", true, "", "input_dir_path"  );
+  TCLAP::UnlabeledValueArg<std::string>  modelFileArg( "model_file", "Model file to write (e.g., runtime_data/ocr/lus.charmodel)", true, "", "model_file_path"  );
+
+  try
+  {
+    cmd.add( inputDirArg );
+    cmd.add( modelFileArg );
+
+    if (cmd.parse( argc, argv ) == false)
+    {
+      // Error occurred while parsing.  Exit now.
+      return 1;
+    }
+
+    inDir = inputDirArg.getValue();
+    modelFile = modelFileArg.getValue();
+  }
+  catch (TCLAP::ArgException &e)    // catch any exceptions
+  {
+    std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+    return 1;
+  }
+
+  if (DirectoryExists(inDir.c_str()) == false)
+  {
+    printf("Input dir does not exist\n");
+    return 1;
+  }
+
+  vector<string> files = getFilesInDir(inDir.c_str());
+  sort( files.begin(), files.end(), stringCompare );
+
+  CharacterClassifier classifier;
+  int examples = 0;
+
+  for (int i = 0; i< files.size(); i++)
+  {
+    if (hasEnding(files[i], ".png") || hasEnding(files[i], ".jpg"))
+    {
+      string fullpath = inDir + "/" + files[i];
+
+      string::iterator utf_iterator = files[i].begin();
+      int cp = utf8::next(utf_iterator, files[i].end());
+      string charcode = utf8chr(cp);
+
+      Mat characterImg = imread(fullpath, CV_LOAD_IMAGE_GRAYSCALE);
+      if (characterImg.empty())
+      {
+        cerr << "Could not read " << fullpath << endl;
+        continue;
+      }
+
+      classifier.addExample(charcode, characterImg);
+      examples++;
+    }
+  }
+
+  if (classifier.save(modelFile) == false)
+  {
+    cerr << "Could not write " << modelFile << endl;
+    return 1;
+  }
+
+  cout << "Kept " << classifier.size() << " of " << examples << " examples.  Model written to " << modelFile << endl;
+  return 0;
+}
@@ -80,6 +80,36 @@ namespace alpr
     return impl->recognize(pixelData, bytesPerPixel, imgWidth, imgHeight, regionsOfInterest);
   }
 
+  AlprResults Alpr::recognize(AlprFrame frame)
+  {
+    return impl->recognize(frame);
+  }
+
+  std::vector<AlprResults> Alpr::recognizeBatch(std::vector<AlprFrame> frames)
+  {
+    return impl->recognizeBatch(frames);
+  }
+
+  bool Alpr::recognizeAsync(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    return impl->recognizeAsync(frame, callback, user_data);
+  }
+
+  void Alpr::waitForAsync()
+  {
+    impl->waitForAsync();
+  }
+
+  bool Alpr::recognizeVideoFrame(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    return impl->recognizeVideoFrame(frame, callback, user_data);
+  }
+
+  void Alpr::waitForVideoFrames()
+  {
+    impl->waitForVideoFrames();
+  }
+
   std::string Alpr::toJson( AlprResults results )
   {
     return AlprImpl::toJson(results);
@@ -133,6 +163,11 @@ namespace alpr
 
   Config* Alpr::getConfig()
   {
-    return impl->config;
+    return impl->getConfig();
+  }
+
+  void Alpr::applyConfig()
+  {
+    impl->applyConfig();
   }
 }
\ No newline at end of file
@@ -74,6 +74,130 @@ namespace alpr
     int height;
   };
 
+  // Time spent in each stage of recognition, in milliseconds.  For a plate, the time spent reading that plate.  
+  // For a frame, the total over every region that was analyzed (including regions that weren't plates)
+  // for every country and analysis_count iteration
+  class AlprStageTiming
+  {
+  public:
+    AlprStageTiming()
+    {
+      detection = 0;
+      char_analysis = 0;
+      edge_finding = 0;
+      deskew = 0;
+      segmentation = 0;
+      ocr = 0;
+      postprocess = 0;
+      aggregation = 0;
+    };
+
+    float detection;
+    float char_analysis;
+    float edge_finding;
+    float deskew;
+    float segmentation;
+    float ocr;
+    float postprocess;
+    float aggregation;
+  };
+
+  // Layout of raw pixel data
+  enum AlprPixelFormat
+  {
+    ALPR_PIXEL_FORMAT_GRAY,   // 8 bits per pixel
+    ALPR_PIXEL_FORMAT_BGR,    // 24 bits per pixel
+    ALPR_PIXEL_FORMAT_BGRA,   // 32 bits per pixel
+    ALPR_PIXEL_FORMAT_NV12,   // Y plane, followed by an interleaved UV plane at half resolution
+    ALPR_PIXEL_FORMAT_I420    // Y plane, followed by the U plane and the V plane at half resolution
+  };
+
+  // How much of each plate result to fill in.  The lower levels skip work that is only needed for the details they leave out
+  enum AlprDetailLevel
+  {
+    ALPR_DETAIL_PLATE,        // bestPlate only, without character_details.  topNPlates is empty
+    ALPR_DETAIL_TOPN,         // bestPlate and topNPlates, without character_details
+    ALPR_DETAIL_FULL          // Everything, including the corners of each character
+  };
+
+  // A single image passed to Alpr::recognize() or Alpr::recognizeBatch().  Provide either the bytes 
+  // of an encoded image (e.g., BMP, PNG, JPG) or raw pixel data.  Raw pixel data is not copied and must 
+  // remain valid until recognize() returns.
+  class AlprFrame
+  {
+  public:
+    AlprFrame(std::vector<char> imageBytes)
+    {
+      this->imageBytes = imageBytes;
+      this->pixelData = 0;
+      this->pixelFormat = ALPR_PIXEL_FORMAT_BGR;
+      this->bytesPerPixel = 0;
+      this->imgWidth = 0;
+      this->imgHeight = 0;
+      this->stride = 0;
+      this->detailLevel = ALPR_DETAIL_FULL;
+      setChromaPlanes(0, 0);
+    };
+    AlprFrame(unsigned char* pixelData, int bytesPerPixel, int imgWidth, int imgHeight)
+    {
+      this->pixelData = pixelData;
+      this->pixelFormat = bytesPerPixel == 1 ? ALPR_PIXEL_FORMAT_GRAY : (bytesPerPixel == 4 ? ALPR_PIXEL_FORMAT_BGRA : ALPR_PIXEL_FORMAT_BGR);
+      this->bytesPerPixel = bytesPerPixel;
+      this->imgWidth = imgWidth;
+      this->imgHeight = imgHeight;
+      this->stride = 0;
+      this->detailLevel = ALPR_DETAIL_FULL;
+      setChromaPlanes(0, 0);
+    };
+    // stride is the number of bytes between the start of each row (of the Y plane for NV12/I420).
+    // 0 means the rows are tightly packed.  For NV12 and I420 frames, the luma plane is used as the 
+    // grayscale image directly and the chroma planes are only read when region detection is enabled.
+    // Unless setChromaPlanes() is called, the chroma planes are expected right after the Y plane: the UV plane 
+    // of NV12 with the same stride, or the U and then the V plane of I420 with half the stride
+    AlprFrame(unsigned char* pixelData, AlprPixelFormat pixelFormat, int imgWidth, int imgHeight, int stride = 0)
+    {
+      this->pixelData = pixelData;
+      this->pixelFormat = pixelFormat;
+      this->bytesPerPixel = pixelFormat == ALPR_PIXEL_FORMAT_BGR ? 3 : (pixelFormat == ALPR_PIXEL_FORMAT_BGRA ? 4 : 1);
+      this->imgWidth = imgWidth;
+      this->imgHeight = imgHeight;
+      this->stride = stride;
+      this->detailLevel = ALPR_DETAIL_FULL;
+      setChromaPlanes(0, 0);
+    };
+
+    // Sets where the chroma planes of an NV12 or I420 frame are, for decoders that don't store them right after
+    // the Y plane.  For NV12, uPlane is the interleaved UV plane and vPlane is not used.  Strides are in bytes
+    void setChromaPlanes(unsigned char* uPlane, int uStride, unsigned char* vPlane = 0, int vStride = 0)
+    {
+      this->uPlane = uPlane;
+      this->uStride = uStride;
+      this->vPlane = vPlane;
+      this->vStride = vStride;
+    };
+
+    std::vector<char> imageBytes;
+
+    unsigned char* pixelData;
+    AlprPixelFormat pixelFormat;
+    int bytesPerPixel;
+    int imgWidth;
+    int imgHeight;
+    int stride;
+
+    // Chroma planes set by setChromaPlanes().  NULL when they follow the Y plane
+    unsigned char* uPlane;
+    int uStride;
+    unsigned char* vPlane;
+    int vStride;
+
+    // If empty, the full frame is analyzed
+    std::vector<AlprRegionOfInterest> regionsOfInterest;
+
+    // Defaults to ALPR_DETAIL_FULL
+    AlprDetailLevel detailLevel;
+  };
+
   class AlprPlateResult
   {
     public:
@@ -94,6 +218,9 @@ namespace alpr
 
       // The processing time for this plate
       float processing_time_ms;
+
+      // The processing time for this plate, by stage
+      AlprStageTiming stage_timing;
       
       // the X/Y coordinates of the corners of the plate (clock-wise from top-left)
       AlprCoordinate plate_points[4];
@@ -120,6 +247,9 @@ namespace alpr
       int img_height;
       float total_processing_time_ms;
 
+      // The processing time for the frame, by stage
+      AlprStageTiming stage_timing;
+
       std::vector<AlprPlateResult> plates;
 
       std::vector<AlprRegionOfInterest> regionsOfInterest;
@@ -127,8 +257,18 @@ namespace alpr
   };
 
 
+  // Receives the results of Alpr::recognizeAsync().  Called on one of the recognition threads.
+  // processed is false if the frame was dropped from the queue without being recognized, or if recognizing 
+  // it failed with an error other than a bad image (e.g., out of memory)
+  typedef void (*AlprAsyncCallback)(AlprResults results, bool processed, void* user_data);
+
   class Config;
   class AlprImpl;
+
+  // A loaded Alpr instance may be shared by multiple threads.  The recognize() functions
+  // can be called concurrently; the setters (setCountry, setPrewarp, setMask, etc.) should be done 
+  // before recognition starts, not while it is running.  Changes made through getConfig() take effect 
+  // once applyConfig() is called.
   class OPENALPR_DLL_EXPORT Alpr
   {
 
@@ -160,6 +300,36 @@ namespace alpr
       // Recognize from raw pixel data.  
       AlprResults recognize(unsigned char* pixelData, int bytesPerPixel, int imgWidth, int imgHeight, std::vector<AlprRegionOfInterest> regionsOfInterest);
 
+      // Recognize from a frame description.  Supports strided and YUV (NV12/I420) raw pixel data
+      AlprResults recognize(AlprFrame frame);
+
+      // Recognize many frames at once.  Plates found in all of the frames are analyzed in parallel
+      // on a pool of worker_threads threads.  Results are returned in the same order as the frames.
+      std::vector<AlprResults> recognizeBatch(std::vector<AlprFrame> frames);
+
+      // Queue a frame for recognition and return immediately.  The callback receives the results on one of
+      // async_threads recognition threads, so frames may finish out of order.  results.frame_number is the 
+      // order the frame was submitted in.  Raw pixel data is not copied and must stay valid until the callback runs.
+      // When async_queue_size frames are already waiting, async_drop_policy decides whether to wait for space,
+      // reject this frame, or drop the oldest waiting frame.  Returns false if this frame was rejected; otherwise
+      // the callback is called exactly once.  When called from a callback, a full queue rejects the frame rather than 
+      // waiting, even with the block policy, since the callback holds up a recognition thread.
+      bool recognizeAsync(AlprFrame frame, AlprAsyncCallback callback, void* user_data = 0);
+
+      // Blocks until every frame passed to recognizeAsync() has been handled
+      void waitForAsync();
+
+      // Recognize a frame from a video stream.  Plates are detected in this frame on one thread while the 
+      // plates found in earlier frames are read on another, which raises the frame rate of a single stream.  
+      // The callback receives the results on the recognition thread in the order the frames were submitted, 
+      // and must not submit more frames.  Blocks while video_pipeline_queue_size frames are waiting for detection.  
+      // Raw pixel data is not copied and must stay valid until the callback runs.  Early exit is not used.
+      // Returns false if the pipeline is shutting down; otherwise the callback is called exactly once.
+      bool recognizeVideoFrame(AlprFrame frame, AlprAsyncCallback callback, void* user_data = 0);
+
+      // Blocks until every frame passed to recognizeVideoFrame() has been returned
+      void waitForVideoFrames();
+
 
       static std::string toJson(const AlprResults results);
       static std::string toJson(const AlprPlateResult result);
@@ -171,6 +341,11 @@ namespace alpr
 
       Config* getConfig();
 
+      // Call after changing the config returned by getConfig().  The changes are used by the recognitions 
+      // that start after every recognition already running has finished, including the video frames that
+      // have been detected.  So a video callback must not call recognize() after calling this
+      void applyConfig();
+
     private:
       AlprImpl* impl;
   };
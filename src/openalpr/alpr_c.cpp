@@ -20,6 +20,7 @@
 #include "alpr_c.h"
 #include <alpr.h>
 #include <string.h>
+#include <iostream>
 #include <vector>
 #include <stdlib.h>
  
@@ -88,6 +89,66 @@ OPENALPRC_DLL_EXPORT char* openalpr_recognize_rawimage(OPENALPR* instance, unsig
   
 }
 
+static bool isValidPixelFormat(int pixelFormat)
+{
+  if (pixelFormat >= OPENALPR_PIXEL_FORMAT_GRAY && pixelFormat <= OPENALPR_PIXEL_FORMAT_I420)
+    return true;
+  
+  std::cerr << "Unknown pixel format: " << pixelFormat << std::endl;
+  return false;
+}
+
+static char* recognizeFrameToJson(OPENALPR* instance, alpr::AlprFrame frame, AlprCRegionOfInterest roi)
+{
+  alpr::AlprRegionOfInterest cpproi(roi.x, roi.y, roi.width, roi.height);
+  frame.regionsOfInterest.push_back(cpproi);
+  
+  alpr::AlprResults results = ((alpr::Alpr*) instance)->recognize(frame);
+  std::string json_string = alpr::Alpr::toJson(results);
+  
+  char* result_obj = strdup(json_string.c_str());
+  
+  return result_obj;
+}
+
+// The response for a frame that can't be read
+static char* emptyResultsJson(AlprCRegionOfInterest roi)
+{
+  alpr::AlprResults results;
+  results.epoch_time = 0;
+  results.img_width = 0;
+  results.img_height = 0;
+  results.total_processing_time_ms = 0;
+  results.regionsOfInterest.push_back(alpr::AlprRegionOfInterest(roi.x, roi.y, roi.width, roi.height));
+  
+  std::string json_string = alpr::Alpr::toJson(results);
+  return strdup(json_string.c_str());
+}
+
+OPENALPRC_DLL_EXPORT char* openalpr_recognize_frame(OPENALPR* instance, unsigned char* pixelData, int pixelFormat, int imgWidth, int imgHeight, int stride, AlprCRegionOfInterest roi)
+{
+  if (!isValidPixelFormat(pixelFormat))
+    return emptyResultsJson(roi);
+  
+  alpr::AlprFrame frame(pixelData, (alpr::AlprPixelFormat) pixelFormat, imgWidth, imgHeight, stride);
+  return recognizeFrameToJson(instance, frame, roi);
+}
+
+OPENALPRC_DLL_EXPORT char* openalpr_recognize_yuv_planes(OPENALPR* instance, int pixelFormat, int imgWidth, int imgHeight,
+                                                         unsigned char* yPlane, int yStride, unsigned char* uPlane, int uStride,
+                                                         unsigned char* vPlane, int vStride, AlprCRegionOfInterest roi)
+{
+  if (pixelFormat != OPENALPR_PIXEL_FORMAT_NV12 && pixelFormat != OPENALPR_PIXEL_FORMAT_I420)
+  {
+    std::cerr << "Not a YUV pixel format: " << pixelFormat << std::endl;
+    return emptyResultsJson(roi);
+  }
+  
+  alpr::AlprFrame frame(yPlane, (alpr::AlprPixelFormat) pixelFormat, imgWidth, imgHeight, yStride);
+  frame.setChromaPlanes(uPlane, uStride, vPlane, vStride);
+  return recognizeFrameToJson(instance, frame, roi);
+}
+
 OPENALPRC_DLL_EXPORT char* openalpr_recognize_encodedimage(OPENALPR* instance, unsigned char* bytes, long long length, AlprCRegionOfInterest roi)
 {
   std::vector<alpr::AlprRegionOfInterest> rois;
@@ -105,6 +166,90 @@ OPENALPRC_DLL_EXPORT char* openalpr_recognize_encodedimage(OPENALPR* instance, u
   return result_obj;
 }
 
+OPENALPRC_DLL_EXPORT char* openalpr_recognize_encodedimage_batch(OPENALPR* instance, unsigned char** images, long long* lengths, int num_images)
+{
+  std::vector<alpr::AlprFrame> frames;
+  for (int i = 0; i < num_images; i++)
+  {
+    std::vector<char> byte_vector(images[i], images[i] + lengths[i]);
+    frames.push_back(alpr::AlprFrame(byte_vector));
+  }
+  
+  std::vector<alpr::AlprResults> results = ((alpr::Alpr*) instance)->recognizeBatch(frames);
+  
+  std::string json_string = "[";
+  for (unsigned int i = 0; i < results.size(); i++)
+  {
+    if (i > 0)
+      json_string += ",";
+    json_string += alpr::Alpr::toJson(results[i]);
+  }
+  json_string += "]";
+  
+  char* result_obj = strdup(json_string.c_str());
+  
+  return result_obj;
+}
+
+// The C callback and its user data, passed through the C++ callback's user data
+struct AsyncCallbackData
+{
+  openalpr_async_callback callback;
+  void* user_data;
+};
+
+static void asyncCallbackToJson(alpr::AlprResults results, bool processed, void* user_data)
+{
+  AsyncCallbackData* callback_data = (AsyncCallbackData*) user_data;
+  
+  std::string json_string = alpr::Alpr::toJson(results);
+  callback_data->callback(json_string.c_str(), (int) processed, callback_data->user_data);
+  
+  delete callback_data;
+}
+
+static int submitAsync(OPENALPR* instance, alpr::AlprFrame frame, AlprCRegionOfInterest roi, openalpr_async_callback callback, void* user_data)
+{
+  alpr::AlprRegionOfInterest cpproi(roi.x, roi.y, roi.width, roi.height);
+  frame.regionsOfInterest.push_back(cpproi);
+  
+  AsyncCallbackData* callback_data = new AsyncCallbackData();
+  callback_data->callback = callback;
+  callback_data->user_data = user_data;
+  
+  if (!((alpr::Alpr*) instance)->recognizeAsync(frame, asyncCallbackToJson, callback_data))
+  {
+    delete callback_data;
+    return 0;
+  }
+  
+  return 1;
+}
+
+OPENALPRC_DLL_EXPORT int openalpr_recognize_frame_async(OPENALPR* instance, unsigned char* pixelData, int pixelFormat, int imgWidth, int imgHeight, int stride, AlprCRegionOfInterest roi,
+                                                        openalpr_async_callback callback, void* user_data)
+{
+  if (!isValidPixelFormat(pixelFormat))
+    return 0;
+  
+  alpr::AlprFrame frame(pixelData, (alpr::AlprPixelFormat) pixelFormat, imgWidth, imgHeight, stride);
+  
+  return submitAsync(instance, frame, roi, callback, user_data);
+}
+
+OPENALPRC_DLL_EXPORT int openalpr_recognize_encodedimage_async(OPENALPR* instance, unsigned char* bytes, long long length, AlprCRegionOfInterest roi,
+                                                               openalpr_async_callback callback, void* user_data)
+{
+  std::vector<char> byte_vector(bytes, bytes + length);
+  alpr::AlprFrame frame(byte_vector);
+  
+  return submitAsync(instance, frame, roi, callback, user_data);
+}
+
+OPENALPRC_DLL_EXPORT void openalpr_wait_for_async(OPENALPR* instance)
+{
+  ((alpr::Alpr*) instance)->waitForAsync();
+}
 
 OPENALPRC_DLL_EXPORT void openalpr_free_response_string(char* response)
 {
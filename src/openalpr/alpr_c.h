@@ -65,9 +65,65 @@ void openalpr_set_default_region(OPENALPR* instance, const char* region);
 // Caller must call free() on the returned object
 char* openalpr_recognize_rawimage(OPENALPR* instance, unsigned char* pixelData, int bytesPerPixel, int imgWidth, int imgHeight, struct AlprCRegionOfInterest roi);
 
+// Pixel layouts accepted by openalpr_recognize_frame
+enum AlprCPixelFormat
+{
+  OPENALPR_PIXEL_FORMAT_GRAY = 0,
+  OPENALPR_PIXEL_FORMAT_BGR = 1,
+  OPENALPR_PIXEL_FORMAT_BGRA = 2,
+  OPENALPR_PIXEL_FORMAT_NV12 = 3,
+  OPENALPR_PIXEL_FORMAT_I420 = 4
+};
+
+// Recognizes raw pixel data in the given format without copying it.  stride is the number of bytes
+// between rows (of the Y plane for NV12/I420), or 0 if the rows are tightly packed.  
+// For NV12 and I420, the Y plane is used directly as the grayscale image.  The chroma planes must follow the 
+// Y plane: the UV plane of NV12 with the same stride, or the U and V planes of I420 with half the stride.
+// Use openalpr_recognize_yuv_planes when they are stored elsewhere.
+// Unknown pixel formats are rejected with empty results.
+// Caller must call free() on the returned object
+char* openalpr_recognize_frame(OPENALPR* instance, unsigned char* pixelData, int pixelFormat, int imgWidth, int imgHeight, int stride, struct AlprCRegionOfInterest roi);
+
+// Recognizes an NV12 or I420 frame whose planes are stored separately.  For NV12, uPlane is the interleaved
+// UV plane and vPlane is ignored.  Strides are in bytes.
+// Caller must call free() on the returned object
+char* openalpr_recognize_yuv_planes(OPENALPR* instance, int pixelFormat, int imgWidth, int imgHeight,
+                                    unsigned char* yPlane, int yStride, unsigned char* uPlane, int uStride,
+                                    unsigned char* vPlane, int vStride, struct AlprCRegionOfInterest roi);
+
 // Recognizes the encoded (e.g., JPEG, PNG) image.  bytes are the raw bytes for the image data.
 char* openalpr_recognize_encodedimage(OPENALPR* instance, unsigned char* bytes, long long length, struct AlprCRegionOfInterest roi);
 
+// Recognizes a batch of encoded (e.g., JPEG, PNG) images.  images[i] holds lengths[i] bytes of image data.
+// The plates in all images are analyzed in parallel.  Responds with a JSON array containing one 
+// result object per image, in the same order as the images.
+// Caller must call free() on the returned object
+char* openalpr_recognize_encodedimage_batch(OPENALPR* instance, unsigned char** images, long long* lengths, int num_images);
+
+// Receives the results of an asynchronous recognition request as JSON.  The string is only valid during the call.
+// processed is 0 if the frame was dropped from the queue without being recognized, or if recognizing it failed
+// with an error other than a bad image (e.g., out of memory).
+// Called on one of the library's recognition threads.
+typedef void (*openalpr_async_callback)(const char* json_results, int processed, void* user_data);
+
+// Queues raw pixel data (see openalpr_recognize_frame) for recognition and returns immediately.  Unknown pixel
+// formats are rejected.  The pixel data
+// is not copied and must stay valid until the callback is called.  When the queue is full, the async_drop_policy
+// config setting decides whether to wait, reject this frame or drop the oldest waiting frame.  A callback that
+// queues another frame is never made to wait; the frame is rejected instead.  The JSON results include frame_number,
+// the order the frame was queued in.
+// Returns 1 if the frame was queued, in which case the callback is called exactly once.  Returns 0 if it was rejected
+int openalpr_recognize_frame_async(OPENALPR* instance, unsigned char* pixelData, int pixelFormat, int imgWidth, int imgHeight, int stride, struct AlprCRegionOfInterest roi,
+                                   openalpr_async_callback callback, void* user_data);
+
+// Queues an encoded (e.g., JPEG, PNG) image for recognition and returns immediately.  The bytes are copied.
+// Returns 1 if the image was queued, 0 if it was rejected
+int openalpr_recognize_encodedimage_async(OPENALPR* instance, unsigned char* bytes, long long length, struct AlprCRegionOfInterest roi,
+                                          openalpr_async_callback callback, void* user_data);
+
+// Blocks until every queued frame has been handled
+void openalpr_wait_for_async(OPENALPR* instance);
+
 // Frees a char* response that was provided from a recognition request.
 // This is required for interoperating with managed languages (e.g., C#) that can't free the memory themselves
 void openalpr_free_response_string(char* response);
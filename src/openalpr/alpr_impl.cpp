@@ -20,14 +20,63 @@
 #include "alpr_impl.h"
 #include "result_aggregator.h"
 
+#include <algorithm>
+#include <set>
 
-void plateAnalysisThread(void* arg);
 
 using namespace std;
 using namespace cv;
 
 namespace alpr
 {
+  void addStageTiming(AlprStageTiming& total, const AlprStageTiming& stage_timing)
+  {
+    total.detection += stage_timing.detection;
+    total.char_analysis += stage_timing.char_analysis;
+    total.edge_finding += stage_timing.edge_finding;
+    total.deskew += stage_timing.deskew;
+    total.segmentation += stage_timing.segmentation;
+    total.ocr += stage_timing.ocr;
+    total.postprocess += stage_timing.postprocess;
+    total.aggregation += stage_timing.aggregation;
+  }
+
+  cJSON* createStageTimingJson(const AlprStageTiming& stage_timing)
+  {
+    cJSON* root = cJSON_CreateObject();
+
+    cJSON_AddNumberToObject(root,"detection",	stage_timing.detection);
+    cJSON_AddNumberToObject(root,"char_analysis",	stage_timing.char_analysis);
+    cJSON_AddNumberToObject(root,"edge_finding",	stage_timing.edge_finding);
+    cJSON_AddNumberToObject(root,"deskew",	stage_timing.deskew);
+    cJSON_AddNumberToObject(root,"segmentation",	stage_timing.segmentation);
+    cJSON_AddNumberToObject(root,"ocr",	stage_timing.ocr);
+    cJSON_AddNumberToObject(root,"postprocess",	stage_timing.postprocess);
+    cJSON_AddNumberToObject(root,"aggregation",	stage_timing.aggregation);
+
+    return root;
+  }
+
+  // Results serialized before stage timing was added don't have it.  Missing values are left at 0
+  AlprStageTiming parseStageTimingJson(cJSON* root)
+  {
+    AlprStageTiming stage_timing;
+    if (root == NULL)
+      return stage_timing;
+
+    cJSON* item;
+    if ((item = cJSON_GetObjectItem(root, "detection")) != NULL) stage_timing.detection = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "char_analysis")) != NULL) stage_timing.char_analysis = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "edge_finding")) != NULL) stage_timing.edge_finding = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "deskew")) != NULL) stage_timing.deskew = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "segmentation")) != NULL) stage_timing.segmentation = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "ocr")) != NULL) stage_timing.ocr = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "postprocess")) != NULL) stage_timing.postprocess = item->valuedouble;
+    if ((item = cJSON_GetObjectItem(root, "aggregation")) != NULL) stage_timing.aggregation = item->valuedouble;
+
+    return stage_timing;
+  }
+
   AlprImpl::AlprImpl(const std::string country, const std::string configFile, const std::string runtimeDir)
   {
     
@@ -37,371 +86,1238 @@ namespace alpr
     config = new Config(country, configFile, runtimeDir);
 
     prewarp = ALPR_NULL_PTR;
+    threadPool = ALPR_NULL_PTR;
+    asyncRecognizer = ALPR_NULL_PTR;
+    videoPipeline = ALPR_NULL_PTR;
+    country_configs_stale = false;
+    active_recognitions = 0;
 
     
     // Config file or runtime dir not found.  Don't process any further.
     if (config->loaded == false)
     {
-      return;
-    }
+      return;
+    }
+
+    prewarp = new PreWarp(config);
+    
+    loadRecognizers();
+
+    setNumThreads(0);
+
+    setDetectRegion(DEFAULT_DETECT_REGION);
+    this->topN = DEFAULT_TOPN;
+    setDefaultRegion("");
+    
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    if (config->debugTiming)
+      cout << "OpenALPR Initialization Time: " << diffclock(startTime, endTime) << "ms." << endl;
+
+    if (config->debugGeneral)
+    {
+      ModelRegistryStats model_stats = ModelRegistry::getStats();
+      cout << "Shared models: " << model_stats.models << " loaded (" << (model_stats.bytes_loaded / 1024) << " KB), "
+           << model_stats.references << " references, " << (model_stats.bytes_saved / 1024) << " KB saved by sharing" << endl;
+    }
+    
+  }
+
+  AlprImpl::~AlprImpl()
+  {
+    // Finish the frames being recognized before anything they use is deleted
+    delete asyncRecognizer;
+    delete videoPipeline;
+
+    delete threadPool;
+
+    delete config;
+
+    typedef std::map<std::string, AlprRecognizers>::iterator it_type;
+    for(it_type iterator = recognizers.begin(); iterator != recognizers.end(); iterator++) {
+
+      delete iterator->second.plateDetector;
+      delete iterator->second.stateDetector;
+      delete iterator->second.ocrPool;
+      delete iterator->second.config;
+    }
+
+    delete prewarp;
+  }
+
+  bool AlprImpl::isLoaded()
+  {
+    return config->loaded;
+  }
+
+
+  AlprFullDetails AlprImpl::recognizeFullDetails(cv::Mat img, std::vector<cv::Rect> regionsOfInterest)
+  {
+    AnalysisFrame frame;
+    frame.img = img;
+    frame.regionsOfInterest = regionsOfInterest;
+    frame.detailLevel = ALPR_DETAIL_FULL;
+    frame.context = NULL;
+
+    return recognizeFullDetails(frame);
+  }
+
+  AlprFullDetails AlprImpl::recognizeFullDetails(AnalysisFrame& frame)
+  {
+    std::vector<AnalysisFrame> frames(1, frame);
+
+    // The country/analysis_count passes and the plate regions may optionally be analyzed in parallel.  
+    // Plate regions from different passes are independent, so they run in parallel whenever the passes do
+    ThreadPool* framePool = NULL;
+    ThreadPool* regionPool = NULL;
+    if (config->parallelAnalysisPasses)
+      framePool = getThreadPool();
+    if (config->parallelAnalysisPasses || config->parallelPlateRegions)
+      regionPool = getThreadPool();
+
+    AlprFullDetails response = analyzeFrames(frames, framePool, regionPool)[0];
+    cv::Mat img = frames[0].img;
+
+    if (config->debugTiming)
+    {
+      timespec endTime;
+      getTimeMonotonic(&endTime);
+      cout << "Total Time to process image: " << diffclock(frames[0].startTime, endTime) << "ms." << endl;
+    }
+
+    if (config->debugGeneral && config->debugShowImages && img.data)
+    {
+      for (unsigned int i = 0; i < frames[0].regionsOfInterest.size(); i++)
+      {
+        rectangle(img, frames[0].regionsOfInterest[i], Scalar(0,255,0), 2);
+      }
+
+      for (unsigned int i = 0; i < response.plateRegions.size(); i++)
+      {
+        rectangle(img, response.plateRegions[i].rect, Scalar(0, 0, 255), 2);
+      }
+
+      for (unsigned int i = 0; i < response.results.plates.size(); i++)
+      {
+        // Draw a box around the license plate 
+        for (int z = 0; z < 4; z++)
+        {
+          AlprCoordinate* coords = response.results.plates[i].plate_points;
+          Point p1(coords[z].x, coords[z].y);
+          Point p2(coords[(z + 1) % 4].x, coords[(z + 1) % 4].y);
+          line(img, p1, p2, Scalar(255,0,255), 2);
+        }
+        
+        // Draw the individual character boxes
+        for (int q = 0; q < response.results.plates[i].bestPlate.character_details.size(); q++)
+        {
+          AlprChar details = response.results.plates[i].bestPlate.character_details[q];
+          line(img, Point(details.corners[0].x, details.corners[0].y), Point(details.corners[1].x, details.corners[1].y), Scalar(0,255,0), 1);
+          line(img, Point(details.corners[1].x, details.corners[1].y), Point(details.corners[2].x, details.corners[2].y), Scalar(0,255,0), 1);
+          line(img, Point(details.corners[2].x, details.corners[2].y), Point(details.corners[3].x, details.corners[3].y), Scalar(0,255,0), 1);
+          line(img, Point(details.corners[3].x, details.corners[3].y), Point(details.corners[0].x, details.corners[0].y), Scalar(0,255,0), 1);
+        }
+      }
+
+
+      displayImage(config, "Main Image", img);
+
+      // Sleep 1ms
+      sleep_ms(1);
+
+    }
+
+
+    if (config->debugPauseOnFrame)
+    {
+      // Pause indefinitely until they press a key
+      while ((char) cv::waitKey(50) == -1)
+      {}
+    }
+
+    return response;
+  }
+
+  std::vector<AlprResults> AlprImpl::recognizeBatch(std::vector<AlprFrame> frames)
+  {
+    std::vector<AlprFullDetails> fullDetails = recognizeBatchFullDetails(frames);
+
+    std::vector<AlprResults> results;
+    for (unsigned int i = 0; i < fullDetails.size(); i++)
+      results.push_back(fullDetails[i].results);
+
+    return results;
+  }
+
+  std::vector<AlprFullDetails> AlprImpl::recognizeBatchFullDetails(std::vector<AlprFrame> frames)
+  {
+    std::vector<AnalysisFrame> analysis_frames;
+    for (unsigned int i = 0; i < frames.size(); i++)
+      analysis_frames.push_back(createAnalysisFrame(frames[i]));
+
+    ThreadPool* threadPool = getThreadPool();
+    return analyzeFrames(analysis_frames, threadPool, threadPool);
+  }
+
+  bool AlprImpl::recognizeAsync(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(async_mutex);
+
+      if (asyncRecognizer == NULL)
+        asyncRecognizer = new AsyncRecognizer(this, config->asyncThreads, config->asyncQueueSize, config->asyncDropPolicy);
+    }
+
+    return asyncRecognizer->submit(frame, callback, user_data);
+  }
+
+  void AlprImpl::waitForAsync()
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(async_mutex);
+
+      if (asyncRecognizer == NULL)
+        return;
+    }
+
+    asyncRecognizer->waitForIdle();
+  }
+
+  bool AlprImpl::recognizeVideoFrame(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(video_pipeline_mutex);
+
+      if (videoPipeline == NULL)
+        videoPipeline = new VideoPipeline(this, config->videoPipelineQueueSize);
+    }
+
+    return videoPipeline->submit(frame, callback, user_data);
+  }
+
+  void AlprImpl::waitForVideoFrames()
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(video_pipeline_mutex);
+
+      if (videoPipeline == NULL)
+        return;
+    }
+
+    videoPipeline->waitForIdle();
+  }
+
+  AlprResults AlprImpl::recognize(AlprFrame frame)
+  {
+    try
+    {
+      AnalysisFrame analysis_frame = createAnalysisFrame(frame);
+      return recognizeFullDetails(analysis_frame).results;
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR recognize: " << e.msg << std::endl;
+      AlprResults emptyresults;
+      return emptyresults;
+    }
+  }
+
+  // cvtColor needs the planes of an NV12 or I420 frame in one buffer, with the chroma rows packed right after the 
+  // Y plane (at the Y width for NV12, at half of it for I420).  The caller's buffer is used as-is when it's laid out 
+  // that way.  Otherwise each plane is copied into a packed buffer
+  cv::Mat AlprImpl::getPackedYuv(const AlprFrame& input, int stride)
+  {
+    int width = input.imgWidth;
+    int height = input.imgHeight;
+    int chroma_height = height / 2;
+    bool nv12 = input.pixelFormat == ALPR_PIXEL_FORMAT_NV12;
+
+    if (input.uPlane == ALPR_NULL_PTR && stride == width)
+      return cv::Mat(height + chroma_height, width, CV_8UC1, input.pixelData);
+
+    unsigned char* u_plane = input.uPlane;
+    int u_stride = input.uStride;
+    unsigned char* v_plane = input.vPlane;
+    int v_stride = input.vStride;
+    if (u_plane == ALPR_NULL_PTR)
+    {
+      u_plane = input.pixelData + stride * height;
+      u_stride = nv12 ? stride : stride / 2;
+      v_plane = u_plane + u_stride * chroma_height;
+      v_stride = u_stride;
+    }
+
+    cv::Mat packed(height + chroma_height, width, CV_8UC1);
+    cv::Mat(height, width, CV_8UC1, input.pixelData, stride).copyTo(packed.rowRange(0, height));
+
+    unsigned char* chroma = packed.ptr<unsigned char>(height);
+    if (nv12)
+    {
+      cv::Mat(chroma_height, width, CV_8UC1, u_plane, u_stride).copyTo(cv::Mat(chroma_height, width, CV_8UC1, chroma));
+    }
+    else
+    {
+      int chroma_width = width / 2;
+      cv::Mat(chroma_height, chroma_width, CV_8UC1, u_plane, u_stride).copyTo(cv::Mat(chroma_height, chroma_width, CV_8UC1, chroma));
+      cv::Mat(chroma_height, chroma_width, CV_8UC1, v_plane, v_stride).copyTo(cv::Mat(chroma_height, chroma_width, CV_8UC1, chroma + chroma_height * chroma_width));
+    }
+
+    return packed;
+  }
+
+  // Wraps the caller's pixel data without copying it.  Encoded images are decoded later, by prepareFrame
+  AnalysisFrame AlprImpl::createAnalysisFrame(AlprFrame input)
+  {
+    AnalysisFrame frame;
+    frame.context = NULL;
+
+    frame.regionsOfInterest = convertRects(input.regionsOfInterest);
+    frame.detailLevel = input.detailLevel;
+
+    if (input.pixelData == ALPR_NULL_PTR)
+    {
+      frame.imageBytes = input.imageBytes;
+      return frame;
+    }
+
+    int stride = input.stride;
+    if (stride <= 0)
+      stride = input.imgWidth * input.bytesPerPixel;
+
+    if (input.pixelFormat == ALPR_PIXEL_FORMAT_NV12 || input.pixelFormat == ALPR_PIXEL_FORMAT_I420)
+    {
+      // The Y plane is the grayscale image
+      frame.inputGray = cv::Mat(input.imgHeight, input.imgWidth, CV_8UC1, input.pixelData, stride);
+
+      // Color is only needed for region detection.  Otherwise, skip the conversion and use the grayscale image
+      if (detectRegion)
+      {
+        cv::Mat yuv = getPackedYuv(input, stride);
+        if (input.pixelFormat == ALPR_PIXEL_FORMAT_NV12)
+          cvtColor(yuv, frame.img, CV_YUV2BGR_NV12);
+        else
+          cvtColor(yuv, frame.img, CV_YUV2BGR_I420);
+      }
+      else
+      {
+        frame.img = frame.inputGray;
+      }
+    }
+    else
+    {
+      frame.img = cv::Mat(input.imgHeight, input.imgWidth, CV_8UC(input.bytesPerPixel), input.pixelData, stride);
+    }
+
+    if (frame.regionsOfInterest.size() == 0)
+      frame.regionsOfInterest.push_back(cv::Rect(0, 0, input.imgWidth, input.imgHeight));
+
+    return frame;
+  }
+
+  // Analyzes each frame for every loaded country and analysis_count iteration.  The work is split into 
+  // stages (prepare the frames, find plate regions in each pass, analyze each plate region).  The first two  
+  // stages run on framePool and the plate regions are analyzed on regionPool.  A NULL pool runs the stage 
+  // on the calling thread in order
+  std::vector<AlprFullDetails> AlprImpl::analyzeFrames(std::vector<AnalysisFrame>& frames, ThreadPool* framePool, ThreadPool* regionPool)
+  {
+    AnalysisBatch batch;
+    batch.frames = frames;
+    // The passes of each frame run one round at a time with early exit, so it's off when they're meant to run at once.
+    // The frames of a batch still run in parallel
+    batch.earlyExit = config->earlyExitConfidence > 0 && !config->parallelAnalysisPasses;
+
+    try
+    {
+      prepareBatch(batch, framePool);
+
+      // With early exit, each frame's passes are run one round at a time and the remaining passes are 
+      // skipped once a good enough plate is found.  Otherwise all of the passes run at once
+      std::vector<std::vector<AnalysisPass*> > rounds;
+      if (batch.earlyExit)
+      {
+        for (unsigned int i = 0; i < batch.frames.size(); i++)
+        {
+          for (unsigned int pass_idx = 0; pass_idx < batch.framePasses[i].size(); pass_idx++)
+          {
+            if (rounds.size() <= pass_idx)
+              rounds.push_back(std::vector<AnalysisPass*>());
+            rounds[pass_idx].push_back(&batch.passes[batch.framePasses[i][pass_idx]]);
+          }
+        }
+      }
+      else
+      {
+        rounds.push_back(getBatchPasses(batch));
+      }
+
+      std::set<AnalysisFrame*> finished_frames;
+      for (unsigned int round_idx = 0; round_idx < rounds.size(); round_idx++)
+      {
+        std::vector<AnalysisPass*> round_passes;
+        for (unsigned int i = 0; i < rounds[round_idx].size(); i++)
+        {
+          if (finished_frames.count(rounds[round_idx][i]->frame) == 0)
+            round_passes.push_back(rounds[round_idx][i]);
+        }
+
+        detectPlates(round_passes, framePool);
+        analyzePlateRegions(round_passes, regionPool);
+
+        if (batch.earlyExit)
+        {
+          for (unsigned int i = 0; i < round_passes.size(); i++)
+          {
+            if (isEarlyExitResult(round_passes[i]))
+              finished_frames.insert(round_passes[i]->frame);
+          }
+        }
+      }
+    }
+    catch (std::exception& e)
+    {
+      // Rethrown from a worker thread.  The frames' images are released before passing it on
+      releaseBatchFrames(batch);
+      throw;
+    }
+
+    std::vector<AlprFullDetails> responses = aggregateBatch(batch);
+
+    // Hand back the decoded images and start times
+    frames = batch.frames;
+
+    return responses;
+  }
+
+  // Decodes and prepares the batch's frames and lists the passes over them
+  void AlprImpl::prepareBatch(AnalysisBatch& batch, ThreadPool* framePool)
+  {
+    beginRecognition();
+    batch.readingConfigs = true;
+
+    std::vector<void*> frame_args;
+    for (unsigned int i = 0; i < batch.frames.size(); i++)
+      frame_args.push_back(new std::pair<AlprImpl*, AnalysisFrame*>(this, &batch.frames[i]));
+
+    runTasks(framePool, prepareFrameTask, frame_args);
+
+    for (unsigned int i = 0; i < frame_args.size(); i++)
+      delete (std::pair<AlprImpl*, AnalysisFrame*>*) frame_args[i];
+
+    for (unsigned int i = 0; i < batch.frames.size(); i++)
+      batch.frames[i].error.rethrow();
+
+    // With early exit enabled, the countries that recently found plates are tried first
+    batch.countries = config->loaded_countries;
+    if (batch.earlyExit)
+      batch.countries = getCountryOrder();
+
+    // Each frame is analyzed once per country and analysis iteration
+    batch.passes.clear();
+    batch.framePasses.clear();
+    batch.framePasses.resize(batch.frames.size());
+    for (unsigned int i = 0; i < batch.frames.size(); i++)
+    {
+      if (batch.frames[i].context == NULL)
+        continue;
+
+      for (unsigned int country_idx = 0; country_idx < batch.countries.size(); country_idx++)
+      {
+        std::map<std::string, AlprRecognizers>::iterator recognizer_it = recognizers.find(batch.countries[country_idx]);
+
+        for (unsigned int iteration = 0; iteration < config->analysis_count; iteration++)
+        {
+          AnalysisPass pass;
+          pass.frame = &batch.frames[i];
+          pass.recognizers = &recognizer_it->second;
+          pass.iteration = iteration;
+          pass.analyzed = false;
+
+          batch.framePasses[i].push_back(batch.passes.size());
+          batch.passes.push_back(pass);
+        }
+      }
+    }
+  }
+
+  std::vector<AnalysisPass*> AlprImpl::getBatchPasses(AnalysisBatch& batch)
+  {
+    std::vector<AnalysisPass*> passes;
+    for (unsigned int i = 0; i < batch.passes.size(); i++)
+      passes.push_back(&batch.passes[i]);
+
+    return passes;
+  }
+
+  // Aggregates the results of each frame across iterations and countries.  The frames' images are released afterwards
+  std::vector<AlprFullDetails> AlprImpl::aggregateBatch(AnalysisBatch& batch)
+  {
+    std::vector<AlprFullDetails> responses;
+    for (unsigned int i = 0; i < batch.frames.size(); i++)
+    {
+      AnalysisFrame* frame = &batch.frames[i];
+      AlprFullDetails response;
+
+      for (unsigned int roi_idx = 0; roi_idx < frame->regionsOfInterest.size(); roi_idx++)
+      {
+        cv::Rect roi = frame->regionsOfInterest[roi_idx];
+        response.results.regionsOfInterest.push_back(AlprRegionOfInterest(roi.x, roi.y, roi.width, roi.height));
+      }
+
+      if (batch.framePasses[i].size() == 0)
+      {
+        responses.push_back(response);
+        continue;
+      }
+
+      timespec aggregationStartTime;
+      getTimeMonotonic(&aggregationStartTime);
+
+      AlprStageTiming stage_timing;
+
+      int passes_analyzed = 0;
+
+      ResultAggregator country_aggregator(MERGE_PICK_BEST, topN, config);
+      for (unsigned int country_idx = 0; country_idx < batch.countries.size(); country_idx++)
+      {
+        ResultAggregator iter_aggregator(MERGE_COMBINE, topN, config);
+        bool country_analyzed = false;
+        for (unsigned int iteration = 0; iteration < config->analysis_count; iteration++)
+        {
+          AnalysisPass* pass = &batch.passes[batch.framePasses[i][country_idx * config->analysis_count + iteration]];
+          if (!pass->analyzed)
+            continue;
+
+          AlprFullDetails pass_results = getPassResults(pass);
+          addStageTiming(stage_timing, pass_results.results.stage_timing);
+
+          iter_aggregator.addResults(pass_results);
+          country_analyzed = true;
+          passes_analyzed++;
+        }
+
+        // Skipped by early exit
+        if (!country_analyzed)
+          continue;
+
+        AlprFullDetails sub_results = iter_aggregator.getAggregateResults();
+        sub_results.results.epoch_time = frame->start_time;
+        sub_results.results.img_width = frame->img.cols;
+        sub_results.results.img_height = frame->img.rows;
+        sub_results.results.regionsOfInterest = response.results.regionsOfInterest;
+
+        country_aggregator.addResults(sub_results);
+      }
+
+      response = country_aggregator.getAggregateResults();
+      response.passesAnalyzed = passes_analyzed;
+
+      // Each plate still has its best plate as its only candidate, which was needed to combine the iterations
+      if (frame->detailLevel == ALPR_DETAIL_PLATE)
+      {
+        for (unsigned int plate_idx = 0; plate_idx < response.results.plates.size(); plate_idx++)
+          response.results.plates[plate_idx].topNPlates.clear();
+      }
+
+      timespec aggregationEndTime;
+      getTimeMonotonic(&aggregationEndTime);
+      stage_timing.aggregation = diffclock(aggregationStartTime, aggregationEndTime);
+      response.results.stage_timing = stage_timing;
+
+      if (batch.earlyExit)
+        updateCountryOrder(response);
+
+      responses.push_back(response);
+    }
+
+    releaseBatchFrames(batch);
+
+    return responses;
+  }
+
+  void AlprImpl::releaseBatchFrames(AnalysisBatch& batch)
+  {
+    for (unsigned int i = 0; i < batch.frames.size(); i++)
+    {
+      if (config->debugTiming && batch.frames[i].context != NULL)
+        cout << "Image allocations avoided: " << batch.frames[i].context->getAllocationsAvoided() << endl;
+
+      delete batch.frames[i].context;
+      batch.frames[i].context = NULL;
+    }
+
+    if (batch.readingConfigs)
+    {
+      batch.readingConfigs = false;
+      endRecognition();
+    }
+  }
+
+  // Finds the plate regions in each pass
+  void AlprImpl::detectPlates(std::vector<AnalysisPass*> passes, ThreadPool* framePool)
+  {
+    std::vector<void*> pass_args;
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+      passes[i]->analyzed = true;
+      pass_args.push_back(new std::pair<AlprImpl*, AnalysisPass*>(this, passes[i]));
+    }
+
+    runTasks(framePool, findPlateRegionsTask, pass_args);
+
+    for (unsigned int i = 0; i < pass_args.size(); i++)
+      delete (std::pair<AlprImpl*, AnalysisPass*>*) pass_args[i];
+
+    for (unsigned int i = 0; i < passes.size(); i++)
+      passes[i]->error.rethrow();
+  }
+
+  // Analyzes the plate regions found in each pass
+  void AlprImpl::analyzePlateRegions(std::vector<AnalysisPass*> passes, ThreadPool* regionPool)
+  {
+    // Every top-level plate region from every frame is independent.  Analyze them all at once.
+    // In parallel_plate_regions mode, the children of each region are analyzed at the same time as their
+    // parent rather than waiting to see if the parent is a plate.  This wastes some work but keeps the 
+    // latency of a frame close to the time needed for its slowest region.
+    bool speculative = config->parallelPlateRegions && regionPool != NULL;
+
+    std::vector<void*> region_args;
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+      passes[i]->regionResults.resize(passes[i]->warpedPlateRegions.size());
+      passes[i]->regionStageTiming.resize(passes[i]->warpedPlateRegions.size());
+      passes[i]->regionErrors.resize(passes[i]->warpedPlateRegions.size());
+
+      if (speculative)
+        addSpeculativeRegions(passes[i]);
+
+      unsigned int num_tasks = speculative ? passes[i]->speculativeRegions.size() : passes[i]->warpedPlateRegions.size();
+      for (unsigned int task_idx = 0; task_idx < num_tasks; task_idx++)
+      {
+        std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >* region_arg = 
+                new std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >(this, std::pair<AnalysisPass*, int>(passes[i], task_idx));
+        region_args.push_back(region_arg);
+      }
+    }
+
+    if (speculative)
+      runTasks(regionPool, analyzeSpeculativeRegionTask, region_args);
+    else
+      runTasks(regionPool, analyzePlateRegionTask, region_args);
+
+    for (unsigned int i = 0; i < region_args.size(); i++)
+      delete (std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >*) region_args[i];
+
+    for (unsigned int i = 0; i < passes.size(); i++)
+    {
+      for (unsigned int region_idx = 0; region_idx < passes[i]->regionErrors.size(); region_idx++)
+        passes[i]->regionErrors[region_idx].rethrow();
+      for (unsigned int region_idx = 0; region_idx < passes[i]->speculativeRegions.size(); region_idx++)
+        passes[i]->speculativeRegions[region_idx].error.rethrow();
+    }
+
+    if (speculative)
+    {
+      // Keep the same results that analyzing each region one at a time would have found
+      for (unsigned int i = 0; i < passes.size(); i++)
+      {
+        for (unsigned int region_idx = 0; region_idx < passes[i]->warpedPlateRegions.size(); region_idx++)
+          getSpeculativeResults(passes[i], region_idx, passes[i]->regionResults[region_idx]);
+      }
+    }
+  }
+
+  // True if the pass found a plate that is good enough to skip the remaining passes for the frame
+  bool AlprImpl::isEarlyExitResult(AnalysisPass* pass)
+  {
+    for (unsigned int i = 0; i < pass->regionResults.size(); i++)
+    {
+      for (unsigned int k = 0; k < pass->regionResults[i].size(); k++)
+      {
+        AlprPlate bestPlate = pass->regionResults[i][k].plate.bestPlate;
+
+        if (config->earlyExitMustMatchPattern && !bestPlate.matches_template)
+          continue;
+
+        if (bestPlate.overall_confidence >= config->earlyExitConfidence)
+          return true;
+      }
+    }
+
+    return false;
+  }
+
+  // The loaded countries, with the countries that found plates most recently first
+  std::vector<std::string> AlprImpl::getCountryOrder()
+  {
+    tthread::lock_guard<tthread::mutex> guard(country_order_mutex);
+
+    std::vector<std::string> countries;
+    for (unsigned int i = 0; i < country_order.size(); i++)
+    {
+      if (std::find(config->loaded_countries.begin(), config->loaded_countries.end(), country_order[i]) != config->loaded_countries.end())
+        countries.push_back(country_order[i]);
+    }
+
+    for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
+    {
+      if (std::find(countries.begin(), countries.end(), config->loaded_countries[i]) == countries.end())
+        countries.push_back(config->loaded_countries[i]);
+    }
+
+    country_order = countries;
+    return countries;
+  }
+
+  // Moves the country with the most confident plate to the front of the country order
+  void AlprImpl::updateCountryOrder(AlprFullDetails& response)
+  {
+    if (response.results.plates.size() == 0)
+      return;
+
+    AlprPlateResult* best_result = &response.results.plates[0];
+    for (unsigned int i = 1; i < response.results.plates.size(); i++)
+    {
+      if (response.results.plates[i].bestPlate.overall_confidence > best_result->bestPlate.overall_confidence)
+        best_result = &response.results.plates[i];
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(country_order_mutex);
+
+    std::vector<std::string>::iterator country_it = std::find(country_order.begin(), country_order.end(), best_result->country);
+    if (country_it == country_order.end() || country_it == country_order.begin())
+      return;
+
+    country_order.erase(country_it);
+    country_order.insert(country_order.begin(), best_result->country);
+  }
+
+  void AlprImpl::runTasks(ThreadPool* threadPool, ThreadPoolTask task, std::vector<void*> args)
+  {
+    if (threadPool == NULL)
+    {
+      for (unsigned int i = 0; i < args.size(); i++)
+        task(args[i]);
+    }
+    else
+    {
+      threadPool->runAll(task, args);
+    }
+  }
+
+  ThreadPool* AlprImpl::getThreadPool()
+  {
+    tthread::lock_guard<tthread::mutex> guard(thread_pool_mutex);
+
+    if (threadPool == NULL)
+      threadPool = new ThreadPool(config->workerThreads);
+
+    return threadPool;
+  }
+
+  // Decodes the image (if necessary), converts it to grayscale and applies the prewarp
+  void AlprImpl::prepareFrame(AnalysisFrame* frame)
+  {
+    getTimeMonotonic(&frame->startTime);
+    frame->start_time = getEpochTimeMs();
+
+    if (frame->imageBytes.size() > 0)
+    {
+      frame->img = cv::imdecode(cv::Mat(frame->imageBytes), 1);
+      frame->imageBytes.clear();
+
+      if (frame->regionsOfInterest.size() == 0 && frame->img.data)
+        frame->regionsOfInterest.push_back(cv::Rect(0, 0, frame->img.cols, frame->img.rows));
+    }
+
+    cv::Mat img = frame->img;
+
+    // Fix regions of interest in case they extend beyond the bounds of the image
+    for (unsigned int i = 0; i < frame->regionsOfInterest.size(); i++)
+      frame->regionsOfInterest[i] = expandRect(frame->regionsOfInterest[i], 0, 0, img.cols, img.rows);
+
+    if (!img.data)
+    {
+      // Invalid image
+      if (this->config->debugGeneral)
+        std::cerr << "Invalid image" << std::endl;
+
+      return;
+    }
+
+    // The grayscale and warped images are created here, once, and shared by every pass over the frame
+    frame->context = new FrameContext(config, prewarp, img, frame->inputGray);
+    
+    // Warp the ROIs if prewarp is provided
+    Mat warpedGray = frame->context->getWarpedGray();
+    frame->warpTransform = frame->context->getWarpTransform();
+    frame->warpedRegionsOfInterest = PreWarp::projectRects(frame->regionsOfInterest, frame->warpTransform, warpedGray.cols, warpedGray.rows, false);
+  }
+
+  void AlprImpl::findPlateRegions(AnalysisPass* pass)
+  {
+    getTimeMonotonic(&pass->startTime);
+
+    Config* country_config = pass->recognizers->config;
+
+    if (country_config->debugGeneral)
+      cout << "Analyzing: " << country_config->country << endl;
+
+    // Reapply analysis for each multiple analysis value set in the config,
+    // make a minor imperceptible tweak to the input image each time.
+    // The tweaked image is shared by every country analyzing this iteration
+    pass->context = pass->frame->context->getIteration(pass->iteration);
+    pass->grayImg = pass->context->getWarpedGray();
+
+    // Find all the candidate regions
+    if (country_config->skipDetection == false)
+    {
+      timespec detectionStartTime;
+      getTimeMonotonic(&detectionStartTime);
 
-    prewarp = new PreWarp(config);
-    
-    loadRecognizers();
+      // Tiles of large frames are searched in parallel.  Tasks may use the pool that is running them
+      ThreadPool* tilePool = NULL;
+      if (country_config->detectionTiling)
+        tilePool = getThreadPool();
 
-    setNumThreads(0);
+      pass->warpedPlateRegions = pass->recognizers->plateDetector->detect(pass->context, pass->frame->warpedRegionsOfInterest, tilePool);
 
-    setDetectRegion(DEFAULT_DETECT_REGION);
-    this->topN = DEFAULT_TOPN;
-    setDefaultRegion("");
-    
-    timespec endTime;
-    getTimeMonotonic(&endTime);
-    if (config->debugTiming)
-      cout << "OpenALPR Initialization Time: " << diffclock(startTime, endTime) << "ms." << endl;
-    
+      timespec detectionEndTime;
+      getTimeMonotonic(&detectionEndTime);
+      pass->stageTiming.detection = diffclock(detectionStartTime, detectionEndTime);
+    }
+    else
+    {
+      // They have elected to skip plate detection.  Instead, return a list of plate regions
+      // based on their regions of interest
+      for (unsigned int i = 0; i < pass->frame->warpedRegionsOfInterest.size(); i++)
+      {
+        PlateRegion pr;
+        pr.rect = cv::Rect(pass->frame->warpedRegionsOfInterest[i]);
+        pass->warpedPlateRegions.push_back(pr);
+      }
+    }
   }
 
-  AlprImpl::~AlprImpl()
+  // Analyzes the plate region.  If no plate is found, its children are analyzed instead
+  void AlprImpl::analyzePlateRegion(AnalysisPass* pass, PlateRegion plateRegion, std::vector<int> path, OCR* ocr, std::vector<PlateRegionResult>& results, AlprStageTiming& stage_timing)
   {
-    delete config;
-
-    typedef std::map<std::string, AlprRecognizers>::iterator it_type;
-    for(it_type iterator = recognizers.begin(); iterator != recognizers.end(); iterator++) {
+    PlateRegionResult result;
+    bool plateFound = analyzePlate(pass, plateRegion, ocr, result.plate);
+    addStageTiming(stage_timing, result.plate.stage_timing);
 
-      delete iterator->second.plateDetector;
-      delete iterator->second.stateDetector;
-      delete iterator->second.ocr;
+    if (plateFound)
+    {
+      result.path = path;
+      results.push_back(result);
+      return;
     }
 
-    delete prewarp;
+    // Not a valid plate
+    // Check if this plate has any children, if so, send them back up for processing
+    for (unsigned int childidx = 0; childidx < plateRegion.children.size(); childidx++)
+    {
+      std::vector<int> child_path = path;
+      child_path.push_back(childidx);
+      analyzePlateRegion(pass, plateRegion.children[childidx], child_path, ocr, results, stage_timing);
+    }
   }
 
-  bool AlprImpl::isLoaded()
+  bool AlprImpl::analyzePlate(AnalysisPass* pass, PlateRegion plateRegion, OCR* ocr, AlprPlateResult& plateResult)
   {
-    return config->loaded;
-  }
+    Config* country_config = pass->recognizers->config;
 
+    // Declared before pipeline_data so the pool is returned after the plate's images are released
+    ScopedMatPool mat_pool(&mat_pools);
+    int allocations_avoided = mat_pool.get()->allocationsAvoided();
 
-  AlprFullDetails AlprImpl::recognizeFullDetails(cv::Mat img, std::vector<cv::Rect> regionsOfInterest)
-  {
-    timespec startTime;
-    getTimeMonotonic(&startTime);
+    PipelineData pipeline_data(pass->frame->img, pass->grayImg, plateRegion.rect, country_config);
+    pipeline_data.prewarp_transform = pass->frame->warpTransform;
+    pipeline_data.mat_pool = mat_pool.get();
 
+    timespec platestarttime;
+    getTimeMonotonic(&platestarttime);
 
-    AlprFullDetails response;
+    LicensePlateCandidate lp(&pipeline_data);
 
-    int64_t start_time = getEpochTimeMs();
+    lp.recognize();
 
-    // Fix regions of interest in case they extend beyond the bounds of the image
-    for (unsigned int i = 0; i < regionsOfInterest.size(); i++)
-      regionsOfInterest[i] = expandRect(regionsOfInterest[i], 0, 0, img.cols, img.rows);
+    // Recorded even if the region is disqualified, since the time still counts towards the frame
+    plateResult.stage_timing = pipeline_data.stage_timing;
 
-    for (unsigned int i = 0; i < regionsOfInterest.size(); i++)
+    if (pipeline_data.disqualified && country_config->debugGeneral)
     {
-      response.results.regionsOfInterest.push_back(AlprRegionOfInterest(regionsOfInterest[i].x, regionsOfInterest[i].y,
-              regionsOfInterest[i].width, regionsOfInterest[i].height));
+      cout << "Disqualify reason: " << pipeline_data.disqualify_reason << endl;
     }
-
-    if (!img.data)
+    if (pipeline_data.disqualified)
     {
-      // Invalid image
-      if (this->config->debugGeneral)
-        std::cerr << "Invalid image" << std::endl;
+      pass->context->addAllocationsAvoided(mat_pool.get()->allocationsAvoided() - allocations_avoided);
+      return false;
+    }
 
-      return response;
+    plateResult.country = country_config->country;
+    
+    // If there's only one pattern for a country, use it.  Otherwise use the default
+    if (ocr->postProcessor.getPatterns().size() == 1)
+      plateResult.region = ocr->postProcessor.getPatterns()[0];
+    else
+      plateResult.region = defaultRegion;
+    
+    plateResult.regionConfidence = 0;
+    plateResult.requested_topn = topN;
+
+    // If using prewarp, remap the plate corners to the original image
+    vector<Point2f> cornerPoints = pipeline_data.plate_corners;
+    cornerPoints = PreWarp::projectPoints(cornerPoints, pipeline_data.prewarp_transform, true);
+
+    for (int pointidx = 0; pointidx < 4; pointidx++)
+    {
+      plateResult.plate_points[pointidx].x = (int) cornerPoints[pointidx].x;
+      plateResult.plate_points[pointidx].y = (int) cornerPoints[pointidx].y;
     }
 
-    // Convert image to grayscale if required
-    Mat grayImg = img;
-    if (img.channels() > 2)
-      cvtColor( img, grayImg, CV_BGR2GRAY );
     
-    // Prewarp the image and ROIs if configured]
-    std::vector<cv::Rect> warpedRegionsOfInterest = regionsOfInterest;
-    // Warp the image if prewarp is provided
-    grayImg = prewarp->warpImage(grayImg);
-    warpedRegionsOfInterest = prewarp->projectRects(regionsOfInterest, grayImg.cols, grayImg.rows, false);
-
-    // Iterate through each country provided (typically just one)
-    // and aggregate the results if necessary
-    ResultAggregator country_aggregator(MERGE_PICK_BEST, topN, config);
-    for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
+    #ifndef SKIP_STATE_DETECTION
+    if (detectRegion && pass->recognizers->stateDetector->isLoaded())
     {
-      if (config->debugGeneral)
-        cout << "Analyzing: " << config->loaded_countries[i] << endl;
+      tthread::lock_guard<tthread::mutex> guard(state_detector_mutex);
+      std::vector<StateCandidate> state_candidates = pass->recognizers->stateDetector->detect(pipeline_data.color_deskewed.data,
+                                                                           pipeline_data.color_deskewed.elemSize(),
+                                                                           pipeline_data.color_deskewed.cols,
+                                                                           pipeline_data.color_deskewed.rows);
 
-      config->setCountry(config->loaded_countries[i]);
-      
-      // Reapply analysis for each multiple analysis value set in the config,
-      // make a minor imperceptible tweak to the input image each time
-      ResultAggregator iter_aggregator(MERGE_COMBINE, topN, config);
-      for (unsigned int iteration = 0; iteration < config->analysis_count; iteration++)
+      if (state_candidates.size() > 0)
       {
-        Mat iteration_image = iter_aggregator.applyImperceptibleChange(grayImg, iteration);
-        //drawAndWait(iteration_image);
-        AlprFullDetails iter_results = analyzeSingleCountry(img, iteration_image, warpedRegionsOfInterest);
-        iter_aggregator.addResults(iter_results);
+        plateResult.region = state_candidates[0].state_code;
+        plateResult.regionConfidence = (int) state_candidates[0].confidence;
       }
-      
-      AlprFullDetails sub_results = iter_aggregator.getAggregateResults();
-      sub_results.results.epoch_time = start_time;
-      sub_results.results.img_width = img.cols;
-      sub_results.results.img_height = img.rows;
-      sub_results.results.regionsOfInterest = response.results.regionsOfInterest;
-      
-      country_aggregator.addResults(sub_results);
     }
-    response = country_aggregator.getAggregateResults();
+    #endif
 
-    timespec endTime;
-    getTimeMonotonic(&endTime);
-    if (config->debugTiming)
+    if (plateResult.region.length() > 0 && ocr->postProcessor.regionIsValid(plateResult.region) == false)
     {
-      cout << "Total Time to process image: " << diffclock(startTime, endTime) << "ms." << endl;
+      std::cerr << "Invalid pattern provided: " << plateResult.region << std::endl;
+      std::cerr << "Valid patterns are located in the " << country_config->country << ".patterns file" << std::endl;
     }
 
-    if (config->debugGeneral && config->debugShowImages)
+    // The lines and thresholds of the plate are independent until their letters are combined
+    ThreadPool* ocrPool = NULL;
+    if (country_config->parallelOcr)
+      ocrPool = getThreadPool();
+
+    ocr->performOCR(&pipeline_data, ocrPool);
+    plateResult.stage_timing.segmentation = pipeline_data.stage_timing.segmentation;
+    plateResult.stage_timing.ocr = pipeline_data.stage_timing.ocr;
+
+    timespec postProcessStartTime;
+    getTimeMonotonic(&postProcessStartTime);
+
+    // At the plate detail level only the best plate is generated, and it's the only candidate the iterations are combined from
+    ocr->postProcessor.analyze(plateResult.region, topN, pass->frame->detailLevel == ALPR_DETAIL_PLATE);
+
+    timespec resultsStartTime;
+    getTimeMonotonic(&resultsStartTime);
+
+    const vector<PPResult> ppResults = ocr->postProcessor.getResults();
+
+    int bestPlateIndex = 0;
+
+    // Every candidate is built from the same character boxes, so each box is transformed once
+    std::vector<std::vector<AlprCoordinate> > charPoints;
+    if (pass->frame->detailLevel == ALPR_DETAIL_FULL)
+      charPoints = getCharacterPoints(pipeline_data.charRegionsFlat, getCharacterTransformMatrix(&pipeline_data), pipeline_data.prewarp_transform);
+
+    bool isBestPlateSelected = false;
+    for (unsigned int pp = 0; pp < ppResults.size(); pp++)
     {
-      for (unsigned int i = 0; i < regionsOfInterest.size(); i++)
-      {
-        rectangle(img, regionsOfInterest[i], Scalar(0,255,0), 2);
-      }
 
-      for (unsigned int i = 0; i < response.plateRegions.size(); i++)
-      {
-        rectangle(img, response.plateRegions[i].rect, Scalar(0, 0, 255), 2);
+      // Set our "best plate" match to either the first entry, or the first entry with a postprocessor template match
+      if (isBestPlateSelected == false && ppResults[pp].matchesTemplate){
+        bestPlateIndex = plateResult.topNPlates.size();
+        isBestPlateSelected = true;
       }
 
-      for (unsigned int i = 0; i < response.results.plates.size(); i++)
+      AlprPlate aplate;
+      aplate.characters = ppResults[pp].letters;
+      aplate.overall_confidence = ppResults[pp].totalscore;
+      aplate.matches_template = ppResults[pp].matchesTemplate;
+
+      // Grab detailed results for each character
+      for (unsigned int c_idx = 0; charPoints.size() > 0 && c_idx < ppResults[pp].letter_details.size(); c_idx++)
       {
-        // Draw a box around the license plate 
-        for (int z = 0; z < 4; z++)
-        {
-          AlprCoordinate* coords = response.results.plates[i].plate_points;
-          Point p1(coords[z].x, coords[z].y);
-          Point p2(coords[(z + 1) % 4].x, coords[(z + 1) % 4].y);
-          line(img, p1, p2, Scalar(255,0,255), 2);
-        }
+        AlprChar character_details;
+        Letter l = ppResults[pp].letter_details[c_idx];
         
-        // Draw the individual character boxes
-        for (int q = 0; q < response.results.plates[i].bestPlate.character_details.size(); q++)
-        {
-          AlprChar details = response.results.plates[i].bestPlate.character_details[q];
-          line(img, Point(details.corners[0].x, details.corners[0].y), Point(details.corners[1].x, details.corners[1].y), Scalar(0,255,0), 1);
-          line(img, Point(details.corners[1].x, details.corners[1].y), Point(details.corners[2].x, details.corners[2].y), Scalar(0,255,0), 1);
-          line(img, Point(details.corners[2].x, details.corners[2].y), Point(details.corners[3].x, details.corners[3].y), Scalar(0,255,0), 1);
-          line(img, Point(details.corners[3].x, details.corners[3].y), Point(details.corners[0].x, details.corners[0].y), Scalar(0,255,0), 1);
-        }
+        character_details.character = l.letter;
+        character_details.confidence = l.totalscore;
+        for (int cpt = 0; cpt < 4; cpt++)
+          character_details.corners[cpt] = charPoints[l.charposition][cpt];
+        aplate.character_details.push_back(character_details);
       }
+      plateResult.topNPlates.push_back(aplate);
+    }
 
+    if (plateResult.topNPlates.size() > bestPlateIndex)
+    {
+      AlprPlate bestPlate;
+      bestPlate.characters = plateResult.topNPlates[bestPlateIndex].characters;
+      bestPlate.matches_template = plateResult.topNPlates[bestPlateIndex].matches_template;
+      bestPlate.overall_confidence = plateResult.topNPlates[bestPlateIndex].overall_confidence;
+      bestPlate.character_details = plateResult.topNPlates[bestPlateIndex].character_details;
 
-      displayImage(config, "Main Image", img);
-
-      // Sleep 1ms
-      sleep_ms(1);
-
+      plateResult.bestPlate = bestPlate;
     }
 
-
-    if (config->debugPauseOnFrame)
+    timespec plateEndTime;
+    getTimeMonotonic(&plateEndTime);
+    plateResult.processing_time_ms = diffclock(platestarttime, plateEndTime);
+    plateResult.stage_timing.postprocess = diffclock(postProcessStartTime, plateEndTime);
+    if (country_config->debugTiming)
     {
-      // Pause indefinitely until they press a key
-      while ((char) cv::waitKey(50) == -1)
-      {}
+      cout << "Result Generation Time: " << diffclock(resultsStartTime, plateEndTime) << "ms." << endl;
     }
 
-    return response;
+    pass->context->addAllocationsAvoided(mat_pool.get()->allocationsAvoided() - allocations_avoided);
+
+    return plateResult.topNPlates.size() > 0;
   }
 
-  AlprFullDetails AlprImpl::analyzeSingleCountry(cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest)
+  // Lists every plate region and child region in breadth-first order, so the 
+  // top-level regions have the same indexes as in warpedPlateRegions
+  void AlprImpl::addSpeculativeRegions(AnalysisPass* pass)
   {
-    AlprFullDetails response;
-    
-    AlprRecognizers country_recognizers = recognizers[config->country];
-    timespec startTime;
-    getTimeMonotonic(&startTime);
-
-    vector<PlateRegion> warpedPlateRegions;
-    // Find all the candidate regions
-    if (config->skipDetection == false)
+    for (unsigned int i = 0; i < pass->warpedPlateRegions.size(); i++)
     {
-      warpedPlateRegions = country_recognizers.plateDetector->detect(grayImg, warpedRegionsOfInterest);
+      SpeculativeRegion speculative_region;
+      speculative_region.region = pass->warpedPlateRegions[i];
+      speculative_region.path.push_back(i);
+      speculative_region.plateFound = false;
+      pass->speculativeRegions.push_back(speculative_region);
     }
-    else
+
+    for (unsigned int i = 0; i < pass->speculativeRegions.size(); i++)
     {
-      // They have elected to skip plate detection.  Instead, return a list of plate regions
-      // based on their regions of interest
-      for (unsigned int i = 0; i < warpedRegionsOfInterest.size(); i++)
+      for (unsigned int childidx = 0; childidx < pass->speculativeRegions[i].region.children.size(); childidx++)
       {
-        PlateRegion pr;
-        pr.rect = cv::Rect(warpedRegionsOfInterest[i]);
-        warpedPlateRegions.push_back(pr);
+        SpeculativeRegion speculative_child;
+        speculative_child.region = pass->speculativeRegions[i].region.children[childidx];
+        speculative_child.path = pass->speculativeRegions[i].path;
+        speculative_child.path.push_back(childidx);
+        speculative_child.plateFound = false;
+
+        pass->speculativeRegions[i].children.push_back(pass->speculativeRegions.size());
+        pass->speculativeRegions.push_back(speculative_child);
       }
     }
+  }
 
-    queue<PlateRegion> plateQueue;
-    for (unsigned int i = 0; i < warpedPlateRegions.size(); i++)
-      plateQueue.push(warpedPlateRegions[i]);
+  // Collects the plate found in the region.  If there is none, collects the plates found in its children
+  void AlprImpl::getSpeculativeResults(AnalysisPass* pass, int region_idx, std::vector<PlateRegionResult>& results)
+  {
+    SpeculativeRegion* speculative_region = &pass->speculativeRegions[region_idx];
 
-    int platecount = 0;
-    while(!plateQueue.empty())
+    if (speculative_region->plateFound)
     {
-      PlateRegion plateRegion = plateQueue.front();
-      plateQueue.pop();
+      PlateRegionResult result;
+      result.path = speculative_region->path;
+      result.plate = speculative_region->plate;
+      results.push_back(result);
+      return;
+    }
+
+    for (unsigned int i = 0; i < speculative_region->children.size(); i++)
+      getSpeculativeResults(pass, speculative_region->children[i], results);
+  }
+
+  bool comparePlateRegionResults(const PlateRegionResult& left, const PlateRegionResult& right)
+  {
+    if (left.path.size() != right.path.size())
+      return left.path.size() < right.path.size();
+
+    return left.path < right.path;
+  }
 
-      PipelineData pipeline_data(colorImg, grayImg, plateRegion.rect, config);
-      pipeline_data.prewarp = prewarp;
+  // Combines the plates found in each plate region, in the order they would be found
+  // when processed one at a time
+  AlprFullDetails AlprImpl::getPassResults(AnalysisPass* pass)
+  {
+    AlprFullDetails response;
 
-      timespec platestarttime;
-      getTimeMonotonic(&platestarttime);
+    std::vector<PlateRegionResult> all_results;
+    for (unsigned int i = 0; i < pass->regionResults.size(); i++)
+      all_results.insert(all_results.end(), pass->regionResults[i].begin(), pass->regionResults[i].end());
 
-      LicensePlateCandidate lp(&pipeline_data);
+    std::sort(all_results.begin(), all_results.end(), comparePlateRegionResults);
 
-      lp.recognize();
+    // Count the time spent on every region that was analyzed, not just the plates that were kept
+    response.results.stage_timing = pass->stageTiming;
+    for (unsigned int i = 0; i < pass->regionStageTiming.size(); i++)
+      addStageTiming(response.results.stage_timing, pass->regionStageTiming[i]);
+    for (unsigned int i = 0; i < pass->speculativeRegions.size(); i++)
+      addStageTiming(response.results.stage_timing, pass->speculativeRegions[i].plate.stage_timing);
 
-      bool plateDetected = false;
-      if (pipeline_data.disqualified && config->debugGeneral)
-      {
-        cout << "Disqualify reason: " << pipeline_data.disqualify_reason << endl;
-      }
-      if (!pipeline_data.disqualified)
-      {
-        AlprPlateResult plateResult;
-        
-        plateResult.country = config->country;
-        
-        // If there's only one pattern for a country, use it.  Otherwise use the default
-        if (country_recognizers.ocr->postProcessor.getPatterns().size() == 1)
-          plateResult.region = country_recognizers.ocr->postProcessor.getPatterns()[0];
-        else
-          plateResult.region = defaultRegion;
-        
-        plateResult.regionConfidence = 0;
-        plateResult.plate_index = platecount++;
-        plateResult.requested_topn = topN;
+    for (unsigned int i = 0; i < all_results.size(); i++)
+    {
+      all_results[i].plate.plate_index = i;
+      response.results.plates.push_back(all_results[i].plate);
+    }
 
-        // If using prewarp, remap the plate corners to the original image
-        vector<Point2f> cornerPoints = pipeline_data.plate_corners;
-        cornerPoints = prewarp->projectPoints(cornerPoints, true);
+    // Unwarp plate regions if necessary
+    PreWarp::projectPlateRegions(pass->warpedPlateRegions, pass->frame->warpTransform, pass->grayImg.cols, pass->grayImg.rows, true);
+    response.plateRegions = pass->warpedPlateRegions;
 
-        for (int pointidx = 0; pointidx < 4; pointidx++)
-        {
-          plateResult.plate_points[pointidx].x = (int) cornerPoints[pointidx].x;
-          plateResult.plate_points[pointidx].y = (int) cornerPoints[pointidx].y;
-        }
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    response.results.total_processing_time_ms = diffclock(pass->startTime, endTime);
 
-        
-        #ifndef SKIP_STATE_DETECTION
-        if (detectRegion && country_recognizers.stateDetector->isLoaded())
-        {
-          std::vector<StateCandidate> state_candidates = country_recognizers.stateDetector->detect(pipeline_data.color_deskewed.data,
-                                                                               pipeline_data.color_deskewed.elemSize(),
-                                                                               pipeline_data.color_deskewed.cols,
-                                                                               pipeline_data.color_deskewed.rows);
+    return response;
+  }
 
-          if (state_candidates.size() > 0)
-          {
-            plateResult.region = state_candidates[0].state_code;
-            plateResult.regionConfidence = (int) state_candidates[0].confidence;
-          }
-        }
-        #endif
+  void AlprImpl::prepareFrameTask(void* arg)
+  {
+    std::pair<AlprImpl*, AnalysisFrame*>* task_arg = (std::pair<AlprImpl*, AnalysisFrame*>*) arg;
+    AnalysisFrame* frame = task_arg->second;
 
-        if (plateResult.region.length() > 0 && country_recognizers.ocr->postProcessor.regionIsValid(plateResult.region) == false)
-        {
-          std::cerr << "Invalid pattern provided: " << plateResult.region << std::endl;
-          std::cerr << "Valid patterns are located in the " << config->country << ".patterns file" << std::endl;
-        }
+    try
+    {
+      task_arg->first->prepareFrame(frame);
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR recognize: " << e.msg << std::endl;
+      delete frame->context;
+      frame->context = NULL;
+    }
+    catch (std::exception& e)
+    {
+      frame->error.record(e);
+      delete frame->context;
+      frame->context = NULL;
+    }
+  }
 
-        country_recognizers.ocr->performOCR(&pipeline_data);
-        country_recognizers.ocr->postProcessor.analyze(plateResult.region, topN);
+  void AlprImpl::findPlateRegionsTask(void* arg)
+  {
+    std::pair<AlprImpl*, AnalysisPass*>* task_arg = (std::pair<AlprImpl*, AnalysisPass*>*) arg;
+    AnalysisPass* pass = task_arg->second;
 
-        timespec resultsStartTime;
-        getTimeMonotonic(&resultsStartTime);
+    try
+    {
+      task_arg->first->findPlateRegions(pass);
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR recognize: " << e.msg << std::endl;
+      pass->warpedPlateRegions.clear();
+    }
+    catch (std::exception& e)
+    {
+      pass->error.record(e);
+      pass->warpedPlateRegions.clear();
+    }
+  }
 
-        const vector<PPResult> ppResults = country_recognizers.ocr->postProcessor.getResults();
+  void AlprImpl::analyzePlateRegionTask(void* arg)
+  {
+    std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >* task_arg = (std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >*) arg;
+    AnalysisPass* pass = task_arg->second.first;
+    int region_idx = task_arg->second.second;
 
-        int bestPlateIndex = 0;
+    try
+    {
+      // Borrow an OCR instance for this region.  It holds the letters and Tesseract state for one plate at a time
+      ScopedOcr ocr(pass->recognizers->ocrPool);
 
-        cv::Mat charTransformMatrix = getCharacterTransformMatrix(&pipeline_data);
-        bool isBestPlateSelected = false;
-        for (unsigned int pp = 0; pp < ppResults.size(); pp++)
-        {
+      std::vector<int> path;
+      path.push_back(region_idx);
+      task_arg->first->analyzePlateRegion(pass, pass->warpedPlateRegions[region_idx], path, ocr.get(), pass->regionResults[region_idx], pass->regionStageTiming[region_idx]);
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR recognize: " << e.msg << std::endl;
+      pass->regionResults[region_idx].clear();
+    }
+    catch (std::exception& e)
+    {
+      pass->regionErrors[region_idx].record(e);
+      pass->regionResults[region_idx].clear();
+    }
+  }
 
-          // Set our "best plate" match to either the first entry, or the first entry with a postprocessor template match
-          if (isBestPlateSelected == false && ppResults[pp].matchesTemplate){
-            bestPlateIndex = plateResult.topNPlates.size();
-            isBestPlateSelected = true;
-          }
+  void AlprImpl::analyzeSpeculativeRegionTask(void* arg)
+  {
+    std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >* task_arg = (std::pair<AlprImpl*, std::pair<AnalysisPass*, int> >*) arg;
+    AnalysisPass* pass = task_arg->second.first;
+    SpeculativeRegion* speculative_region = &pass->speculativeRegions[task_arg->second.second];
 
-          AlprPlate aplate;
-          aplate.characters = ppResults[pp].letters;
-          aplate.overall_confidence = ppResults[pp].totalscore;
-          aplate.matches_template = ppResults[pp].matchesTemplate;
+    try
+    {
+      ScopedOcr ocr(pass->recognizers->ocrPool);
 
-          // Grab detailed results for each character
-          for (unsigned int c_idx = 0; c_idx < ppResults[pp].letter_details.size(); c_idx++)
-          {
-            AlprChar character_details;
-            Letter l = ppResults[pp].letter_details[c_idx];
-            
-            character_details.character = l.letter;
-            character_details.confidence = l.totalscore;
-            cv::Rect char_rect = pipeline_data.charRegionsFlat[l.charposition];
-            std::vector<AlprCoordinate> charpoints = getCharacterPoints(char_rect, charTransformMatrix );
-            for (int cpt = 0; cpt < 4; cpt++)
-              character_details.corners[cpt] = charpoints[cpt];
-            aplate.character_details.push_back(character_details);
-          }
-          plateResult.topNPlates.push_back(aplate);
-        }
+      speculative_region->plateFound = task_arg->first->analyzePlate(pass, speculative_region->region, ocr.get(), speculative_region->plate);
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR recognize: " << e.msg << std::endl;
+      speculative_region->plateFound = false;
+    }
+    catch (std::exception& e)
+    {
+      speculative_region->error.record(e);
+      speculative_region->plateFound = false;
+    }
+  }
 
-        if (plateResult.topNPlates.size() > bestPlateIndex)
-        {
-          AlprPlate bestPlate;
-          bestPlate.characters = plateResult.topNPlates[bestPlateIndex].characters;
-          bestPlate.matches_template = plateResult.topNPlates[bestPlateIndex].matches_template;
-          bestPlate.overall_confidence = plateResult.topNPlates[bestPlateIndex].overall_confidence;
-          bestPlate.character_details = plateResult.topNPlates[bestPlateIndex].character_details;
+  AlprFullDetails AlprImpl::analyzeSingleCountry(std::string country, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> warpedRegionsOfInterest)
+  {
+    AlprFullDetails response;
+    
+    std::map<std::string, AlprRecognizers>::iterator recognizer_it = recognizers.find(country);
+    if (recognizer_it == recognizers.end())
+    {
+      std::cerr << "Country has not been loaded: " << country << std::endl;
+      return response;
+    }
 
-          plateResult.bestPlate = bestPlate;
-        }
+    // The gray image has already been warped
+    FrameContext context(config, NULL, colorImg, grayImg);
 
-        timespec plateEndTime;
-        getTimeMonotonic(&plateEndTime);
-        plateResult.processing_time_ms = diffclock(platestarttime, plateEndTime);
-        if (config->debugTiming)
-        {
-          cout << "Result Generation Time: " << diffclock(resultsStartTime, plateEndTime) << "ms." << endl;
-        }
+    AnalysisFrame frame;
+    frame.img = colorImg;
+    frame.detailLevel = ALPR_DETAIL_FULL;
+    frame.context = &context;
+    frame.warpedRegionsOfInterest = warpedRegionsOfInterest;
+    frame.warpTransform = prewarp->getImageTransform(grayImg.size());
 
-        if (plateResult.topNPlates.size() > 0)
-        {
-          plateDetected = true;
-          response.results.plates.push_back(plateResult);
-        }
-      }
+    AnalysisPass pass;
+    pass.frame = &frame;
+    pass.recognizers = &recognizer_it->second;
+    pass.iteration = 0;
+    pass.analyzed = true;
+
+    // Reads the country config like any other recognition
+    beginRecognition();
+    try
+    {
+      findPlateRegions(&pass);
 
-      if (!plateDetected)
+      ScopedOcr ocr(pass.recognizers->ocrPool);
+      pass.regionResults.resize(pass.warpedPlateRegions.size());
+      pass.regionStageTiming.resize(pass.warpedPlateRegions.size());
+      for (unsigned int i = 0; i < pass.warpedPlateRegions.size(); i++)
       {
-        // Not a valid plate
-        // Check if this plate has any children, if so, send them back up for processing
-        for (unsigned int childidx = 0; childidx < plateRegion.children.size(); childidx++)
-        {
-          plateQueue.push(plateRegion.children[childidx]);
-        }
+        std::vector<int> path;
+        path.push_back(i);
+        analyzePlateRegion(&pass, pass.warpedPlateRegions[i], path, ocr.get(), pass.regionResults[i], pass.regionStageTiming[i]);
       }
 
+      response = getPassResults(&pass);
     }
-
-    // Unwarp plate regions if necessary
-    prewarp->projectPlateRegions(warpedPlateRegions, grayImg.cols, grayImg.rows, true);
-    response.plateRegions = warpedPlateRegions;
-
-    timespec endTime;
-    getTimeMonotonic(&endTime);
-    response.results.total_processing_time_ms = diffclock(startTime, endTime);
+    catch (std::exception& e)
+    {
+      endRecognition();
+      throw;
+    }
+    endRecognition();
 
     return response;
   }
@@ -502,9 +1418,13 @@ namespace alpr
     cJSON_AddStringToObject(root,"data_type",	"alpr_results"	  );
 
     cJSON_AddNumberToObject(root,"epoch_time",	results.epoch_time	  );
+    // Only set for frames passed to recognizeAsync() or recognizeVideoFrame()
+    if (results.frame_number >= 0)
+      cJSON_AddNumberToObject(root,"frame_number",	results.frame_number	  );
     cJSON_AddNumberToObject(root,"img_width",	results.img_width	  );
     cJSON_AddNumberToObject(root,"img_height",	results.img_height	  );
     cJSON_AddNumberToObject(root,"processing_time_ms", results.total_processing_time_ms );
+    cJSON_AddItemToObject(root, "stage_timing_ms", createStageTimingJson(results.stage_timing));
 
     // Add the regions of interest to the JSON
     cJSON *rois;
@@ -574,6 +1494,7 @@ namespace alpr
     cJSON_AddNumberToObject(root,"region_confidence",	result->regionConfidence);
 
     cJSON_AddNumberToObject(root,"processing_time_ms",	result->processing_time_ms);
+    cJSON_AddItemToObject(root, "stage_timing_ms", createStageTimingJson(result->stage_timing));
     cJSON_AddNumberToObject(root,"requested_topn",	result->requested_topn);
 
     cJSON_AddItemToObject(root, "coordinates", 		coords=cJSON_CreateArray());
@@ -610,9 +1531,13 @@ namespace alpr
 
     int version = cJSON_GetObjectItem(root, "version")->valueint;
     allResults.epoch_time = (int64_t) cJSON_GetObjectItem(root, "epoch_time")->valuedouble;
+    cJSON* frame_number = cJSON_GetObjectItem(root, "frame_number");
+    if (frame_number != NULL)
+      allResults.frame_number = (int64_t) frame_number->valuedouble;
     allResults.img_width = cJSON_GetObjectItem(root, "img_width")->valueint;
     allResults.img_height = cJSON_GetObjectItem(root, "img_height")->valueint;
     allResults.total_processing_time_ms = cJSON_GetObjectItem(root, "processing_time_ms")->valueint;
+    allResults.stage_timing = parseStageTimingJson(cJSON_GetObjectItem(root, "stage_timing_ms"));
 
 
     cJSON* rois = cJSON_GetObjectItem(root,"regions_of_interest");
@@ -639,6 +1564,7 @@ namespace alpr
 
       //plate.bestPlate = cJSON_GetObjectItem(item, "plate")->valuestring;
       plate.processing_time_ms = cJSON_GetObjectItem(item, "processing_time_ms")->valuedouble;
+      plate.stage_timing = parseStageTimingJson(cJSON_GetObjectItem(item, "stage_timing_ms"));
       plate.plate_index = cJSON_GetObjectItem(item, "plate_index")->valueint;
       plate.region = std::string(cJSON_GetObjectItem(item, "region")->valuestring);
       plate.regionConfidence = cJSON_GetObjectItem(item, "region_confidence")->valueint;
@@ -745,25 +1671,73 @@ namespace alpr
   void AlprImpl::loadRecognizers() {
     for (unsigned int i = 0; i < config->loaded_countries.size(); i++)
     {
-      config->setCountry(config->loaded_countries[i]);
+      std::string country = config->loaded_countries[i];
 
-      if (recognizers.find(config->country) == recognizers.end())
+      if (recognizers.find(country) == recognizers.end())
       {
         // Country training data has not already been loaded.  Load it.
         AlprRecognizers recognizer;
-        recognizer.plateDetector = createDetector(config, prewarp);
-        recognizer.ocr = createOcr(config);
+
+        // Each country gets its own copy of the config, so the shared config never needs
+        // to be switched between countries while recognizing
+        recognizer.config = new Config(*config);
+        recognizer.config->setCountry(country);
+
+        recognizer.plateDetector = createDetector(recognizer.config, prewarp);
+        recognizer.ocrPool = new OcrPool(recognizer.config);
 
         #ifndef SKIP_STATE_DETECTION
-        recognizer.stateDetector = new StateDetector(this->config->country, this->config->config_file_path, this->config->runtimeBaseDir);
+        recognizer.stateDetector = new StateDetector(country, this->config->config_file_path, this->config->runtimeBaseDir);
         #else
         recognizer.stateDetector = NULL;
         #endif
 
-        recognizers[config->country] = recognizer;
+        recognizers[country] = recognizer;
+      }
+
+    }
+  }
+
+  // Must be matched by endRecognition() once the country configs are no longer read
+  void AlprImpl::beginRecognition() {
+    tthread::lock_guard<tthread::mutex> guard(config_mutex);
+
+    // The Config objects are updated in place since the detectors and OCR hold pointers to them, so
+    // the recognitions still reading them have to finish first.  New recognitions wait here too
+    while (country_configs_stale && active_recognitions > 0)
+      recognitions_finished.wait(config_mutex);
+
+    if (country_configs_stale)
+    {
+      // Copy any changes made to the shared config (e.g., debug flags) into each country's copy
+      typedef std::map<std::string, AlprRecognizers>::iterator it_type;
+      for (it_type iterator = recognizers.begin(); iterator != recognizers.end(); iterator++)
+      {
+        *(iterator->second.config) = *config;
+        iterator->second.config->setCountry(iterator->first);
       }
 
+      country_configs_stale = false;
     }
+
+    active_recognitions++;
+  }
+
+  void AlprImpl::endRecognition() {
+    tthread::lock_guard<tthread::mutex> guard(config_mutex);
+
+    active_recognitions--;
+    if (active_recognitions == 0)
+      recognitions_finished.notify_all();
+  }
+
+  Config* AlprImpl::getConfig() {
+    return config;
+  }
+
+  void AlprImpl::applyConfig() {
+    tthread::lock_guard<tthread::mutex> guard(config_mutex);
+    country_configs_stale = true;
   }
 
   
@@ -780,31 +1754,42 @@ namespace alpr
     return transmtx;
   }
   
-  std::vector<AlprCoordinate> AlprImpl::getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx ) {
+  // Returns the four corners of each character box in the original image
+  std::vector<std::vector<AlprCoordinate> > AlprImpl::getCharacterPoints(std::vector<cv::Rect> char_rects, cv::Mat transmtx, cv::Mat warpTransform ) {
     
+    std::vector<std::vector<AlprCoordinate> > cornersvectors;
+    if (char_rects.size() == 0)
+      return cornersvectors;
 
     std::vector<Point2f> points;
-    points.push_back(Point2f(char_rect.x, char_rect.y));
-    points.push_back(Point2f(char_rect.x + char_rect.width, char_rect.y));
-    points.push_back(Point2f(char_rect.x + char_rect.width, char_rect.y + char_rect.height));
-    points.push_back(Point2f(char_rect.x, char_rect.y + char_rect.height));
+    for (unsigned int i = 0; i < char_rects.size(); i++)
+    {
+      cv::Rect char_rect = char_rects[i];
+      points.push_back(Point2f(char_rect.x, char_rect.y));
+      points.push_back(Point2f(char_rect.x + char_rect.width, char_rect.y));
+      points.push_back(Point2f(char_rect.x + char_rect.width, char_rect.y + char_rect.height));
+      points.push_back(Point2f(char_rect.x, char_rect.y + char_rect.height));
+    }
     
     cv::perspectiveTransform(points, points, transmtx);
     
     // If using prewarp, remap the points to the original image
-    points = prewarp->projectPoints(points, true);
+    points = PreWarp::projectPoints(points, warpTransform, true);
         
-    
-    std::vector<AlprCoordinate> cornersvector;
-    for (int i = 0; i < 4; i++)
+    for (unsigned int i = 0; i < char_rects.size(); i++)
     {
-      AlprCoordinate coord;
-      coord.x = round(points[i].x);
-      coord.y = round(points[i].y);
-      cornersvector.push_back(coord);
+      std::vector<AlprCoordinate> cornersvector;
+      for (int k = 0; k < 4; k++)
+      {
+        AlprCoordinate coord;
+        coord.x = round(points[i * 4 + k].x);
+        coord.y = round(points[i * 4 + k].y);
+        cornersvector.push_back(coord);
+      }
+      cornersvectors.push_back(cornersvector);
     }
     
-    return cornersvector;
+    return cornersvectors;
   }
 
 
@@ -38,12 +38,18 @@
 #include "../statedetection/state_detector.h"
 #include "ocr/ocr.h"
 #include "ocr/ocrfactory.h"
+#include "ocr/ocrpool.h"
 
 #include "constants.h"
 
 #include "cjson.h"
 
 #include "pipeline_data.h"
+#include "framecontext.h"
+#include "matpool.h"
+#include "modelregistry.h"
+#include "asyncrecognizer.h"
+#include "videopipeline.h"
 
 #include "prewarp.h"
 
@@ -51,6 +57,8 @@
    
 #include "support/platform.h"
 #include "support/utf8.h"
+#include "support/tinythread.h"
+#include "support/threadpool.h"
 
 #define DEFAULT_TOPN 25
 #define DEFAULT_DETECT_REGION false
@@ -62,15 +70,127 @@ namespace alpr
 
   struct AlprFullDetails
   {
+    AlprFullDetails() : passesAnalyzed(0) {}
+
     std::vector<PlateRegion> plateRegions;
     AlprResults results;
+
+    // The number of country/analysis_count passes run over the frame.  Fewer than all of them after an early exit
+    int passesAnalyzed;
   };
 
+  // Everything that is loaded for a single country.  These objects are shared by all threads
+  // calling recognize(), so they must not be modified while recognizing.
+  // Per-plate scratch state (PipelineData, the OCR letters and the Tesseract handle) 
+  // lives in a PipelineData on the stack or in an OCR instance borrowed from the pool.
   struct AlprRecognizers
   {
+    // Copy of the configuration with the country values applied
+    Config* config;
+
     Detector* plateDetector;
     StateDetector* stateDetector;
-    OCR* ocr;
+    OcrPool* ocrPool;
+  };
+
+  // A plate found while analyzing a plate region or one of its children.  The path holds the index
+  // of the region at each level of the tree.  Sorting by path length and then by path gives the
+  // same breadth-first order that the regions are visited in when processed one at a time.
+  struct PlateRegionResult
+  {
+    std::vector<int> path;
+    AlprPlateResult plate;
+  };
+
+  // A plate region that is analyzed speculatively, before it is known whether its parent region 
+  // contains a plate.  The result is only used if none of its parents contain a plate
+  struct SpeculativeRegion
+  {
+    PlateRegion region;
+    std::vector<int> path;
+
+    // Indexes of the child regions in AnalysisPass::speculativeRegions
+    std::vector<int> children;
+
+    bool plateFound;
+    AlprPlateResult plate;
+
+    TaskError error;
+  };
+
+  // A frame waiting to be analyzed.  Encoded images are decoded when the frame is prepared.
+  struct AnalysisFrame
+  {
+    cv::Mat img;
+    // Set when the caller already has a grayscale image (e.g., the luma plane of a YUV frame)
+    cv::Mat inputGray;
+    std::vector<char> imageBytes;
+    std::vector<cv::Rect> regionsOfInterest;
+    AlprDetailLevel detailLevel;
+
+    int64_t start_time;
+    timespec startTime;
+
+    // The images derived from the frame, shared by all of its passes.  NULL if the image could not be used
+    FrameContext* context;
+    std::vector<cv::Rect> warpedRegionsOfInterest;
+
+    // The prewarp transform for this frame's size.  Points found in the warped image are projected back with it
+    cv::Mat warpTransform;
+
+    // Set if preparing the frame threw anything other than a cv::Exception
+    TaskError error;
+  };
+
+  // The analysis of one frame for one country on one analysis_count iteration
+  struct AnalysisPass
+  {
+    AnalysisFrame* frame;
+    AlprRecognizers* recognizers;
+    int iteration;
+
+    // False if the pass was skipped by early exit
+    bool analyzed;
+
+    // The frame with a slight change applied for each analysis_count iteration
+    FrameContext* context;
+    cv::Mat grayImg;
+
+    timespec startTime;
+
+    std::vector<PlateRegion> warpedPlateRegions;
+
+    // Plates found for each of the top-level plate regions
+    std::vector<std::vector<PlateRegionResult> > regionResults;
+
+    // Time spent finding plate regions, and analyzing each top-level region and its children
+    AlprStageTiming stageTiming;
+    std::vector<AlprStageTiming> regionStageTiming;
+
+    // Every plate region and child region, when analyzing speculatively.  The top-level regions come first
+    std::vector<SpeculativeRegion> speculativeRegions;
+
+    // Anything other than a cv::Exception thrown while finding the plate regions, and while analyzing each top-level region
+    TaskError error;
+    std::vector<TaskError> regionErrors;
+  };
+
+  // A set of frames and every pass over them
+  struct AnalysisBatch
+  {
+    std::vector<AnalysisFrame> frames;
+    std::vector<std::string> countries;
+
+    // Stored frame by frame, then country by country, so they can be aggregated in order
+    std::vector<AnalysisPass> passes;
+    std::vector<std::vector<int> > framePasses;
+
+    bool earlyExit;
+
+    // True from prepareBatch() until releaseBatchFrames(), while the batch reads the country configs
+    bool readingConfigs;
+
+    AnalysisBatch() : earlyExit(false), readingConfigs(false) {}
   };
 
   class AlprImpl
@@ -88,7 +208,18 @@ namespace alpr
       AlprResults recognize( cv::Mat img );
       AlprResults recognize( cv::Mat img, std::vector<cv::Rect> regionsOfInterest );
 
-      AlprFullDetails analyzeSingleCountry(cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> regionsOfInterest);
+      AlprResults recognize( AlprFrame frame );
+
+      std::vector<AlprResults> recognizeBatch( std::vector<AlprFrame> frames );
+      std::vector<AlprFullDetails> recognizeBatchFullDetails( std::vector<AlprFrame> frames );
+
+      bool recognizeAsync( AlprFrame frame, AlprAsyncCallback callback, void* user_data );
+      void waitForAsync();
+
+      bool recognizeVideoFrame( AlprFrame frame, AlprAsyncCallback callback, void* user_data );
+      void waitForVideoFrames();
+
+      AlprFullDetails analyzeSingleCountry(std::string country, cv::Mat colorImg, cv::Mat grayImg, std::vector<cv::Rect> regionsOfInterest);
 
       void setCountry(std::string country);
       void setPrewarp(std::string prewarp_config);
@@ -106,24 +237,96 @@ namespace alpr
 
       static cJSON* createJsonObj(const AlprPlateResult* result);
       
+      // Returns the shared configuration.  Call applyConfig() once the changes to it are done
+      Config* getConfig();
+
+      // Copies the changes made to the shared config into each loaded country.  The copy is made when the 
+      // next recognition starts, after every recognition that is already running has finished
+      void applyConfig();
+
       Config* config;
 
       bool isLoaded();
 
     private:
 
+      // Runs the analysis stages on its own threads
+      friend class VideoPipeline;
+
       std::map<std::string, AlprRecognizers> recognizers;
 
       PreWarp* prewarp;
 
+      // Set by applyConfig() and cleared when the country configs are refreshed.  active_recognitions counts the 
+      // recognitions that are reading the country configs, which are only refreshed when it is 0.  
+      // Both are only read or written with config_mutex held
+      bool country_configs_stale;
+      int active_recognitions;
+      tthread::mutex config_mutex;
+      tthread::condition_variable recognitions_finished;
+
+      tthread::mutex state_detector_mutex;
+
+      // Scratch image buffers for plate analysis, reused from plate to plate
+      MatPoolSet mat_pools;
+
+      // Worker threads used by recognizeBatch and the parallel_* options.  Created the first time they're needed
+      ThreadPool* threadPool;
+      tthread::mutex thread_pool_mutex;
+      ThreadPool* getThreadPool();
+
+      // Runs recognizeAsync() requests.  Created the first time it's needed
+      AsyncRecognizer* asyncRecognizer;
+      tthread::mutex async_mutex;
+
+      // Runs recognizeVideoFrame() requests.  Created the first time it's needed
+      VideoPipeline* videoPipeline;
+      tthread::mutex video_pipeline_mutex;
+
+      // Countries in the order they're tried when early exit is enabled.  Countries that found
+      // a plate recently move to the front
+      std::vector<std::string> country_order;
+      tthread::mutex country_order_mutex;
+      std::vector<std::string> getCountryOrder();
+      void updateCountryOrder(AlprFullDetails& response);
+
       int topN;
       bool detectRegion;
       std::string defaultRegion;
 
       void loadRecognizers();
+      void beginRecognition();
+      void endRecognition();
+
+      AnalysisFrame createAnalysisFrame(AlprFrame input);
+      static cv::Mat getPackedYuv(const AlprFrame& input, int stride);
+      AlprFullDetails recognizeFullDetails(AnalysisFrame& frame);
+      std::vector<AlprFullDetails> analyzeFrames(std::vector<AnalysisFrame>& frames, ThreadPool* framePool, ThreadPool* regionPool);
+      void runTasks(ThreadPool* threadPool, ThreadPoolTask task, std::vector<void*> args);
+      void prepareBatch(AnalysisBatch& batch, ThreadPool* framePool);
+      std::vector<AnalysisPass*> getBatchPasses(AnalysisBatch& batch);
+      void detectPlates(std::vector<AnalysisPass*> passes, ThreadPool* framePool);
+      void analyzePlateRegions(std::vector<AnalysisPass*> passes, ThreadPool* regionPool);
+      std::vector<AlprFullDetails> aggregateBatch(AnalysisBatch& batch);
+      void releaseBatchFrames(AnalysisBatch& batch);
+      bool isEarlyExitResult(AnalysisPass* pass);
+
+      void prepareFrame(AnalysisFrame* frame);
+      void findPlateRegions(AnalysisPass* pass);
+      void analyzePlateRegion(AnalysisPass* pass, PlateRegion plateRegion, std::vector<int> path, OCR* ocr, std::vector<PlateRegionResult>& results, AlprStageTiming& stage_timing);
+      bool analyzePlate(AnalysisPass* pass, PlateRegion plateRegion, OCR* ocr, AlprPlateResult& plateResult);
+      AlprFullDetails getPassResults(AnalysisPass* pass);
+
+      void addSpeculativeRegions(AnalysisPass* pass);
+      void getSpeculativeResults(AnalysisPass* pass, int region_idx, std::vector<PlateRegionResult>& results);
+
+      static void prepareFrameTask(void* arg);
+      static void findPlateRegionsTask(void* arg);
+      static void analyzePlateRegionTask(void* arg);
+      static void analyzeSpeculativeRegionTask(void* arg);
       
       cv::Mat getCharacterTransformMatrix(PipelineData* pipeline_data );
-      std::vector<AlprCoordinate> getCharacterPoints(cv::Rect char_rect, cv::Mat transmtx);
+      std::vector<std::vector<AlprCoordinate> > getCharacterPoints(std::vector<cv::Rect> char_rects, cv::Mat transmtx, cv::Mat warpTransform);
       std::vector<cv::Rect> convertRects(std::vector<AlprRegionOfInterest> regionsOfInterest);
 
   };
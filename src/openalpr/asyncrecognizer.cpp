@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "asyncrecognizer.h"
+#include "alpr_impl.h"
+
+namespace alpr
+{
+
+  AsyncRecognizer::AsyncRecognizer(AlprImpl* impl, int num_threads, int queue_size, int drop_policy)
+  {
+    this->impl = impl;
+    this->queue_size = queue_size > 0 ? queue_size : 1;
+    this->drop_policy = drop_policy;
+
+    next_frame_number = 0;
+    running_jobs = 0;
+    stopping = false;
+
+    if (num_threads <= 0)
+      num_threads = (int) tthread::thread::hardware_concurrency();
+    if (num_threads <= 0)
+      num_threads = 1;
+
+    for (int i = 0; i < num_threads; i++)
+      threads.push_back(new tthread::thread(AsyncRecognizer::recognitionThread, (void*) this));
+  }
+
+  AsyncRecognizer::~AsyncRecognizer()
+  {
+    std::deque<AsyncJob> dropped_jobs;
+
+    jobs_mutex.lock();
+    stopping = true;
+    dropped_jobs.swap(jobs);
+    job_available.notify_all();
+    job_taken.notify_all();
+    job_finished.notify_all();
+    jobs_mutex.unlock();
+
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+      threads[i]->join();
+      delete threads[i];
+    }
+
+    for (unsigned int i = 0; i < dropped_jobs.size(); i++)
+      dropJob(dropped_jobs[i]);
+  }
+
+  bool AsyncRecognizer::submit(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    AsyncJob job(frame);
+    job.callback = callback;
+    job.user_data = user_data;
+
+    std::vector<AsyncJob> dropped_jobs;
+
+    {
+      tthread::lock_guard<tthread::mutex> guard(jobs_mutex);
+
+      if (drop_policy == ASYNC_BLOCK && !isRecognitionThread())
+      {
+        while ((int) jobs.size() >= queue_size && !stopping)
+          job_taken.wait(jobs_mutex);
+      }
+      else if (drop_policy == ASYNC_DROP_OLDEST)
+      {
+        while ((int) jobs.size() >= queue_size)
+        {
+          dropped_jobs.push_back(jobs.front());
+          jobs.pop_front();
+        }
+      }
+
+      if (stopping || (int) jobs.size() >= queue_size)
+        return false;
+
+      job.frame_number = next_frame_number++;
+      jobs.push_back(job);
+      job_available.notify_one();
+    }
+
+    // The callbacks are run outside of the lock, since they may submit more frames
+    for (unsigned int i = 0; i < dropped_jobs.size(); i++)
+      dropJob(dropped_jobs[i]);
+
+    return true;
+  }
+
+  // True when called from a callback.  The thread list doesn't change after the constructor
+  bool AsyncRecognizer::isRecognitionThread()
+  {
+    tthread::thread::id current = tthread::this_thread::get_id();
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+      if (threads[i]->get_id() == current)
+        return true;
+    }
+
+    return false;
+  }
+
+  void AsyncRecognizer::waitForIdle()
+  {
+    tthread::lock_guard<tthread::mutex> guard(jobs_mutex);
+
+    while (jobs.size() > 0 || running_jobs > 0)
+      job_finished.wait(jobs_mutex);
+  }
+
+  void AsyncRecognizer::dropJob(AsyncJob& job)
+  {
+    AlprResults results;
+    results.frame_number = job.frame_number;
+    results.epoch_time = 0;
+    results.img_width = 0;
+    results.img_height = 0;
+    results.total_processing_time_ms = 0;
+
+    job.callback(results, false, job.user_data);
+  }
+
+  void AsyncRecognizer::recognitionThread(void* arg)
+  {
+    AsyncRecognizer* recognizer = (AsyncRecognizer*) arg;
+
+    recognizer->jobs_mutex.lock();
+    while (true)
+    {
+      if (recognizer->jobs.empty())
+      {
+        if (recognizer->stopping)
+          break;
+
+        recognizer->job_available.wait(recognizer->jobs_mutex);
+        continue;
+      }
+
+      AsyncJob job = recognizer->jobs.front();
+      recognizer->jobs.pop_front();
+      recognizer->running_jobs++;
+      recognizer->job_taken.notify_one();
+      recognizer->jobs_mutex.unlock();
+
+      // Nothing above this thread can catch an exception, so a frame that can't be recognized 
+      // (e.g., out of memory) is returned as not processed
+      AlprResults results;
+      bool processed = true;
+      try
+      {
+        results = recognizer->impl->recognize(job.frame);
+      }
+      catch (std::exception& e)
+      {
+        std::cerr << "Caught exception in OpenALPR async recognition: " << e.what() << std::endl;
+        processed = false;
+      }
+
+      if (processed)
+      {
+        results.frame_number = job.frame_number;
+        job.callback(results, true, job.user_data);
+      }
+      else
+      {
+        dropJob(job);
+      }
+
+      recognizer->jobs_mutex.lock();
+      recognizer->running_jobs--;
+      recognizer->job_finished.notify_all();
+    }
+    recognizer->jobs_mutex.unlock();
+  }
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_ASYNCRECOGNIZER_H
+#define OPENALPR_ASYNCRECOGNIZER_H
+
+#include <deque>
+#include <vector>
+
+#include "alpr.h"
+#include "config.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  class AlprImpl;
+
+  struct AsyncJob
+  {
+    AlprFrame frame;
+    AlprAsyncCallback callback;
+    void* user_data;
+    int64_t frame_number;
+
+    AsyncJob(AlprFrame frame) : frame(frame) {}
+  };
+
+  // Runs Alpr::recognizeAsync() requests on a set of recognition threads.
+  // Frames wait in a queue of at most queue_size entries.  When it is full, the drop policy
+  // decides what happens to a newly submitted frame.
+  class AsyncRecognizer
+  {
+    public:
+      AsyncRecognizer(AlprImpl* impl, int num_threads, int queue_size, int drop_policy);
+
+      // Frames still waiting in the queue are dropped.  Frames being recognized are finished first
+      virtual ~AsyncRecognizer();
+
+      // Returns false if the frame was rejected because the queue is full.  A callback that submits a frame 
+      // never waits for space, since it would be holding up one of the threads that make space
+      bool submit(AlprFrame frame, AlprAsyncCallback callback, void* user_data);
+
+      // Blocks until the queue is empty and no frames are being recognized.  Must not be called from a callback
+      void waitForIdle();
+
+    private:
+      AlprImpl* impl;
+      int queue_size;
+      int drop_policy;
+
+      std::vector<tthread::thread*> threads;
+      std::deque<AsyncJob> jobs;
+      int64_t next_frame_number;
+      int running_jobs;
+      bool stopping;
+
+      tthread::mutex jobs_mutex;
+      tthread::condition_variable job_available;
+      tthread::condition_variable job_taken;
+      tthread::condition_variable job_finished;
+
+      bool isRecognitionThread();
+
+      static void dropJob(AsyncJob& job);
+      static void recognitionThread(void* arg);
+  };
+
+}
+
+#endif // OPENALPR_ASYNCRECOGNIZER_H
@@ -97,7 +97,7 @@ namespace alpr
    **********************************************************/
 
 void NiblackSauvolaWolfJolion (Mat im, Mat output, NiblackVersion version,
-	int winx, int winy, double k, double dR) {
+	int winx, int winy, double k, double dR, MatPool* mat_pool) {
 
 	
 	double m, s, max_s;
@@ -112,14 +112,23 @@ void NiblackSauvolaWolfJolion (Mat im, Mat output, NiblackVersion version,
 	int mx, my;
 
 	// Create local statistics and store them in a double matrices
-	Mat map_m = Mat::zeros (im.rows, im.cols, CV_32F);
-	Mat map_s = Mat::zeros (im.rows, im.cols, CV_32F);
+	Mat map_m, map_s, thsurf;
+	if (mat_pool != NULL)
+	{
+		map_m = mat_pool->zeros (im.size(), CV_32F);
+		map_s = mat_pool->zeros (im.size(), CV_32F);
+		thsurf = mat_pool->get (im.size(), CV_32F);
+	}
+	else
+	{
+		map_m = Mat::zeros (im.rows, im.cols, CV_32F);
+		map_s = Mat::zeros (im.rows, im.cols, CV_32F);
+		thsurf = Mat (im.rows, im.cols, CV_32F);
+	}
 	max_s = calcLocalStats (im, map_m, map_s, winx, winy);
 	
 	minMaxLoc(im, &min_I, &max_I);
 			
-	Mat thsurf (im.rows, im.cols, CV_32F);
-			
 	// Create the threshold surface, including border processing
 	// ----------------------------------------------------
 
@@ -23,6 +23,7 @@
 #include "support/filesystem.h"
 
 #include "opencv2/opencv.hpp"
+#include "matpool.h"
 
 namespace alpr
 {
@@ -42,8 +43,9 @@ namespace alpr
   #define fget(x,y)    at<float>(y,x)
   #define fset(x,y,v)  at<float>(y,x)=v;
 
+  // The scratch images are taken from mat_pool if one is given
   void NiblackSauvolaWolfJolion (cv::Mat im, cv::Mat output, NiblackVersion version,
-                                 int winx, int winy, double k, double dR=BINARIZEWOLF_DEFAULTDR);
+                                 int winx, int winy, double k, double dR=BINARIZEWOLF_DEFAULTDR, MatPool* mat_pool=NULL);
 
 }
 
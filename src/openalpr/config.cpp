@@ -196,6 +196,10 @@ namespace alpr
     maxDetectionInputWidth = getInt(ini, defaultIni, "", "max_detection_input_width", 1280);
     maxDetectionInputHeight = getInt(ini, defaultIni, "", "max_detection_input_height", 768);
 
+    detectionTiling = getBoolean(ini, defaultIni, "", "detection_tiling", false);
+    detectionTileMaxPlateWidthPx = getInt(ini, defaultIni, "", "detection_tile_max_plate_width_px", 250);
+    detectionTileMaxPlateHeightPx = getInt(ini, defaultIni, "", "detection_tile_max_plate_height_px", 125);
+
     contrastDetectionThreshold = getFloat(ini, defaultIni, "", "contrast_detection_threshold", 0.3);
     
     mustMatchPattern = getBoolean(ini, defaultIni, "", "must_match_pattern", false);
@@ -205,6 +209,42 @@ namespace alpr
     detection_mask_image = getString(ini, defaultIni, "", "detection_mask_image", "");
     
     analysis_count = getInt(ini, defaultIni, "", "analysis_count", 1);
+
+    workerThreads = getInt(ini, defaultIni, "", "worker_threads", 0);
+    parallelPlateRegions = getBoolean(ini, defaultIni, "", "parallel_plate_regions", false);
+    parallelAnalysisPasses = getBoolean(ini, defaultIni, "", "parallel_analysis_passes", false);
+    parallelOcr = getBoolean(ini, defaultIni, "", "parallel_ocr", false);
+
+    earlyExitConfidence = getFloat(ini, defaultIni, "", "early_exit_confidence", 0);
+    earlyExitMustMatchPattern = getBoolean(ini, defaultIni, "", "early_exit_must_match_pattern", true);
+
+    asyncThreads = getInt(ini, defaultIni, "", "async_threads", 0);
+    asyncQueueSize = getInt(ini, defaultIni, "", "async_queue_size", 8);
+
+    std::string asyncDropString = getString(ini, defaultIni, "", "async_drop_policy", "block");
+    std::transform(asyncDropString.begin(), asyncDropString.end(), asyncDropString.begin(), ::tolower);
+
+    if (asyncDropString.compare("block") == 0)
+      asyncDropPolicy = ASYNC_BLOCK;
+    else if (asyncDropString.compare("drop_newest") == 0)
+      asyncDropPolicy = ASYNC_DROP_NEWEST;
+    else if (asyncDropString.compare("drop_oldest") == 0)
+      asyncDropPolicy = ASYNC_DROP_OLDEST;
+    else
+    {
+      std::cerr << "Invalid async_drop_policy specified: " << asyncDropString << ".  Using default" << std::endl;
+      asyncDropPolicy = ASYNC_BLOCK;
+    }
+
+    videoPipelineQueueSize = getInt(ini, defaultIni, "", "video_pipeline_queue_size", 2);
+
+    trackerFullScanInterval = getInt(ini, defaultIni, "", "tracker_full_scan_interval", 10);
+    trackerRoiExpansion = getFloat(ini, defaultIni, "", "tracker_roi_expansion", 1.0);
+    trackerMaxMissedFrames = getInt(ini, defaultIni, "", "tracker_max_missed_frames", 5);
+
+    motionMaxWidth = getInt(ini, defaultIni, "", "motion_max_width", 320);
+    motionMinAreaPx = getInt(ini, defaultIni, "", "motion_min_area_px", 1000);
+    motionMergeDistancePx = getInt(ini, defaultIni, "", "motion_merge_distance_px", 32);
     
     prewarp = getString(ini, defaultIni, "", "prewarp", "");
             
@@ -215,6 +255,23 @@ namespace alpr
     stateIdImagePercent = getFloat(ini, defaultIni, "", "state_id_img_size_percent", 100);
 
     ocrMinFontSize = getInt(ini, defaultIni, "", "ocr_min_font_point", 100);
+    ocrStripMode = getBoolean(ini, defaultIni, "", "ocr_strip_mode", false);
+    ocrGlyphCacheSize = getInt(ini, defaultIni, "", "ocr_glyph_cache_size", 0);
+    ocrThresholdEarlyExitMargin = getFloat(ini, defaultIni, "", "ocr_threshold_early_exit_margin", 0);
+
+    std::string ocrEngineString = getString(ini, defaultIni, "", "ocr_engine", "tesseract");
+    std::transform(ocrEngineString.begin(), ocrEngineString.end(), ocrEngineString.begin(), ::tolower);
+
+    if (ocrEngineString.compare("tesseract") == 0)
+      ocrEngine = OCR_TESSERACT;
+    else if (ocrEngineString.compare("classifier") == 0)
+      ocrEngine = OCR_CLASSIFIER;
+    else
+    {
+      std::cerr << "Invalid OCR engine specified: " << ocrEngineString << ".  Using default" << std::endl;
+      ocrEngine = OCR_TESSERACT;
+    }
+    ocrClassifierModel = getString(ini, defaultIni, "", "ocr_classifier_model", "");
 
     postProcessMinConfidence = getFloat(ini, defaultIni, "", "postprocess_min_confidence", 100);
     postProcessConfidenceSkipLevel = getFloat(ini, defaultIni, "", "postprocess_confidence_skip_level", 100);
@@ -355,6 +412,13 @@ namespace alpr
   {
     return this->runtimeBaseDir + "/ocr/";
   }
+  string Config::getClassifierModelFile()
+  {
+    if (this->ocrClassifierModel.length() > 0)
+      return this->ocrClassifierModel;
+
+    return this->runtimeBaseDir + "/ocr/" + this->ocrLanguage + ".charmodel";
+  }
 
 
   std::vector<std::string> Config::parse_country_string(std::string countries)
@@ -397,7 +461,15 @@ namespace alpr
 
     loadCountryValues(country_config_file, country);
 
-    if (fileExists((this->runtimeBaseDir + "/ocr/tessdata/" + this->ocrLanguage + ".traineddata").c_str()) == false)
+    if (ocrEngine == OCR_CLASSIFIER)
+    {
+      if (fileExists(getClassifierModelFile().c_str()) == false)
+      {
+        std::cerr << "--(!) Character classifier '" << getClassifierModelFile() << "' does not exist.  Missing OCR data for the country: '" << country<< "'!" << endl;
+        return false;
+      }
+    }
+    else if (fileExists((this->runtimeBaseDir + "/ocr/tessdata/" + this->ocrLanguage + ".traineddata").c_str()) == false)
     {
       std::cerr << "--(!) Runtime directory '" << this->runtimeBaseDir << "' is invalid.  Missing OCR data for the country: '" << country<< "'!" << endl;
       return false;
@@ -53,6 +53,10 @@ namespace alpr
       float maxPlateHeightPercent;
       int maxDetectionInputWidth;
       int maxDetectionInputHeight;
+
+      bool detectionTiling;
+      int detectionTileMaxPlateWidthPx;
+      int detectionTileMaxPlateHeightPx;
       
       float contrastDetectionThreshold;
       
@@ -61,6 +65,28 @@ namespace alpr
       std::string detection_mask_image;
 
       int analysis_count;
+
+      int workerThreads;
+      bool parallelPlateRegions;
+      bool parallelAnalysisPasses;
+      bool parallelOcr;
+
+      float earlyExitConfidence;
+      bool earlyExitMustMatchPattern;
+
+      int asyncThreads;
+      int asyncQueueSize;
+      int asyncDropPolicy;
+
+      int videoPipelineQueueSize;
+
+      int trackerFullScanInterval;
+      float trackerRoiExpansion;
+      int trackerMaxMissedFrames;
+
+      int motionMaxWidth;
+      int motionMinAreaPx;
+      int motionMergeDistancePx;
       
       bool auto_invert;
       bool always_invert;
@@ -113,6 +139,12 @@ namespace alpr
       
       std::string ocrLanguage;
       int ocrMinFontSize;
+      bool ocrStripMode;
+      int ocrGlyphCacheSize;
+      float ocrThresholdEarlyExitMargin;
+
+      int ocrEngine;
+      std::string ocrClassifierModel;
 
       bool mustMatchPattern;
       
@@ -145,6 +177,7 @@ namespace alpr
       std::string getCascadeRuntimeDir();
       std::string getPostProcessRuntimeDir();
       std::string getTessdataPrefix();
+      std::string getClassifierModelFile();
 
       std::string runtimeBaseDir;
 
@@ -174,5 +207,19 @@ namespace alpr
     DETECTOR_LBP_OPENCL=3
   };
 
+  enum OCR_ENGINE_TYPE
+  {
+    OCR_TESSERACT=0,
+    OCR_CLASSIFIER=1
+  };
+
+  // What recognizeAsync() does when its queue is full
+  enum ASYNC_DROP_POLICY
+  {
+    ASYNC_BLOCK=0,        // Wait for space in the queue
+    ASYNC_DROP_NEWEST=1,  // Reject the frame being submitted
+    ASYNC_DROP_OLDEST=2   // Drop the frame that has waited longest
+  };
+
 }
 #endif // OPENALPR_CONFIG_H
@@ -64,38 +64,41 @@ namespace alpr
 
   vector<PlateRegion> Detector::detect(Mat frame, std::vector<cv::Rect> regionsOfInterest)
   {
+    // The frame is used as given, without a prewarp
+    FrameContext frame_context(config, NULL, frame);
+    return this->detect(&frame_context, regionsOfInterest);
+  }
 
-    Mat frame_gray;
-    
-    if (frame.channels() > 2)
-    {
-      cvtColor( frame, frame_gray, CV_BGR2GRAY );
-    }
-    else
-    {
-      frame.copyTo(frame_gray);
-    }
+  vector<PlateRegion> Detector::detect(FrameContext* frame_context, std::vector<cv::Rect> regionsOfInterest, ThreadPool* tilePool)
+  {
 
-    // Apply the detection mask if it has been specified by the user
-    if (detector_mask.mask_loaded)
-      frame_gray = detector_mask.apply_mask(frame_gray);
+    Size frame_size = frame_context->getWarpedGray().size();
 
     // Setup debug mask image
     Mat mask_debug_img;
     if (detector_mask.mask_loaded && config->debugDetector)
     {
-      frame_gray.copyTo(mask_debug_img);
+      Mat frame_gray = frame_context->getMasked(&detector_mask);
       cvtColor(frame_gray, mask_debug_img, CV_GRAY2BGR);
     }
+
+    // Narrow each ROI to the areas of the detection mask (if it exists) that are scanned.  Each area is searched separately
+    vector<Rect> scanRegions;
+    for (unsigned int i = 0; i < regionsOfInterest.size(); i++)
+    {
+      if (detector_mask.mask_loaded)
+      {
+        vector<Rect> scan_areas = detector_mask.getScanAreas(regionsOfInterest[i], frame_size);
+        scanRegions.insert(scanRegions.end(), scan_areas.begin(), scan_areas.end());
+      }
+      else
+        scanRegions.push_back(regionsOfInterest[i]);
+    }
     
     vector<PlateRegion> detectedRegions;   
-    for (int i = 0; i < regionsOfInterest.size(); i++)
+    for (unsigned int i = 0; i < scanRegions.size(); i++)
     {
-      Rect roi = regionsOfInterest[i];
-      
-      // Adjust the ROI to be inside the detection mask (if it exists)
-      if (detector_mask.mask_loaded)
-        roi = detector_mask.getRoiInsideMask(roi);
+      Rect roi = scanRegions[i];
 
       // Draw ROIs on debug mask image
       if (detector_mask.mask_loaded && config->debugDetector)
@@ -107,39 +110,28 @@ namespace alpr
           (roi.height < config->minPlateSizeHeightPx))
         continue;
       
-      Mat cropped = frame_gray(roi);
-
-      int w = cropped.size().width;
-      int h = cropped.size().height;
-      int offset_x = roi.x;
-      int offset_y = roi.y;
-      float scale_factor = computeScaleFactor(w, h);
+      std::vector<DetectionTile> tiles = getTiles(frame_context, roi);
 
-      if (scale_factor != 1.0)
-        resize(cropped, cropped, Size(w * scale_factor, h * scale_factor));
+      std::vector<void*> tile_args;
+      for (unsigned int t = 0; t < tiles.size(); t++)
+        tile_args.push_back(&tiles[t]);
 
-    
-      float maxWidth = ((float) w) * (config->maxPlateWidthPercent / 100.0f) * scale_factor;
-      float maxHeight = ((float) h) * (config->maxPlateHeightPercent / 100.0f) * scale_factor;
-      Size minPlateSize(config->minPlateSizeWidthPx, config->minPlateSizeHeightPx);
-      Size maxPlateSize(maxWidth, maxHeight);
-    
-      vector<Rect> allRegions = find_plates(cropped, minPlateSize, maxPlateSize);
-      
-      // Aggregate the Rect regions into a hierarchical representation
-      for( unsigned int i = 0; i < allRegions.size(); i++ )
+      if (tilePool != NULL && tiles.size() > 1)
+        tilePool->runAll(findPlatesTask, tile_args);
+      else
       {
-        allRegions[i].x = (allRegions[i].x / scale_factor);
-        allRegions[i].y = (allRegions[i].y / scale_factor);
-        allRegions[i].width = allRegions[i].width / scale_factor;
-        allRegions[i].height = allRegions[i].height / scale_factor;
-
-        // Ensure that the rectangle isn't < 0 or > maxWidth/Height
-        allRegions[i] = expandRect(allRegions[i], 0, 0, w, h);
+        for (unsigned int t = 0; t < tile_args.size(); t++)
+          findPlatesTask(tile_args[t]);
+      }
 
-        allRegions[i].x = allRegions[i].x + offset_x;
-        allRegions[i].y = allRegions[i].y + offset_y;
+      for (unsigned int t = 0; t < tiles.size(); t++)
+      {
+        if (tiles[t].failed)
+          throw tiles[t].exception;
+        tiles[t].error.rethrow();
       }
+
+      vector<Rect> allRegions = mergeDuplicateRegions(tiles);
       
       // Check the rectangles and make sure that they're definitely not masked
       vector<Rect> regions_not_masked;
@@ -147,7 +139,7 @@ namespace alpr
       {
         if (detector_mask.mask_loaded)
         {
-          if (!detector_mask.region_is_masked(allRegions[i]))
+          if (!detector_mask.region_is_masked(allRegions[i], frame_size))
             regions_not_masked.push_back(allRegions[i]);
         }
         else
@@ -204,6 +196,177 @@ namespace alpr
     
   }
 
+  // Start offsets of tiles along a line of the given length.  Neighbouring tiles overlap by at least overlap pixels, 
+  // and the last tile ends at the end of the line
+  vector<int> getTileStarts(int length, int tile_size, int overlap)
+  {
+    vector<int> starts;
+    int step = std::max(tile_size - overlap, 1);
+    for (int start = 0; ; start += step)
+    {
+      if (start + tile_size >= length)
+      {
+        starts.push_back(std::max(length - tile_size, 0));
+        break;
+      }
+      starts.push_back(start);
+    }
+
+    return starts;
+  }
+
+  // Lists the images searched for plates in a region of interest.  Normally this is the whole region,
+  // downscaled to fit in max_detection_input_width/height.  With detection_tiling, a region that has to be 
+  // downscaled is also split into full-resolution tiles of that size, so that small plates are not lost.
+  // The tiles overlap by the largest plate they look for, so each of those plates is completely inside 
+  // at least one tile.  Larger plates are still found in the downscaled region.
+  vector<DetectionTile> Detector::getTiles(FrameContext* frame_context, Rect roi)
+  {
+    vector<DetectionTile> tiles;
+
+    int w = roi.width;
+    int h = roi.height;
+    float scale_factor = computeScaleFactor(w, h);
+
+    DetectionTile region_tile;
+    region_tile.detector = this;
+    region_tile.image = frame_context->getDetectionImage(&detector_mask, roi, Size(w * scale_factor, h * scale_factor));
+    region_tile.frame_rect = roi;
+    region_tile.scale_factor = scale_factor;
+    region_tile.failed = false;
+
+    float maxWidth = ((float) w) * (config->maxPlateWidthPercent / 100.0f);
+    float maxHeight = ((float) h) * (config->maxPlateHeightPercent / 100.0f);
+    region_tile.min_plate_size = Size(config->minPlateSizeWidthPx, config->minPlateSizeHeightPx);
+    region_tile.max_plate_size = Size(maxWidth * scale_factor, maxHeight * scale_factor);
+    tiles.push_back(region_tile);
+
+    if (!config->detectionTiling || scale_factor >= 1.0)
+      return tiles;
+
+    Size max_plate_size(std::min((int) maxWidth, config->detectionTileMaxPlateWidthPx),
+                        std::min((int) maxHeight, config->detectionTileMaxPlateHeightPx));
+    Size tile_size(std::max(config->maxDetectionInputWidth, max_plate_size.width * 2),
+                   std::max(config->maxDetectionInputHeight, max_plate_size.height * 2));
+
+    vector<int> tile_x = getTileStarts(w, tile_size.width, max_plate_size.width);
+    vector<int> tile_y = getTileStarts(h, tile_size.height, max_plate_size.height);
+
+    for (unsigned int y_idx = 0; y_idx < tile_y.size(); y_idx++)
+    {
+      for (unsigned int x_idx = 0; x_idx < tile_x.size(); x_idx++)
+      {
+        Rect tile_rect(roi.x + tile_x[x_idx], roi.y + tile_y[y_idx], 
+                       std::min(tile_size.width, w - tile_x[x_idx]), std::min(tile_size.height, h - tile_y[y_idx]));
+
+        if (tile_rect.width < config->minPlateSizeWidthPx || tile_rect.height < config->minPlateSizeHeightPx)
+          continue;
+
+        DetectionTile tile;
+        tile.detector = this;
+        tile.image = frame_context->getDetectionImage(&detector_mask, tile_rect, tile_rect.size());
+        tile.frame_rect = tile_rect;
+        tile.scale_factor = 1.0;
+        tile.min_plate_size = region_tile.min_plate_size;
+        tile.max_plate_size = max_plate_size;
+        tile.failed = false;
+        tiles.push_back(tile);
+      }
+    }
+
+    if (config->debugDetector)
+      cout << "Detecting plates in " << tiles.size() - 1 << " tiles" << endl;
+
+    return tiles;
+  }
+
+  void Detector::findPlatesTask(void* arg)
+  {
+    DetectionTile* tile = (DetectionTile*) arg;
+
+    try
+    {
+      vector<Rect> found = tile->detector->find_plates(tile->image, tile->min_plate_size, tile->max_plate_size);
+
+      for (unsigned int i = 0; i < found.size(); i++)
+      {
+        Rect region = found[i];
+        region.x = region.x / tile->scale_factor;
+        region.y = region.y / tile->scale_factor;
+        region.width = region.width / tile->scale_factor;
+        region.height = region.height / tile->scale_factor;
+
+        // Ensure that the rectangle isn't < 0 or > maxWidth/Height
+        region = expandRect(region, 0, 0, tile->frame_rect.width, tile->frame_rect.height);
+
+        region.x = region.x + tile->frame_rect.x;
+        region.y = region.y + tile->frame_rect.y;
+        tile->regions.push_back(region);
+      }
+    }
+    catch (cv::Exception& e)
+    {
+      tile->failed = true;
+      tile->exception = e;
+    }
+    catch (std::exception& e)
+    {
+      tile->error.record(e);
+    }
+  }
+
+  // A plate in the area covered by two tiles (or by a tile and the downscaled region) is found by both.
+  // Two regions from different tiles are the same plate if the parts of them inside that shared area mostly 
+  // overlap.  The larger one is kept, since the other may be cut off at the edge of its tile.
+  // Regions found in the same tile are all kept, so that nested hits become parent and child regions
+  vector<Rect> Detector::mergeDuplicateRegions(const vector<DetectionTile>& tiles)
+  {
+    const float MIN_DUPLICATE_OVERLAP = 0.5;
+
+    vector<Rect> merged;
+    vector<int> merged_tiles;
+    for (unsigned int t = 0; t < tiles.size(); t++)
+    {
+      for (unsigned int i = 0; i < tiles[t].regions.size(); i++)
+      {
+        Rect region = tiles[t].regions[i];
+
+        int duplicate_idx = -1;
+        for (unsigned int k = 0; k < merged.size(); k++)
+        {
+          if (merged_tiles[k] == t)
+            continue;
+
+          Rect shared_area = tiles[t].frame_rect & tiles[merged_tiles[k]].frame_rect;
+          Rect shared_region = region & shared_area;
+          Rect shared_merged = merged[k] & shared_area;
+
+          float intersection = (shared_region & shared_merged).area();
+          float union_area = shared_region.area() + shared_merged.area() - intersection;
+
+          if (union_area > 0 && intersection / union_area >= MIN_DUPLICATE_OVERLAP)
+          {
+            duplicate_idx = k;
+            break;
+          }
+        }
+
+        if (duplicate_idx < 0)
+        {
+          merged.push_back(region);
+          merged_tiles.push_back(t);
+        }
+        else if (region.area() > merged[duplicate_idx].area())
+        {
+          merged[duplicate_idx] = region;
+          merged_tiles[duplicate_idx] = t;
+        }
+      }
+    }
+
+    return merged;
+  }
+
   bool rectHasLargerArea(cv::Rect a, cv::Rect b) { return a.area() < b.area(); };
 
   vector<PlateRegion> Detector::aggregateRegions(vector<Rect> regions)
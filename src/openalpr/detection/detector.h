@@ -30,11 +30,35 @@
 #include "constants.h"
 #include "detectormask.h"
 #include "prewarp.h"
+#include "framecontext.h"
+#include "support/threadpool.h"
 
 namespace alpr
 {
 
+  class Detector;
 
+  // A piece of a region of interest that is searched for plates
+  struct DetectionTile
+  {
+    Detector* detector;
+
+    // The image searched, and the area of the frame it covers.  The image is smaller than the area when downscaled
+    cv::Mat image;
+    cv::Rect frame_rect;
+    float scale_factor;
+
+    cv::Size min_plate_size;
+    cv::Size max_plate_size;
+
+    // Found plates, in frame coordinates
+    std::vector<cv::Rect> regions;
+
+    // A cv::Exception, or anything else thrown on a pool thread, to be rethrown by detect()
+    bool failed;
+    cv::Exception exception;
+    TaskError error;
+  };
 
   class Detector
   {
@@ -47,6 +71,11 @@ namespace alpr
       std::vector<PlateRegion> detect(cv::Mat frame);
       std::vector<PlateRegion> detect(cv::Mat frame, std::vector<cv::Rect> regionsOfInterest);
 
+      // Detects plates in the frame context's warped grayscale image.  The masked and resized images
+      // are cached in the context and shared with other detectors.  With detection_tiling, the tiles 
+      // of large regions are searched on tilePool (or one at a time if it is NULL)
+      std::vector<PlateRegion> detect(FrameContext* frame_context, std::vector<cv::Rect> regionsOfInterest, ThreadPool* tilePool = NULL);
+
       virtual std::vector<cv::Rect> find_plates(cv::Mat frame, cv::Size min_plate_size, cv::Size max_plate_size)=0;
       
       void setMask(cv::Mat mask);
@@ -63,6 +92,11 @@ namespace alpr
       float computeScaleFactor(int width, int height);
       std::vector<PlateRegion> aggregateRegions(std::vector<cv::Rect> regions);
 
+      std::vector<DetectionTile> getTiles(FrameContext* frame_context, cv::Rect roi);
+      std::vector<cv::Rect> mergeDuplicateRegions(const std::vector<DetectionTile>& tiles);
+
+      static void findPlatesTask(void* arg);
+
 
 
   };
@@ -21,6 +21,8 @@
 
 #include <stdio.h>
 
+#include "support/filesystem.h"
+
 using namespace cv;
 using namespace std;
 
@@ -28,26 +30,107 @@ namespace alpr
 {
 
 
-  DetectorCPU::DetectorCPU(Config* config, PreWarp* prewarp) : Detector(config, prewarp) {
-
+  CascadePool::CascadePool(std::string detector_file) {
+    this->detector_file = detector_file;
+    this->copy_failed = false;
 
-    
-    if( this->plate_cascade.load( get_detector_file() ) )
+    cv::CascadeClassifier* plate_cascade = new cv::CascadeClassifier();
+    if( plate_cascade->load( detector_file ) )
     {
       this->loaded = true;
     }
     else
     {
       this->loaded = false;
-      printf("--(!)Error loading CPU classifier %s\n", get_detector_file().c_str());
+      printf("--(!)Error loading CPU classifier %s\n", detector_file.c_str());
     }
+
+    plate_cascades.push_back(plate_cascade);
+    available_cascades.push_back(plate_cascade);
   }
 
+  CascadePool::~CascadePool() {
+    for (unsigned int i = 0; i < plate_cascades.size(); i++)
+      delete plate_cascades[i];
+  }
 
-  DetectorCPU::~DetectorCPU() {
+  bool CascadePool::isLoaded() {
+    return loaded;
   }
 
+  cv::CascadeClassifier* CascadePool::acquire() {
+    bool load_copy;
+    {
+      tthread::lock_guard<tthread::mutex> guard(cascade_mutex);
+
+      if (available_cascades.size() > 0)
+      {
+        cv::CascadeClassifier* plate_cascade = available_cascades.back();
+        available_cascades.pop_back();
+        return plate_cascade;
+      }
+
+      load_copy = !copy_failed;
+    }
+
+    cv::CascadeClassifier* plate_cascade = NULL;
+    if (load_copy)
+    {
+      plate_cascade = new cv::CascadeClassifier();
+      if (!plate_cascade->load( detector_file ))
+      {
+        printf("--(!)Error loading another copy of CPU classifier %s\n", detector_file.c_str());
+        delete plate_cascade;
+        plate_cascade = NULL;
+      }
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(cascade_mutex);
 
+    if (plate_cascade != NULL)
+    {
+      plate_cascades.push_back(plate_cascade);
+      return plate_cascade;
+    }
+
+    // Stop loading copies after a failure and wait for one of the existing classifiers instead
+    copy_failed = true;
+    while (available_cascades.size() == 0)
+      cascade_released.wait(cascade_mutex);
+
+    plate_cascade = available_cascades.back();
+    available_cascades.pop_back();
+    return plate_cascade;
+  }
+
+  void CascadePool::release(cv::CascadeClassifier* cascade) {
+    tthread::lock_guard<tthread::mutex> guard(cascade_mutex);
+    available_cascades.push_back(cascade);
+    cascade_released.notify_one();
+  }
+
+  int CascadePool::loadedCopies() {
+    tthread::lock_guard<tthread::mutex> guard(cascade_mutex);
+    return plate_cascades.size();
+  }
+
+
+  DetectorCPU::DetectorCPU(Config* config, PreWarp* prewarp) : Detector(config, prewarp) {
+
+    std::string detector_file = get_detector_file();
+    std::string key = ModelRegistry::getKey("cascade", detector_file);
+
+    cascades = (CascadePool*) ModelRegistry::acquire(key);
+    if (cascades == NULL)
+      cascades = (CascadePool*) ModelRegistry::add(key, new CascadePool(detector_file), getFileInfo(detector_file).size);
+
+    this->loaded = cascades->isLoaded();
+  }
+
+
+  DetectorCPU::~DetectorCPU() {
+    ModelRegistry::release(cascades);
+  }
 
   
   vector<Rect> DetectorCPU::find_plates(Mat frame, cv::Size min_plate_size, cv::Size max_plate_size)
@@ -59,12 +142,24 @@ namespace alpr
     timespec startTime;
     getTimeMonotonic(&startTime);
 
-    equalizeHist( frame, frame );
+    // Equalize into a new image.  The frame may be a view of the caller's image
+    Mat equalized;
+    equalizeHist( frame, equalized );
     
-    plate_cascade.detectMultiScale( frame, plates, config->detection_iteration_increase, config->detectionStrictness,
-                                      CV_HAAR_DO_CANNY_PRUNING,
-                                      //0|CV_HAAR_SCALE_IMAGE,
-                                      min_plate_size, max_plate_size );
+    cv::CascadeClassifier* plate_cascade = cascades->acquire();
+    try
+    {
+      plate_cascade->detectMultiScale( equalized, plates, config->detection_iteration_increase, config->detectionStrictness,
+                                        CV_HAAR_DO_CANNY_PRUNING,
+                                        //0|CV_HAAR_SCALE_IMAGE,
+                                        min_plate_size, max_plate_size );
+    }
+    catch (cv::Exception& e)
+    {
+      cascades->release(plate_cascade);
+      throw;
+    }
+    cascades->release(plate_cascade);
 
 
     if (config->debugTiming)
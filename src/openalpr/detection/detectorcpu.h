@@ -28,10 +28,41 @@
 #include "opencv2/ml/ml.hpp"
 
 #include "detector.h"
+#include "modelregistry.h"
+#include "support/tinythread.h"
 
 namespace alpr
 {
 
+  // The classifiers loaded from one cascade file.  Shared through the ModelRegistry by every
+  // DetectorCPU in the process that uses the same file.
+  // CascadeClassifier keeps per-image scratch data while it scans, so each concurrent
+  // caller borrows its own classifier.  Extra classifiers are only loaded under contention;
+  // if one fails to load, callers wait for a classifier to be released instead.
+  class CascadePool : public SharedModel
+  {
+    public:
+      CascadePool(std::string detector_file);
+      virtual ~CascadePool();
+
+      bool isLoaded();
+
+      cv::CascadeClassifier* acquire();
+      void release(cv::CascadeClassifier* cascade);
+
+      int loadedCopies();
+
+    private:
+      std::string detector_file;
+      bool loaded;
+      bool copy_failed;
+
+      std::vector<cv::CascadeClassifier*> plate_cascades;
+      std::vector<cv::CascadeClassifier*> available_cascades;
+      tthread::mutex cascade_mutex;
+      tthread::condition_variable cascade_released;
+  };
+
   class DetectorCPU : public Detector {
   public:
       DetectorCPU(Config* config, PreWarp* prewarp);
@@ -41,7 +72,7 @@ namespace alpr
       
   private:
 
-      cv::CascadeClassifier plate_cascade;
+      CascadePool* cascades;
 
   };
 
@@ -67,6 +67,8 @@ namespace alpr
 #endif
     Mat plateregions_downloaded;
 
+    tthread::lock_guard<tthread::mutex> guard(cuda_mutex);
+
     cudaFrame.upload(frame);
 #if OPENCV_MAJOR_VERSION == 2
     int numdetected = cuda_cascade.detectMultiScale(cudaFrame, plateregions_buffer, 
@@ -57,6 +57,9 @@ namespace alpr
 #else
       cv::Ptr<cv::cuda::CascadeClassifier> cuda_cascade;
 #endif
+
+      // The GPU cascade holds its detection parameters and buffers internally
+      tthread::mutex cuda_mutex;
   };
 
 }
@@ -20,28 +20,34 @@
 #include "detectormask.h"
 #include "prewarp.h"
 
+#include <algorithm>
+#include <sstream>
+
 using namespace cv;
 using namespace std;
   
 namespace alpr
 {
+
+  bool rectIsAboveOrLeft(cv::Rect a, cv::Rect b) { return a.y < b.y || (a.y == b.y && a.x < b.x); }
   
 
   DetectorMask::DetectorMask(Config* config, PreWarp* prewarp) {
     mask_loaded = false;
-    resized_mask_loaded = false;
     this->config = config;
     this->prewarp = prewarp;
-    last_prewarp_hash = "";
   }
 
   DetectorMask::~DetectorMask() {
   }
 
   void DetectorMask::setMask(Mat orig_mask) {
+    tthread::lock_guard<tthread::mutex> guard(mask_mutex);
+
+    compiled_masks.clear();
+
     if (orig_mask.cols <= 0 || orig_mask.rows <= 0)
     {
-      resized_mask_loaded = false;
       mask_loaded = false;
       return;
     }
@@ -52,36 +58,68 @@ namespace alpr
     else
       this->mask = orig_mask;
     
-    resized_mask_loaded = false;
+    // Hash the mask pixels (FNV-1a) so that images masked by one detector can be reused by
+    // other detectors with the same mask
+    unsigned int hash = 2166136261u;
+    for (int y = 0; y < this->mask.rows; y++)
+    {
+      const unsigned char* row = this->mask.ptr<unsigned char>(y);
+      for (int x = 0; x < this->mask.cols; x++)
+        hash = (hash ^ row[x]) * 16777619u;
+    }
+    
+    std::stringstream key;
+    key << this->mask.cols << "x" << this->mask.rows << ":" << hash;
+    mask_key = key.str();
+    
     mask_loaded = true;
   }
   
+  std::string DetectorMask::cacheKey() {
+    tthread::lock_guard<tthread::mutex> guard(mask_mutex);
+    return mask_key;
+  }
+  
   cv::Size DetectorMask::mask_size() {
-    if (resized_mask_loaded)
-      return resized_mask.size();
+    tthread::lock_guard<tthread::mutex> guard(mask_mutex);
     return mask.size();
   }
 
-  // Provided a region of interest, truncate it if the mask cuts off a portion of it.
+  // Provided a region of interest, truncate it to the parts of the mask that are scanned.
   // No reason to analyze extra content
-  cv::Rect DetectorMask::getRoiInsideMask(cv::Rect roi) {
-      Rect roi_intersection = roi & scan_area;
-      return roi_intersection;  
+  vector<Rect> DetectorMask::getScanAreas(cv::Rect roi, cv::Size frame_size) {
+    CompiledMask compiled = getCompiledMask(frame_size);
+
+    vector<Rect> scan_areas;
+    for (unsigned int i = 0; i < compiled.scan_areas.size(); i++)
+    {
+      Rect roi_intersection = roi & compiled.scan_areas[i];
+      if (roi_intersection.area() > 0)
+        scan_areas.push_back(roi_intersection);
+    }
+
+    return scan_areas;
   }
 
   
   // Checks if the provided region is partially covered by the mask
   // If so, it is disqualified
-  bool DetectorMask::region_is_masked(cv::Rect region) {
+  bool DetectorMask::region_is_masked(cv::Rect region, cv::Size frame_size) {
     int MIN_WHITENESS = 248;
     
     // If the mean pixel value over the crop is very white (e.g., > 253 out of 255)
     // then this is in the white area of the mask and we'll use it
-    
+    CompiledMask compiled = getCompiledMask(frame_size);
+
     // Make sure the region doesn't extend beyond the bounds of our image
-    expandRect(region, 0, 0, resized_mask.cols, resized_mask.rows);
-    Mat mask_crop = resized_mask(region);
-    double mean_value = mean(mask_crop)[0];
+    region = region & Rect(0, 0, compiled.mask.cols, compiled.mask.rows);
+    if (region.area() <= 0)
+      return true;
+
+    int x1 = region.x, y1 = region.y, x2 = region.x + region.width, y2 = region.y + region.height;
+    int white_pixels = compiled.integral.at<int>(y2, x2) - compiled.integral.at<int>(y1, x2) 
+                     - compiled.integral.at<int>(y2, x1) + compiled.integral.at<int>(y1, x1);
+    double mean_value = 255.0 * white_pixels / region.area();
     
     if (config->debugDetector)
     {
@@ -90,77 +128,108 @@ namespace alpr
     return mean_value < MIN_WHITENESS;
   }
   
-  void DetectorMask::resize_mask(cv::Mat image) {
-    
-    resize(mask, resized_mask, image.size());
+  CompiledMask DetectorMask::getCompiledMask(cv::Size frame_size) {
+    const unsigned int MAX_COMPILED_MASKS = 8;
+
+    tthread::lock_guard<tthread::mutex> guard(mask_mutex);
+
+    std::stringstream key;
+    key << frame_size.width << "x" << frame_size.height << "|" << prewarp->toString();
+
+    std::map<std::string, CompiledMask>::iterator it = compiled_masks.find(key.str());
+    if (it != compiled_masks.end())
+      return it->second;
+
+    // Only a few frame sizes are expected.  Start over if there are more than that
+    if (compiled_masks.size() >= MAX_COMPILED_MASKS)
+      compiled_masks.clear();
+
+    CompiledMask compiled = compileMask(frame_size);
+    compiled_masks[key.str()] = compiled;
+    return compiled;
+  }
+
+  // Must be called with mask_mutex held
+  CompiledMask DetectorMask::compileMask(cv::Size frame_size) {
+    CompiledMask compiled;
+
+    resize(mask, compiled.mask, frame_size);
 
     if (prewarp->valid) 
     {
-      resized_mask = prewarp->warpImage(resized_mask);
+      compiled.mask = prewarp->warpImage(compiled.mask);
     }
 
     // Threshold the mask so that the values are either 0 or 255 (no shades of gray))
-    // This can happen with jpeg compression
-    threshold(this->mask, this->mask, 55, 255, cv::THRESH_BINARY);
+    // This can happen with jpeg compression and with the resize
+    threshold(compiled.mask, compiled.mask, 55, 255, cv::THRESH_BINARY);
+
+    Mat scanned_pixels;
+    threshold(compiled.mask, scanned_pixels, 0, 1, cv::THRESH_BINARY);
+    integral(scanned_pixels, compiled.integral, CV_32S);
      
-    // Calculate the biggest rectangle that covers all the whitespace
-    // Rather than using contours, go row by row, column by column until you hit
-    // a white pixel and stop.  Should be faster and a little simpler
-    int top_bound = 0, bottom_bound = 0, left_bound = 0, right_bound = 0;
-    
-    for (top_bound = 0; top_bound < resized_mask.rows; top_bound++)
-      if (countNonZero(resized_mask.row(top_bound)) > 0) break;
-    for (bottom_bound = resized_mask.rows - 1; bottom_bound >= 0; bottom_bound--)
-      if (countNonZero(resized_mask.row(bottom_bound)) > 0) break;
-    
-    for (left_bound = 0; left_bound < resized_mask.cols; left_bound++)
-      if (countNonZero(resized_mask.col(left_bound)) > 0) break;
-    for (right_bound = resized_mask.cols - 1; right_bound >= 0; right_bound--)
-      if (countNonZero(resized_mask.col(right_bound)) > 0) break;
-    
-    if (left_bound >= right_bound || top_bound >= bottom_bound)
-    {
-      // Invalid mask, set it to 0 width/height
-      scan_area.x = 0;
-      scan_area.y = 0;
-      scan_area.width = 0;
-      scan_area.height = 0;
-    }
-    else
+    // Each separate white area gets a rectangle of its own.  Areas too small to hold a plate are skipped
+    vector<vector<Point> > contours;
+    Mat contour_image = compiled.mask.clone();
+    findContours(contour_image, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+
+    vector<Rect> areas;
+    for (unsigned int i = 0; i < contours.size(); i++)
     {
-      scan_area.x = left_bound;
-      scan_area.y = top_bound;
-      scan_area.width = right_bound - left_bound;
-      scan_area.height = bottom_bound - top_bound;
+      Rect area = boundingRect(contours[i]);
+      if (area.width < config->minPlateSizeWidthPx || area.height < config->minPlateSizeHeightPx)
+        continue;
+
+      // Rectangles that overlap are combined, so that no pixel is scanned twice
+      bool merged = true;
+      while (merged)
+      {
+        merged = false;
+        for (unsigned int k = 0; k < areas.size(); k++)
+        {
+          if ((area & areas[k]).area() > 0)
+          {
+            area = area | areas[k];
+            areas.erase(areas.begin() + k);
+            merged = true;
+            break;
+          }
+        }
+      }
+      areas.push_back(area);
     }
-      
-    //cout << scan_area << endl;
+
+    // Scan top to bottom, left to right
+    std::sort(areas.begin(), areas.end(), rectIsAboveOrLeft);
+    compiled.scan_areas = areas;
+
+    if (config->debugDetector)
+      cout << "Detector mask has " << areas.size() << " scan areas" << endl;
+
+    return compiled;
   }
 
   Mat DetectorMask::apply_mask(Mat image) {
+    return apply_mask(image, Rect(0, 0, image.cols, image.rows), image.size());
+  }
+
+  Mat DetectorMask::apply_mask(Mat image, Rect region, Size frame_size) {
     if (!mask_loaded)
       return image;
-       
-    if (!resized_mask_loaded || image.size() != resized_mask.size() || 
-            last_prewarp_hash != prewarp->toString())
-    {
-      resize_mask(image);
-      
-      last_prewarp_hash = prewarp->toString();
-      
-      resized_mask_loaded = true;
-    }
+
+    CompiledMask compiled = getCompiledMask(frame_size);
     
-    if (image.size() != resized_mask.size() && config->debugDetector)
+    if (image.size() != region.size() && config->debugDetector)
     {
       cout << "Mask does not match image size" << endl;
       return image;
     }
     
-    Mat response = Mat::zeros(image.size(), image.type());
-    bitwise_and(image, resized_mask, response);
+    // bitwise_and writes every pixel, so the response doesn't need to be zeroed first
+    Mat response;
+    bitwise_and(image, compiled.mask(region), response);
     
     return response;
   }
 
-}
\ No newline at end of file
+}
@@ -20,14 +20,30 @@
 #ifndef OPENALPR_DETECTORMASK_H
 #define	OPENALPR_DETECTORMASK_H
 
+#include <map>
 #include <string>
+#include <vector>
 #include "opencv2/imgproc/imgproc.hpp"
 #include "config.h"
 #include "prewarp.h"
+#include "support/tinythread.h"
 
 namespace alpr
 {
 
+  // The mask resized and warped to fit frames of one size
+  struct CompiledMask
+  {
+    cv::Mat mask;
+
+    // Integral image of the scanned pixels (1 where the mask is white, 0 elsewhere), so the 
+    // masked share of any region can be found in constant time
+    cv::Mat integral;
+
+    // Disjoint rectangles that together cover every scanned pixel
+    std::vector<cv::Rect> scan_areas;
+  };
+
   class DetectorMask {
   public:
     
@@ -36,30 +52,41 @@ namespace alpr
 
     void setMask(cv::Mat mask);
     
-    cv::Rect getRoiInsideMask(cv::Rect roi);
+    // The parts of the region of interest that need to be scanned in a frame of the given size.  
+    // Separate areas of the mask (e.g., two lanes) are returned separately, so the gap between them is skipped
+    std::vector<cv::Rect> getScanAreas(cv::Rect roi, cv::Size frame_size);
     
     cv::Size mask_size();
     
-    bool region_is_masked(cv::Rect region);
+    bool region_is_masked(cv::Rect region, cv::Size frame_size);
     
     cv::Mat apply_mask(cv::Mat image);
+
+    // Masks image, which is the given region of a frame of frame_size
+    cv::Mat apply_mask(cv::Mat image, cv::Rect region, cv::Size frame_size);
+    
+    // Identifies the mask contents.  Detectors that were given the same mask have the same key
+    std::string cacheKey();
     
     bool mask_loaded;
     
   private:
 
-    void resize_mask(cv::Mat image);
+    CompiledMask getCompiledMask(cv::Size frame_size);
+    CompiledMask compileMask(cv::Size frame_size);
     
     PreWarp* prewarp;
-    std::string last_prewarp_hash;
     
     cv::Mat mask;
-    
-    cv::Mat resized_mask;
-    bool resized_mask_loaded;
+    std::string mask_key;
     
     Config* config;
-    cv::Rect scan_area;
+
+    // Compiled masks by frame size and prewarp.  Built the first time each pair is seen
+    std::map<std::string, CompiledMask> compiled_masks;
+
+    // Masks are compiled lazily, which can happen while other threads are checking regions against them
+    tthread::mutex mask_mutex;
    
   };
 
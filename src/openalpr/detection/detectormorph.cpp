@@ -50,9 +50,11 @@ namespace alpr {
   std::vector<cv::Rect> DetectorMorph::find_plates(cv::Mat frame_gray, cv::Size min_plate_size, cv::Size max_plate_size)
   {
 
-    Mat frame_gray_cp(frame_gray.size(), frame_gray.type());
-    frame_gray.copyTo(frame_gray_cp);
-    blur(frame_gray, frame_gray, Size(5, 5));
+    // Keep the unblurred frame for rotating the candidates.  The frame may be a view of 
+    // the caller's image, so blur into a new image rather than in place
+    Mat frame_gray_cp = frame_gray;
+    frame_gray = Mat();
+    blur(frame_gray_cp, frame_gray, Size(5, 5));
 
     vector<Rect> plates;
     
@@ -128,34 +130,40 @@ namespace alpr {
     }
 
    //Now prunning based on checking all candidate plates for a min/max number of blobsc
-    Mat img_crop, img_crop_b, img_crop_th, img_crop_th_inv;
+    Mat img_crop, img_crop_th, img_crop_th_inv;
     vector< vector< Point> > plateBlobs;
     vector< vector< Point> > plateBlobsInv;
     double thresholds[] = { 10, 40, 80, 120, 160, 200, 240 };
     const int num_thresholds = 7;
+    const int MIN_VALID_CHARS = 4;
+    const int MAX_VALID_CHARS = 50;
+    float idealAspect = config->avgCharWidthMM / config->avgCharHeightMM;
     int numValidChars = 0;
-    Mat rotated;
     for (int i = 0; i < rects.size(); i++) {
       numValidChars = 0;
       RotatedRect PlateRect = rects[i];
-      Size rect_size = PlateRect.size;
+      // Rounded, the same as the size getRectSubPix used to be given
+      Size crop_size(PlateRect.size);
 
-      // get the rotation matrix
+      // Rotate the candidate upright and crop it in one step.  Only the pixels of the crop are computed,
+      // rather than rotating the whole frame.  The offset puts the candidate's center at the center of the crop
       Mat M = getRotationMatrix2D(PlateRect.center, PlateRect.angle, 1.0);
-      // perform the affine transformation
-      warpAffine(frame_gray_cp, rotated, M, frame_gray_cp.size(), INTER_CUBIC);
-      //Crop area around candidate plate
-      getRectSubPix(rotated, rect_size, PlateRect.center, img_crop);
+      M.at<double>(0, 2) -= PlateRect.center.x - (crop_size.width - 1) * 0.5;
+      M.at<double>(1, 2) -= PlateRect.center.y - (crop_size.height - 1) * 0.5;
+      // Pixels outside of the frame repeat the edge pixels, as getRectSubPix did.  A black fill would turn into 
+      // white blobs once the crop is thresholded and inverted
+      warpAffine(frame_gray_cp, img_crop, M, crop_size, INTER_CUBIC, BORDER_REPLICATE);
 
        if (config->debugDetector && config->debugShowImages) {
               imshow("Tilt Correction", img_crop);
               waitKey(0);
       }
 
-      for (int z = 0; z < num_thresholds; z++) {
+      // The count only goes up, so stop as soon as there are too many blobs for a plate
+      for (int z = 0; z < num_thresholds && numValidChars <= MAX_VALID_CHARS; z++) {
 
               cv::threshold(img_crop, img_crop_th, thresholds[z], 255, cv::THRESH_BINARY);
-              cv::threshold(img_crop, img_crop_th_inv, thresholds[z], 255, cv::THRESH_BINARY_INV);
+              cv::bitwise_not(img_crop_th, img_crop_th_inv);
 
               findContours(img_crop_th,
                       plateBlobs, // a vector of contours
@@ -170,7 +178,6 @@ namespace alpr {
               int numBlobs = plateBlobs.size();
               int numBlobsInv = plateBlobsInv.size();
 
-              float idealAspect = config->avgCharWidthMM / config->avgCharHeightMM;
               for (int j = 0; j < numBlobs; j++) {
                       cv::Rect r0 = cv::boundingRect(cv::Mat(plateBlobs[j]));
 
@@ -187,7 +194,7 @@ namespace alpr {
       }
       //If too much or too lcittle might not be a true plate
       //if (numBlobs < 3 || numBlobs > 50) continue;
-      if (numValidChars < 4  || numValidChars > 50) continue;
+      if (numValidChars < MIN_VALID_CHARS  || numValidChars > MAX_VALID_CHARS) continue;
 
       PlateRegion PlateReg;
 
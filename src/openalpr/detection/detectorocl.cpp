@@ -125,9 +125,10 @@ namespace alpr
     }
     else
     {
-      equalizeHist( orig_frame, orig_frame );
+      Mat equalized;
+      equalizeHist( orig_frame, equalized );
 
-      plate_cascade.detectMultiScale( orig_frame, plates, config->detection_iteration_increase, config->detectionStrictness,
+      plate_cascade.detectMultiScale( equalized, plates, config->detection_iteration_increase, config->detectionStrictness,
                                       CV_HAAR_DO_CANNY_PRUNING,
                                       min_plate_size, max_plate_size );
     }
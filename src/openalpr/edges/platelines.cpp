@@ -67,7 +67,7 @@ namespace alpr
     // Create a mask that is dilated based on the detected characters
 
 
-    Mat mask = Mat::zeros(inputImage.size(), CV_8U);
+    Mat mask = pipelineData->borrowZeros(inputImage.size(), CV_8U);
 
     for (unsigned int i = 0; i < textLines.size(); i++)
     {
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "framecontext.h"
+#include "result_aggregator.h"
+
+#include <sstream>
+
+using namespace cv;
+using namespace std;
+
+namespace alpr
+{
+
+  FrameContext::FrameContext(Config* config, PreWarp* prewarp, cv::Mat img, cv::Mat gray)
+  {
+    this->config = config;
+    this->prewarp = prewarp;
+    this->img = img;
+    this->gray = gray;
+    this->parent = NULL;
+    this->allocations_avoided = 0;
+  }
+
+  FrameContext::~FrameContext()
+  {
+    for (std::map<int, FrameContext*>::iterator it = iterations.begin(); it != iterations.end(); ++it)
+      delete it->second;
+  }
+
+  cv::Mat FrameContext::getImage()
+  {
+    return img;
+  }
+
+  cv::Mat FrameContext::getGray()
+  {
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    if (!gray.data)
+    {
+      // A grayscale image is used as-is, without copying it
+      if (img.channels() > 2)
+        cvtColor( img, gray, CV_BGR2GRAY );
+      else
+        gray = img;
+    }
+
+    return gray;
+  }
+
+  cv::Mat FrameContext::getWarpedGray()
+  {
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    if (!warped_gray.data)
+    {
+      if (prewarp != NULL)
+        warped_gray = prewarp->warpImage(getGray(), warp_transform);
+      else
+        warped_gray = getGray();
+    }
+
+    return warped_gray;
+  }
+
+  cv::Mat FrameContext::getWarpTransform()
+  {
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    // The transform is found while warping
+    getWarpedGray();
+    return warp_transform;
+  }
+
+  FrameContext* FrameContext::getIteration(int iteration)
+  {
+    if (iteration == 0)
+      return this;
+
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    std::map<int, FrameContext*>::iterator it = iterations.find(iteration);
+    if (it != iterations.end())
+      return it->second;
+
+    // The change is applied to the warped image, so the iteration keeps the unwarped images of this frame
+    ResultAggregator iter_aggregator(MERGE_COMBINE, 1, config);
+    FrameContext* iteration_context = new FrameContext(config, prewarp, img, getGray());
+    iteration_context->warped_gray = iter_aggregator.applyImperceptibleChange(getWarpedGray(), iteration);
+    iteration_context->warp_transform = getWarpTransform();
+    iteration_context->parent = this;
+
+    iterations[iteration] = iteration_context;
+    return iteration_context;
+  }
+
+  cv::Mat FrameContext::getMasked(DetectorMask* mask)
+  {
+    if (mask == NULL || !mask->mask_loaded)
+      return getWarpedGray();
+
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    // Every country's detector loads the same mask, so the masked image is shared by mask contents
+    // rather than by detector
+    std::string key = mask->cacheKey();
+    std::map<std::string, cv::Mat>::iterator it = masked_images.find(key);
+    if (it != masked_images.end())
+      return it->second;
+
+    Mat masked = mask->apply_mask(getWarpedGray());
+    masked_images[key] = masked;
+    return masked;
+  }
+
+  cv::Mat FrameContext::getDetectionImage(DetectorMask* mask, cv::Rect roi, cv::Size size)
+  {
+    bool masked = mask != NULL && mask->mask_loaded;
+
+    // No mask and no resize needed.  Return a view of the image
+    if (!masked && size == roi.size())
+      return getWarpedGray()(roi);
+
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+
+    std::stringstream key;
+    if (masked)
+      key << mask->cacheKey();
+    key << "|" << roi.x << "," << roi.y << "," << roi.width << "," << roi.height << "|" << size.width << "x" << size.height;
+
+    std::map<std::string, cv::Mat>::iterator it = detection_images.find(key.str());
+    if (it != detection_images.end())
+      return it->second;
+
+    // Only the region is masked, so the rest of the frame is never copied
+    Mat warped = getWarpedGray();
+    Mat region = warped(roi);
+    if (masked)
+      region = mask->apply_mask(region, roi, warped.size());
+
+    Mat resized = region;
+    if (size != roi.size())
+      resize(region, resized, size);
+
+    detection_images[key.str()] = resized;
+    return resized;
+  }
+
+  void FrameContext::addAllocationsAvoided(int count)
+  {
+    if (parent != NULL)
+    {
+      parent->addAllocationsAvoided(count);
+      return;
+    }
+
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+    allocations_avoided += count;
+  }
+
+  int FrameContext::getAllocationsAvoided()
+  {
+    if (parent != NULL)
+      return parent->getAllocationsAvoided();
+
+    tthread::lock_guard<tthread::recursive_mutex> guard(cache_mutex);
+    return allocations_avoided;
+  }
+
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_FRAMECONTEXT_H
+#define OPENALPR_FRAMECONTEXT_H
+
+#include <map>
+#include <string>
+
+#include "opencv2/imgproc/imgproc.hpp"
+#include "config.h"
+#include "prewarp.h"
+#include "detection/detectormask.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // The images derived from a single frame.  Each one is created the first time it's needed 
+  // and then shared by every detector, country and analysis_count pass over the frame, 
+  // so the frame is only converted, warped, masked and downscaled once.
+  // Safe to use from multiple threads.  The returned images must not be modified.
+  class FrameContext
+  {
+    public:
+      // gray may be provided if the caller already has a grayscale version of img (e.g., the luma plane
+      // of a YUV frame).  A NULL prewarp leaves the image unwarped
+      FrameContext(Config* config, PreWarp* prewarp, cv::Mat img, cv::Mat gray = cv::Mat());
+      virtual ~FrameContext();
+
+      cv::Mat getImage();
+      cv::Mat getGray();
+
+      // The grayscale image with the prewarp applied.  Plates are detected and analyzed in this image
+      cv::Mat getWarpedGray();
+
+      // The transform the prewarp was applied with, for projecting points back to the original image.
+      // Empty when there is no prewarp
+      cv::Mat getWarpTransform();
+
+      // The frame with the slight change used for an analysis_count iteration applied to the 
+      // warped image.  Iteration 0 returns this frame
+      FrameContext* getIteration(int iteration);
+
+      // The warped grayscale image with the detector's mask applied
+      cv::Mat getMasked(DetectorMask* mask);
+
+      // A region of the masked image resized for plate detection.  Only the region is masked
+      cv::Mat getDetectionImage(DetectorMask* mask, cv::Rect roi, cv::Size size);
+
+      // Counts the image allocations avoided by reusing pooled buffers while analyzing the frame.
+      // Iterations count towards the frame they were created from
+      void addAllocationsAvoided(int count);
+      int getAllocationsAvoided();
+
+    private:
+
+      Config* config;
+      PreWarp* prewarp;
+
+      cv::Mat img;
+      cv::Mat gray;
+      cv::Mat warped_gray;
+      cv::Mat warp_transform;
+
+      std::map<int, FrameContext*> iterations;
+      std::map<std::string, cv::Mat> masked_images;
+      std::map<std::string, cv::Mat> detection_images;
+
+      FrameContext* parent;
+      int allocations_avoided;
+
+      // Recursive because the accessors build on each other
+      tthread::recursive_mutex cache_mutex;
+  };
+
+}
+
+#endif // OPENALPR_FRAMECONTEXT_H
@@ -46,15 +46,21 @@ namespace alpr
 
     pipeline_data->isMultiline = config->multiline;
 
+    timespec charAnalysisStartTime;
+    getTimeMonotonic(&charAnalysisStartTime);
 
     Rect expandedRegion = this->pipeline_data->regionOfInterest;
 
-    pipeline_data->crop_gray = Mat(this->pipeline_data->grayImg, expandedRegion);
-    resize(pipeline_data->crop_gray, pipeline_data->crop_gray, Size(config->templateWidthPx, config->templateHeightPx));
+    pipeline_data->crop_gray = pipeline_data->borrowImage(Size(config->templateWidthPx, config->templateHeightPx), this->pipeline_data->grayImg.type());
+    resize(Mat(this->pipeline_data->grayImg, expandedRegion), pipeline_data->crop_gray, pipeline_data->crop_gray.size());
 
 
     CharacterAnalysis textAnalysis(pipeline_data);
 
+    timespec edgeFindingStartTime;
+    getTimeMonotonic(&edgeFindingStartTime);
+    pipeline_data->stage_timing.char_analysis = diffclock(charAnalysisStartTime, edgeFindingStartTime);
+
     if (pipeline_data->disqualified)
       return;
 
@@ -62,11 +68,12 @@ namespace alpr
 
     pipeline_data->plate_corners = edgeFinder.findEdgeCorners();
 
-    if (pipeline_data->disqualified)
-      return;
-
     timespec startTime;
     getTimeMonotonic(&startTime);
+    pipeline_data->stage_timing.edge_finding = diffclock(edgeFindingStartTime, startTime);
+
+    if (pipeline_data->disqualified)
+      return;
 
 
     // Compute the transformation matrix to go from the current image to the new plate corners
@@ -77,8 +84,9 @@ namespace alpr
 
 
     // Crop the plate corners from the original color image (after un-applying prewarp)
-    vector<Point2f> projectedPoints = pipeline_data->prewarp->projectPoints(pipeline_data->plate_corners, true);
-    pipeline_data->color_deskewed = Mat::zeros(cropSize, pipeline_data->colorImg.type());
+    vector<Point2f> projectedPoints = PreWarp::projectPoints(pipeline_data->plate_corners, pipeline_data->prewarp_transform, true);
+    // warpPerspective fills every pixel, so the buffer doesn't need to be cleared
+    pipeline_data->color_deskewed = pipeline_data->borrowImage(cropSize, pipeline_data->colorImg.type());
     std::vector<cv::Point2f> deskewed_points;
     deskewed_points.push_back(cv::Point2f(0,0));
     deskewed_points.push_back(cv::Point2f(pipeline_data->color_deskewed.cols,0));
@@ -90,11 +98,13 @@ namespace alpr
     if (pipeline_data->color_deskewed.channels() > 2)
     {
       // Make a grayscale copy as well for faster processing downstream
+      pipeline_data->crop_gray = pipeline_data->borrowImage(cropSize, CV_8U);
       cv::cvtColor(pipeline_data->color_deskewed, pipeline_data->crop_gray, CV_BGR2GRAY);
     }
     else
     {
       // Copy the already grayscale image to the crop_gray img
+      pipeline_data->crop_gray = pipeline_data->borrowImage(cropSize, pipeline_data->color_deskewed.type());
       pipeline_data->color_deskewed.copyTo(pipeline_data->crop_gray);
     }
 
@@ -127,11 +137,13 @@ namespace alpr
 
 
 
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    pipeline_data->stage_timing.deskew = diffclock(startTime, endTime);
+
     if (config->debugTiming)
     {
-      timespec endTime;
-      getTimeMonotonic(&endTime);
-      cout << "deskew Time: " << diffclock(startTime, endTime) << "ms." << endl;
+      cout << "deskew Time: " << pipeline_data->stage_timing.deskew << "ms." << endl;
     }
 
 
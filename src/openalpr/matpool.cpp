@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "matpool.h"
+
+namespace alpr
+{
+
+  // Caps the memory held by a pool.  Beyond this, images are allocated normally
+  const int MAX_POOLED_BUFFERS = 64;
+
+  // True if the pool holds the only reference to the buffer
+  static bool isUnused(const cv::Mat& buffer)
+  {
+#if OPENCV_MAJOR_VERSION == 2
+    return buffer.refcount != NULL && *buffer.refcount == 1;
+#else
+    return buffer.u != NULL && buffer.u->refcount == 1;
+#endif
+  }
+
+  MatPool::MatPool()
+  {
+    buffer_count = 0;
+    allocations_avoided = 0;
+  }
+
+  MatPool::~MatPool()
+  {
+  }
+
+  cv::Mat MatPool::get(cv::Size size, int type)
+  {
+    std::vector<cv::Mat>& sized_buffers = buffers[BufferKey(std::pair<int, int>(size.width, size.height), type)];
+
+    for (unsigned int i = 0; i < sized_buffers.size(); i++)
+    {
+      if (isUnused(sized_buffers[i]))
+      {
+        allocations_avoided++;
+        return sized_buffers[i];
+      }
+    }
+
+    cv::Mat buffer(size, type);
+    if (buffer_count < MAX_POOLED_BUFFERS)
+    {
+      sized_buffers.push_back(buffer);
+      buffer_count++;
+    }
+
+    return buffer;
+  }
+
+  cv::Mat MatPool::zeros(cv::Size size, int type)
+  {
+    cv::Mat buffer = get(size, type);
+    buffer.setTo(cv::Scalar::all(0));
+    return buffer;
+  }
+
+  int MatPool::allocationsAvoided()
+  {
+    return allocations_avoided;
+  }
+
+  MatPoolSet::MatPoolSet()
+  {
+  }
+
+  MatPoolSet::~MatPoolSet()
+  {
+    for (unsigned int i = 0; i < all_pools.size(); i++)
+      delete all_pools[i];
+  }
+
+  MatPool* MatPoolSet::acquire()
+  {
+    tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+
+    if (available_pools.size() > 0)
+    {
+      MatPool* pool = available_pools.back();
+      available_pools.pop_back();
+      return pool;
+    }
+
+    MatPool* pool = new MatPool();
+    all_pools.push_back(pool);
+    return pool;
+  }
+
+  void MatPoolSet::release(MatPool* pool)
+  {
+    tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+    available_pools.push_back(pool);
+  }
+
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_MATPOOL_H
+#define OPENALPR_MATPOOL_H
+
+#include <map>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Image buffers that are reused from one plate region to the next instead of being reallocated.
+  // Every plate region works on images of the same few sizes (the template and OCR sizes), so after 
+  // the first few plates nearly every scratch image comes from the pool.
+  // A buffer goes back to the pool as soon as no cv::Mat references it anymore, so borrowed images
+  // are used like any other cv::Mat.  Functions that write to an existing Mat of the same size and type 
+  // (e.g., resize, cvtColor, warpPerspective) reuse the buffer; assigning a new image to it does not.
+  // Not thread safe.  Each thread borrows its own MatPool from a MatPoolSet.
+  class MatPool
+  {
+    public:
+      MatPool();
+      virtual ~MatPool();
+
+      // An image of the given size and type.  The contents are undefined
+      cv::Mat get(cv::Size size, int type);
+
+      // An image of the given size and type, set to 0
+      cv::Mat zeros(cv::Size size, int type);
+
+      // Number of images handed out from the pool rather than allocated
+      int allocationsAvoided();
+
+    private:
+      typedef std::pair<std::pair<int, int>, int> BufferKey;
+
+      std::map<BufferKey, std::vector<cv::Mat> > buffers;
+      int buffer_count;
+
+      int allocations_avoided;
+  };
+
+  // Lends out MatPools, one per thread doing plate analysis.  New pools are only
+  // created when all of the existing ones are in use
+  class MatPoolSet
+  {
+    public:
+      MatPoolSet();
+      virtual ~MatPoolSet();
+
+      MatPool* acquire();
+      void release(MatPool* pool);
+
+    private:
+      std::vector<MatPool*> all_pools;
+      std::vector<MatPool*> available_pools;
+
+      tthread::mutex pool_mutex;
+  };
+
+  // Borrows a MatPool for the lifetime of the object
+  class ScopedMatPool
+  {
+    public:
+      ScopedMatPool(MatPoolSet* pools) { this->pools = pools; this->pool = pools->acquire(); }
+      ~ScopedMatPool() { pools->release(pool); }
+
+      MatPool* get() { return pool; }
+
+    private:
+      MatPoolSet* pools;
+      MatPool* pool;
+
+      ScopedMatPool(const ScopedMatPool&);
+      ScopedMatPool& operator=(const ScopedMatPool&);
+  };
+
+}
+
+#endif // OPENALPR_MATPOOL_H
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <sys/stat.h>
+
+#include "modelregistry.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  struct ModelRegistryEntry
+  {
+    SharedModel* model;
+    int references;
+    int64_t bytes;
+  };
+
+  static std::map<std::string, ModelRegistryEntry> registry_entries;
+  static tthread::mutex registry_mutex;
+
+  // 64-bit FNV-1a hash of the file contents, or "missing" if it can't be read
+  static std::string hashFile(std::string path)
+  {
+    std::ifstream infile(path.c_str(), std::ios::in | std::ios::binary);
+    if (!infile)
+      return "missing";
+
+    uint64_t hash = 14695981039346656037ULL;
+    char buffer[65536];
+    while (infile)
+    {
+      infile.read(buffer, sizeof(buffer));
+      std::streamsize count = infile.gcount();
+      for (std::streamsize i = 0; i < count; i++)
+      {
+        hash ^= (unsigned char) buffer[i];
+        hash *= 1099511628211ULL;
+      }
+    }
+
+    std::stringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+  }
+
+  // The hash of a file as it was when last read.  Only valid while the size and modification time match
+  struct FileHash
+  {
+    int64_t size;
+    int64_t modified;
+    std::string hash;
+  };
+
+  static std::map<std::string, FileHash> file_hashes;
+  static tthread::mutex file_hashes_mutex;
+
+  // Returns false if the file doesn't exist.  The modification time is in nanoseconds
+  static bool getFileVersion(std::string path, int64_t& size, int64_t& modified)
+  {
+    struct stat stat_buf;
+    if (stat(path.c_str(), &stat_buf) != 0)
+      return false;
+
+    size = stat_buf.st_size;
+    #if defined(WINDOWS)
+      modified = ((int64_t) stat_buf.st_mtime) * 1000000000LL;
+    #elif defined(__APPLE__)
+      modified = ((int64_t) stat_buf.st_mtimespec.tv_sec) * 1000000000LL + stat_buf.st_mtimespec.tv_nsec;
+    #else
+      modified = ((int64_t) stat_buf.st_mtim.tv_sec) * 1000000000LL + stat_buf.st_mtim.tv_nsec;
+    #endif
+
+    return true;
+  }
+
+  // Every instance asks for the key of each model it loads, so a file is only read and hashed
+  // again once its size or modification time changes
+  static std::string getFileHash(std::string path)
+  {
+    int64_t size, modified;
+    if (!getFileVersion(path, size, modified))
+      return "missing";
+
+    {
+      tthread::lock_guard<tthread::mutex> guard(file_hashes_mutex);
+
+      std::map<std::string, FileHash>::iterator cached = file_hashes.find(path);
+      if (cached != file_hashes.end() && cached->second.size == size && cached->second.modified == modified)
+        return cached->second.hash;
+    }
+
+    // Hashing a large training file is slow, so do it outside of the lock
+    FileHash file_hash;
+    file_hash.size = size;
+    file_hash.modified = modified;
+    file_hash.hash = hashFile(path);
+
+    tthread::lock_guard<tthread::mutex> guard(file_hashes_mutex);
+    file_hashes[path] = file_hash;
+
+    return file_hash.hash;
+  }
+
+  std::string ModelRegistry::getKey(std::string type, std::string path, std::string extra)
+  {
+    return type + "|" + path + "|" + getFileHash(path) + "|" + extra;
+  }
+
+  SharedModel* ModelRegistry::acquire(std::string key)
+  {
+    tthread::lock_guard<tthread::mutex> guard(registry_mutex);
+
+    std::map<std::string, ModelRegistryEntry>::iterator entry = registry_entries.find(key);
+    if (entry == registry_entries.end())
+      return NULL;
+
+    entry->second.references++;
+    return entry->second.model;
+  }
+
+  SharedModel* ModelRegistry::add(std::string key, SharedModel* model, int64_t bytes)
+  {
+    SharedModel* existing_model = NULL;
+    {
+      tthread::lock_guard<tthread::mutex> guard(registry_mutex);
+
+      std::map<std::string, ModelRegistryEntry>::iterator entry = registry_entries.find(key);
+      if (entry == registry_entries.end())
+      {
+        ModelRegistryEntry new_entry;
+        new_entry.model = model;
+        new_entry.references = 1;
+        new_entry.bytes = bytes;
+        registry_entries[key] = new_entry;
+        return model;
+      }
+
+      entry->second.references++;
+      existing_model = entry->second.model;
+    }
+
+    // Another thread loaded the same model at the same time.  Keep theirs
+    if (existing_model != model)
+      delete model;
+
+    return existing_model;
+  }
+
+  void ModelRegistry::release(SharedModel* model)
+  {
+    if (model == NULL)
+      return;
+
+    SharedModel* unused_model = NULL;
+    {
+      tthread::lock_guard<tthread::mutex> guard(registry_mutex);
+
+      std::map<std::string, ModelRegistryEntry>::iterator entry;
+      for (entry = registry_entries.begin(); entry != registry_entries.end(); ++entry)
+      {
+        if (entry->second.model != model)
+          continue;
+
+        entry->second.references--;
+        if (entry->second.references <= 0)
+        {
+          unused_model = model;
+          registry_entries.erase(entry);
+        }
+        break;
+      }
+    }
+
+    delete unused_model;
+  }
+
+  ModelRegistryStats ModelRegistry::getStats()
+  {
+    tthread::lock_guard<tthread::mutex> guard(registry_mutex);
+
+    ModelRegistryStats stats;
+    stats.models = registry_entries.size();
+    stats.references = 0;
+    stats.bytes_loaded = 0;
+    stats.bytes_saved = 0;
+
+    std::map<std::string, ModelRegistryEntry>::iterator entry;
+    for (entry = registry_entries.begin(); entry != registry_entries.end(); ++entry)
+    {
+      // Without the registry, every reference would have loaded a copy of its own
+      int copies = entry->second.model->loadedCopies();
+      stats.references += entry->second.references;
+      stats.bytes_loaded += entry->second.bytes * copies;
+      if (entry->second.references > copies)
+        stats.bytes_saved += entry->second.bytes * (entry->second.references - copies);
+    }
+
+    return stats;
+  }
+
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_MODELREGISTRY_H
+#define OPENALPR_MODELREGISTRY_H
+
+#include <stdint.h>
+#include <string>
+
+namespace alpr
+{
+
+  // A model loaded from disk that is shared read-only by every Alpr instance in the process
+  class SharedModel
+  {
+    public:
+      virtual ~SharedModel() {}
+
+      // Number of copies of the model actually held in memory.  Models that keep a separate
+      // copy per concurrent user (e.g., Tesseract handles) override this
+      virtual int loadedCopies() { return 1; }
+  };
+
+  // Wraps any object so that it can be kept in the registry
+  template <class T>
+  class SharedObject : public SharedModel
+  {
+    public:
+      SharedObject(T* object) { this->object = object; }
+      virtual ~SharedObject() { delete object; }
+
+      T* object;
+  };
+
+  struct ModelRegistryStats
+  {
+    int models;
+    int references;
+
+    // Approximate, based on the size of the model files
+    int64_t bytes_loaded;
+    int64_t bytes_saved;
+  };
+
+  // Process-wide, reference counted cache of loaded models (cascades, OCR training data and
+  // plate patterns).  Models are keyed by their type, file path and a hash of the file contents,
+  // so a model is only shared if the file on disk is identical.  A model is unloaded when the
+  // last reference to it is released.
+  class ModelRegistry
+  {
+    public:
+
+      // The registry key for a model file.  The extra string holds any settings that change
+      // how the file is loaded.  The file is only hashed again once its size or modification time changes
+      static std::string getKey(std::string type, std::string path, std::string extra = "");
+
+      // Returns the model with the given key and adds a reference to it, or NULL if it isn't loaded
+      static SharedModel* acquire(std::string key);
+
+      // Adds a newly loaded model with one reference and takes ownership of it.  If another thread 
+      // added the same key first, the new model is deleted and the existing one is returned instead
+      static SharedModel* add(std::string key, SharedModel* model, int64_t bytes);
+
+      // Drops a reference.  The model is deleted once nothing references it
+      static void release(SharedModel* model);
+
+      static ModelRegistryStats getStats();
+  };
+
+}
+
+#endif // OPENALPR_MODELREGISTRY_H
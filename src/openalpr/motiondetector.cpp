@@ -5,7 +5,7 @@ using namespace cv;
 namespace alpr
 {
   
-MotionDetector::MotionDetector()
+MotionDetector::MotionDetector(Config* config)
 {
 	#if OPENCV_MAJOR_VERSION == 2
 	pMOG2 = new BackgroundSubtractorMOG2();
@@ -13,6 +13,10 @@ MotionDetector::MotionDetector()
 	// OpenCV 3
 	pMOG2 = createBackgroundSubtractorMOG2();
 	#endif
+
+	max_width = config->motionMaxWidth;
+	min_area_px = config->motionMinAreaPx;
+	merge_distance_px = config->motionMergeDistancePx;
 }
 
 MotionDetector::~MotionDetector()
@@ -20,68 +24,116 @@ MotionDetector::~MotionDetector()
 
 }
 
+// Shrinks the frame into smallFrame.  Returns the scale from the full resolution frame to smallFrame
+float MotionDetector::shrinkFrame(cv::Mat frame)
+{
+	float scale = 1.0;
+	if (max_width > 0 && frame.cols > max_width)
+		scale = ((float) max_width) / frame.cols;
+
+	cv::Size small_size(std::max(1, (int) (frame.cols * scale)), std::max(1, (int) (frame.rows * scale)));
+	if (scale < 1.0)
+		resize(frame, smallFrame, small_size, 0, 0, INTER_AREA);
+	else
+		frame.copyTo(smallFrame);
+
+	return scale;
+}
+
 void MotionDetector::ResetMotionDetection(cv::Mat* frame)
 {
+	shrinkFrame(*frame);
 #if OPENCV_MAJOR_VERSION == 2
-	pMOG2->operator()(*frame, fgMaskMOG2, 1);
+	pMOG2->operator()(smallFrame, fgMaskMOG2, 1);
 #else
 	// OpenCV 3
-	pMOG2->apply(*frame, fgMaskMOG2, 1);
+	pMOG2->apply(smallFrame, fgMaskMOG2, 1);
 #endif
 }
 
-cv::Rect MotionDetector::MotionDetect(cv::Mat* frame)
-//Detect motion and create ONE recangle that contains all the detected motion
+std::vector<cv::Rect> MotionDetector::MotionDetect(cv::Mat frame)
 {
 	std::vector<std::vector<cv::Point> > contours;
 	std::vector<cv::Vec4i> hierarchy;
-	cv::Rect bounding_rect;
 	std::vector<cv::Rect> rects;
-	cv::Rect largest_rect, rect_temp;
 
-	// Detect motion
+	float scale = shrinkFrame(frame);
 
+	// Detect motion
 #if OPENCV_MAJOR_VERSION == 2
-	pMOG2->operator()(*frame, fgMaskMOG2, -1);
+	pMOG2->operator()(smallFrame, fgMaskMOG2, -1);
 #else
 	// OpenCV 3
-	pMOG2->apply(*frame, fgMaskMOG2);
+	pMOG2->apply(smallFrame, fgMaskMOG2);
 #endif
 
-	//Remove noise
-	cv::erode(fgMaskMOG2, fgMaskMOG2, getStructuringElement(cv::MORPH_RECT, cv::Size(6, 6)));
+	// Drop the shadows, which MOG2 marks as gray
+	threshold(fgMaskMOG2, fgMaskMOG2, 200, 255, THRESH_BINARY);
+
+	//Remove noise.  The kernel shrinks with the frame
+	int kernel_size = std::max(2, (int) (6 * scale + 0.5));
+	cv::erode(fgMaskMOG2, fgMaskMOG2, getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size)));
+
 	// Find the contours of motion areas in the image
-	findContours(fgMaskMOG2, contours, hierarchy, CV_RETR_LIST, CV_CHAIN_APPROX_SIMPLE);
-	// Find the bounding rectangles of the areas of motion
-	if (contours.size() > 0)
+	findContours(fgMaskMOG2, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+
+	float min_area = min_area_px * scale * scale;
+	for (unsigned int i = 0; i < contours.size(); i++)
 	{
-		for (int i = 0; i < contours.size(); i++)
-		{
-			bounding_rect = boundingRect(contours[i]);
+		cv::Rect bounding_rect = boundingRect(contours[i]);
+		if (bounding_rect.area() >= min_area)
 			rects.push_back(bounding_rect);
-		}
-		// Determine the overall area with motion.
-		largest_rect = rects[0];
-		for (int i = 1; i < rects.size(); i++)
+	}
+
+	// Merge the areas that overlap or are close together, until no more can be merged
+	int merge_distance = (int) (merge_distance_px * scale + 0.5);
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (unsigned int i = 0; i < rects.size() && !merged; i++)
 		{
-			rect_temp.x = min(largest_rect.x,rects[i].x);
-			rect_temp.y = min(largest_rect.y,rects[i].y);
-			rect_temp.width = max(largest_rect.x + largest_rect.width, rects[i].x + rects[i].width)-rect_temp.x;
-			rect_temp.height = max(largest_rect.y + largest_rect.height, rects[i].y + rects[i].height) - rect_temp.y;
-			largest_rect = rect_temp;
+			cv::Rect padded(rects[i].x - merge_distance, rects[i].y - merge_distance, 
+					rects[i].width + 2 * merge_distance, rects[i].height + 2 * merge_distance);
+
+			for (unsigned int j = i + 1; j < rects.size(); j++)
+			{
+				if ((padded & rects[j]).area() > 0)
+				{
+					rects[i] = rects[i] | rects[j];
+					rects.erase(rects.begin() + j);
+					merged = true;
+					break;
+				}
+			}
 		}
-		rectangle(*frame, rect_temp, cv::Scalar(0, 255, 0), 1, 8, 0);
 	}
-	else
-        {
-          largest_rect.x = 0;
-          largest_rect.y = 0;
-          largest_rect.width = 0;
-          largest_rect.height = 0;
-        }
-		
+
+	// Scale back to the full resolution frame, padded so that plates on the edge of the motion are included
+	std::vector<cv::Rect> regions;
+	for (unsigned int i = 0; i < rects.size(); i++)
+	{
+		cv::Rect full_rect((int) (rects[i].x / scale), (int) (rects[i].y / scale), 
+				(int) (rects[i].width / scale + 0.5), (int) (rects[i].height / scale + 0.5));
+		regions.push_back(expandRect(full_rect, merge_distance_px, merge_distance_px, frame.cols, frame.rows));
+	}
+
 //	imshow("Motion detect", fgMaskMOG2);
-	return expandRect(largest_rect, 0, 0, frame->cols, frame->rows);
+	return regions;
 }
 
-}
\ No newline at end of file
+cv::Rect MotionDetector::getBounds(const std::vector<cv::Rect>& regions)
+{
+	cv::Rect bounds;
+	for (unsigned int i = 0; i < regions.size(); i++)
+	{
+		if (i == 0)
+			bounds = regions[i];
+		else
+			bounds = bounds | regions[i];
+	}
+
+	return bounds;
+}
+
+}
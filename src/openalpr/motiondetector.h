@@ -2,22 +2,40 @@
 #ifndef OPENALPR_MOTIONDETECTOR_H
 #define OPENALPR_MOTIONDETECTOR_H
 
+#include <vector>
+
 #include "opencv2/opencv.hpp"
 #include "utility.h"
+#include "config.h"
 
 namespace alpr
 {
+  // Finds the areas of a video frame that are moving.  Background subtraction runs on a shrunken 
+  // copy of each frame, and the moving areas are returned as separate regions in full resolution 
+  // coordinates, ready to be used as regions of interest.
   class MotionDetector
   {
       private: cv::Ptr<cv::BackgroundSubtractor> pMOG2; //MOG2 Background subtractor
       private: cv::Mat fgMaskMOG2;
+      private: cv::Mat smallFrame;
+      private: int max_width;
+      private: int min_area_px;
+      private: int merge_distance_px;
       public:
-          MotionDetector();
+          MotionDetector(Config* config);
           virtual ~MotionDetector();
 
           void ResetMotionDetection(cv::Mat* frame);
-          cv::Rect MotionDetect(cv::Mat* frame);
+
+          // Returns a region for each group of moving areas.  Empty if nothing moved.  The frame is not modified
+          std::vector<cv::Rect> MotionDetect(cv::Mat frame);
+
+          // The smallest rectangle containing all of the regions.  Empty if there are none
+          static cv::Rect getBounds(const std::vector<cv::Rect>& regions);
+
+      private:
+          float shrinkFrame(cv::Mat frame);
   };
 }
 
-#endif // OPENALPR_MOTIONDETECTOR_H
\ No newline at end of file
+#endif // OPENALPR_MOTIONDETECTOR_H
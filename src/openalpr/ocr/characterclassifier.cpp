@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits.h>
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+#include "characterclassifier.h"
+
+using namespace std;
+
+namespace alpr
+{
+
+  const char MODEL_MAGIC[8] = { 'A', 'L', 'P', 'R', 'C', 'H', 'A', 'R' };
+  const int MODEL_VERSION = 1;
+
+  // Feature values are scaled so that a vector's length is this, making a perfect match FEATURE_SCALE^2
+  const int FEATURE_SCALE = 127;
+
+  // Training examples at least this similar to a kept example of the same letter add nothing
+  const float DUPLICATE_SIMILARITY = 0.97;
+
+  // Integers are stored little endian, so models can be copied between machines
+  static void writeInt(ofstream& out, unsigned int value)
+  {
+    for (int i = 0; i < 4; i++)
+      out.put((char) ((value >> (8 * i)) & 0xFF));
+  }
+
+  static bool readInt(ifstream& in, unsigned int& value)
+  {
+    value = 0;
+    for (int i = 0; i < 4; i++)
+    {
+      int c = in.get();
+      if (c == EOF)
+        return false;
+      value |= ((unsigned int) c) << (8 * i);
+    }
+    return true;
+  }
+
+  CharacterClassifier::CharacterClassifier()
+  {
+    loaded = false;
+  }
+
+  CharacterClassifier::~CharacterClassifier()
+  {
+  }
+
+  bool CharacterClassifier::load(std::string model_file)
+  {
+    loaded = false;
+    letters.clear();
+    example_letters.clear();
+    features.clear();
+
+    ifstream in(model_file.c_str(), ios::in | ios::binary);
+    if (!in)
+    {
+      cerr << "--(!)Error loading character classifier " << model_file << endl;
+      return false;
+    }
+
+    char magic[8];
+    in.read(magic, 8);
+    unsigned int version, grid_size, letter_count, example_count;
+    if (!in || !equal(magic, magic + 8, MODEL_MAGIC) || !readInt(in, version) || version != MODEL_VERSION || 
+        !readInt(in, grid_size) || grid_size != GRID_SIZE || !readInt(in, letter_count))
+    {
+      cerr << "--(!)Invalid character classifier " << model_file << endl;
+      return false;
+    }
+
+    for (unsigned int i = 0; i < letter_count; i++)
+    {
+      unsigned int length;
+      if (!readInt(in, length) || length > 16)
+      {
+        cerr << "--(!)Invalid character classifier " << model_file << endl;
+        return false;
+      }
+
+      string letter(length, ' ');
+      in.read(&letter[0], length);
+      letters.push_back(letter);
+    }
+
+    if (!readInt(in, example_count))
+    {
+      cerr << "--(!)Invalid character classifier " << model_file << endl;
+      return false;
+    }
+
+    example_letters.resize(example_count);
+    for (unsigned int i = 0; i < example_count; i++)
+    {
+      unsigned int letter_index;
+      if (!readInt(in, letter_index) || letter_index >= letter_count)
+      {
+        cerr << "--(!)Invalid character classifier " << model_file << endl;
+        return false;
+      }
+      example_letters[i] = letter_index;
+    }
+
+    features.resize(example_count * FEATURE_LENGTH);
+    if (example_count > 0)
+      in.read((char*) &features[0], features.size());
+
+    if (!in)
+    {
+      cerr << "--(!)Invalid character classifier " << model_file << endl;
+      return false;
+    }
+
+    loaded = true;
+    return true;
+  }
+
+  bool CharacterClassifier::save(std::string model_file)
+  {
+    ofstream out(model_file.c_str(), ios::out | ios::binary);
+    if (!out)
+      return false;
+
+    out.write(MODEL_MAGIC, 8);
+    writeInt(out, MODEL_VERSION);
+    writeInt(out, GRID_SIZE);
+
+    writeInt(out, letters.size());
+    for (unsigned int i = 0; i < letters.size(); i++)
+    {
+      writeInt(out, letters[i].length());
+      out.write(letters[i].data(), letters[i].length());
+    }
+
+    writeInt(out, example_letters.size());
+    for (unsigned int i = 0; i < example_letters.size(); i++)
+      writeInt(out, example_letters[i]);
+
+    if (features.size() > 0)
+      out.write((const char*) &features[0], features.size());
+
+    return (bool) out;
+  }
+
+  bool CharacterClassifier::isLoaded()
+  {
+    return loaded;
+  }
+
+  int CharacterClassifier::size()
+  {
+    return example_letters.size();
+  }
+
+  bool CharacterClassifier::addExample(std::string letter, cv::Mat character_image)
+  {
+    signed char example[FEATURE_LENGTH];
+    getFeatures(character_image, example);
+
+    int letter_index = find(letters.begin(), letters.end(), letter) - letters.begin();
+    if (letter_index == (int) letters.size())
+      letters.push_back(letter);
+
+    const int duplicate_score = (int) (DUPLICATE_SIMILARITY * FEATURE_SCALE * FEATURE_SCALE);
+    for (unsigned int i = 0; i < example_letters.size(); i++)
+    {
+      if (example_letters[i] == letter_index && similarity(example, &features[i * FEATURE_LENGTH]) >= duplicate_score)
+        return false;
+    }
+
+    example_letters.push_back(letter_index);
+    features.insert(features.end(), example, example + FEATURE_LENGTH);
+    loaded = true;
+    return true;
+  }
+
+  // Sorts letters by their best score, highest first
+  struct LetterScoreCompare
+  {
+    const std::vector<int>* scores;
+    bool operator()(int left, int right) const { return (*scores)[left] > (*scores)[right]; }
+  };
+
+  std::vector<CharacterMatch> CharacterClassifier::classify(cv::Mat character_image, unsigned int max_matches)
+  {
+    std::vector<CharacterMatch> matches;
+    if (example_letters.size() == 0)
+      return matches;
+
+    signed char query[FEATURE_LENGTH];
+    getFeatures(character_image, query);
+
+    // The best score of each letter
+    std::vector<int> letter_scores(letters.size(), INT_MIN);
+    for (unsigned int i = 0; i < example_letters.size(); i++)
+    {
+      int score = similarity(query, &features[i * FEATURE_LENGTH]);
+      if (score > letter_scores[example_letters[i]])
+        letter_scores[example_letters[i]] = score;
+    }
+
+    std::vector<int> letter_order;
+    for (unsigned int i = 0; i < letters.size(); i++)
+    {
+      if (letter_scores[i] != INT_MIN)
+        letter_order.push_back(i);
+    }
+
+    LetterScoreCompare compare;
+    compare.scores = &letter_scores;
+    std::sort(letter_order.begin(), letter_order.end(), compare);
+
+    for (unsigned int i = 0; i < letter_order.size() && i < max_matches; i++)
+    {
+      CharacterMatch match;
+      match.letter = letters[letter_order[i]];
+      match.confidence = std::max(0.0f, 100.0f * letter_scores[letter_order[i]] / (FEATURE_SCALE * FEATURE_SCALE));
+      matches.push_back(match);
+    }
+
+    return matches;
+  }
+
+  // Shrinks the character to the grid, with light text on a dark background, and scales the values 
+  // to a mean of 0 and a length of FEATURE_SCALE
+  void CharacterClassifier::getFeatures(cv::Mat character_image, signed char* features)
+  {
+    cv::Mat gray;
+    if (character_image.channels() > 1)
+      cv::cvtColor(character_image, gray, CV_BGR2GRAY);
+    else
+      gray = character_image;
+
+    cv::Mat grid;
+    cv::resize(gray, grid, cv::Size(GRID_SIZE, GRID_SIZE), 0, 0, cv::INTER_AREA);
+
+    // The border of a character image is background.  Make sure the background is the dark side
+    float border_sum = 0;
+    for (int i = 0; i < GRID_SIZE; i++)
+      border_sum += grid.at<uchar>(0, i) + grid.at<uchar>(GRID_SIZE - 1, i) + grid.at<uchar>(i, 0) + grid.at<uchar>(i, GRID_SIZE - 1);
+    bool invert = border_sum / (4 * GRID_SIZE) > 127;
+
+    float values[FEATURE_LENGTH];
+    float mean = 0;
+    for (int y = 0; y < GRID_SIZE; y++)
+    {
+      const uchar* row = grid.ptr<uchar>(y);
+      for (int x = 0; x < GRID_SIZE; x++)
+      {
+        float value = invert ? 255 - row[x] : row[x];
+        values[y * GRID_SIZE + x] = value;
+        mean += value;
+      }
+    }
+    mean = mean / FEATURE_LENGTH;
+
+    float length = 0;
+    for (int i = 0; i < FEATURE_LENGTH; i++)
+    {
+      values[i] = values[i] - mean;
+      length += values[i] * values[i];
+    }
+    length = sqrt(length);
+
+    for (int i = 0; i < FEATURE_LENGTH; i++)
+    {
+      float value = length > 0 ? values[i] * FEATURE_SCALE / length : 0;
+      features[i] = (signed char) std::max(-FEATURE_SCALE, std::min(FEATURE_SCALE, (int) floor(value + 0.5)));
+    }
+  }
+
+  // Dot product of two feature vectors.  A simple loop over fixed-size arrays, which compilers vectorize
+  int CharacterClassifier::similarity(const signed char* a, const signed char* b)
+  {
+    int sum = 0;
+    for (int i = 0; i < FEATURE_LENGTH; i++)
+      sum += a[i] * b[i];
+    return sum;
+  }
+
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_CHARACTERCLASSIFIER_H
+#define OPENALPR_CHARACTERCLASSIFIER_H
+
+#include <string>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+namespace alpr
+{
+
+  struct CharacterMatch
+  {
+    std::string letter;
+
+    // Similarity to the closest example of the letter, from 0 to 100
+    float confidence;
+  };
+
+  // Recognizes single character images by comparing them to example characters (nearest neighbor).
+  // Each character image is shrunk to a 16x16 grid and normalized for brightness and contrast, 
+  // and stored as 256 signed bytes, so comparing against an example is one short integer dot product.
+  // The examples are stored in a compact binary model file.  Read-only once loaded, so one
+  // classifier can be shared by any number of threads.
+  class CharacterClassifier
+  {
+    public:
+      CharacterClassifier();
+      virtual ~CharacterClassifier();
+
+      static const int GRID_SIZE = 16;
+      static const int FEATURE_LENGTH = GRID_SIZE * GRID_SIZE;
+
+      bool load(std::string model_file);
+      bool save(std::string model_file);
+      bool isLoaded();
+
+      // Number of examples kept in the model
+      int size();
+
+      // Adds a training example.  Examples that are nearly identical to one already kept for the same 
+      // letter are skipped, which keeps the model small.  Returns true if the example was kept
+      bool addExample(std::string letter, cv::Mat character_image);
+
+      // The most similar letters, best first.  Each letter appears once
+      std::vector<CharacterMatch> classify(cv::Mat character_image, unsigned int max_matches);
+
+    private:
+      bool loaded;
+
+      std::vector<std::string> letters;
+
+      // One entry per example, pointing into letters
+      std::vector<int> example_letters;
+
+      // FEATURE_LENGTH values per example, one example after another
+      std::vector<signed char> features;
+
+      static void getFeatures(cv::Mat character_image, signed char* features);
+      static int similarity(const signed char* a, const signed char* b);
+  };
+
+}
+
+#endif // OPENALPR_CHARACTERCLASSIFIER_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "classifier_ocr.h"
+
+#include "segmentation/charactersegmenter.h"
+#include "support/filesystem.h"
+
+using namespace std;
+using namespace cv;
+
+namespace alpr
+{
+
+  // The number of letters reported for each character box
+  const unsigned int MAX_CHOICES = 4;
+
+  ClassifierOcr::ClassifierOcr(Config* config)
+  : OCR(config)
+  {
+    init();
+  }
+
+  ClassifierOcr::ClassifierOcr(Config* config, RegexRuleSet* rules)
+  : OCR(config, rules)
+  {
+    init();
+  }
+
+  void ClassifierOcr::init()
+  {
+    this->postProcessor.setConfidenceThreshold(config->postProcessMinConfidence, config->postProcessConfidenceSkipLevel);
+
+    string model_file = config->getClassifierModelFile();
+    string key = ModelRegistry::getKey("charclassifier", model_file);
+
+    classifier = (SharedObject<CharacterClassifier>*) ModelRegistry::acquire(key);
+    if (classifier == NULL)
+    {
+      CharacterClassifier* new_classifier = new CharacterClassifier();
+      new_classifier->load(model_file);
+      classifier = (SharedObject<CharacterClassifier>*) ModelRegistry::add(key, new SharedObject<CharacterClassifier>(new_classifier), getFileInfo(model_file).size);
+    }
+  }
+
+  ClassifierOcr::~ClassifierOcr()
+  {
+    ModelRegistry::release(classifier);
+  }
+
+  std::vector<OcrChar> ClassifierOcr::recognize_line(int line_idx, int threshold_idx, PipelineData* pipeline_data) {
+
+    std::vector<OcrChar> recognized_chars;
+
+    Mat threshold = pipeline_data->thresholds[threshold_idx];
+
+    for (unsigned int j = 0; j < pipeline_data->charRegions[line_idx].size(); j++)
+    {
+      Rect expandedRegion = expandRect( pipeline_data->charRegions[line_idx][j], 2, 2, threshold.cols, threshold.rows) ;
+
+      std::vector<CharacterMatch> matches = classifier->object->classify(threshold(expandedRegion), MAX_CHOICES);
+
+      for (unsigned int k = 0; k < matches.size(); k++)
+      {
+        OcrChar c;
+        c.char_index = j;
+        c.confidence = matches[k].confidence;
+        c.letter = matches[k].letter;
+        recognized_chars.push_back(c);
+
+        // The best letter is added twice, the same as the Tesseract OCR, which the post processing is tuned for
+        if (k == 0)
+          recognized_chars.push_back(c);
+
+        if (this->config->debugOcr)
+          printf("charpos%d line%d: threshold %d:  choice %s, conf: %f\n", j, line_idx, threshold_idx, c.letter.c_str(), c.confidence);
+      }
+    }
+
+    return recognized_chars;
+  }
+
+  void ClassifierOcr::segment(PipelineData* pipeline_data) {
+
+    CharacterSegmenter segmenter(pipeline_data);
+    segmenter.segment();
+  }
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_CLASSIFIEROCR_H
+#define OPENALPR_CLASSIFIEROCR_H
+
+#include <vector>
+
+#include "config.h"
+#include "pipeline_data.h"
+#include "modelregistry.h"
+
+#include "ocr.h"
+#include "characterclassifier.h"
+
+namespace alpr
+{
+
+  // Reads each character box with a CharacterClassifier instead of Tesseract (ocr_engine = classifier).
+  // The model is loaded once and shared through the ModelRegistry
+  class ClassifierOcr : public OCR 
+  {
+
+    public:
+      ClassifierOcr(Config* config);
+      ClassifierOcr(Config* config, RegexRuleSet* rules);
+      virtual ~ClassifierOcr();
+
+    private:
+
+      std::vector<OcrChar> recognize_line(int line_index, int threshold_index, PipelineData* pipeline_data);
+      void segment(PipelineData* pipeline_data);
+
+      void init();
+
+      SharedObject<CharacterClassifier>* classifier;
+  };
+
+}
+
+#endif // OPENALPR_CLASSIFIEROCR_H
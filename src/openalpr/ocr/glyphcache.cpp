@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "glyphcache.h"
+
+#include "opencv2/imgproc/imgproc.hpp"
+
+namespace alpr
+{
+
+  // Size of the black and white copy of the character that the key is made from
+  const int GLYPH_KEY_SIZE = 16;
+
+  // The size of the character image is also part of the key, rounded to this many pixels.  
+  // Tesseract rejects characters that are too small, so the size can change the result
+  const int GLYPH_SIZE_STEP = 4;
+
+  GlyphCache::GlyphCache(int capacity)
+  {
+    this->capacity = capacity;
+
+    hits = 0;
+    misses = 0;
+    miss_ms = 0;
+  }
+
+  GlyphCache::~GlyphCache()
+  {
+  }
+
+  std::string GlyphCache::getKey(cv::Mat glyph)
+  {
+    cv::Mat small_glyph;
+    cv::resize(glyph, small_glyph, cv::Size(GLYPH_KEY_SIZE, GLYPH_KEY_SIZE), 0, 0, cv::INTER_AREA);
+
+    // One bit per pixel of the small copy
+    std::string key(GLYPH_KEY_SIZE * GLYPH_KEY_SIZE / 8 + 2, '\0');
+    for (int y = 0; y < GLYPH_KEY_SIZE; y++)
+    {
+      const uchar* row = small_glyph.ptr<uchar>(y);
+      for (int x = 0; x < GLYPH_KEY_SIZE; x++)
+      {
+        if (row[x] >= 128)
+        {
+          int bit = y * GLYPH_KEY_SIZE + x;
+          key[bit / 8] |= (char) (1 << (bit % 8));
+        }
+      }
+    }
+
+    key[key.size() - 2] = (char) (glyph.cols / GLYPH_SIZE_STEP);
+    key[key.size() - 1] = (char) (glyph.rows / GLYPH_SIZE_STEP);
+
+    return key;
+  }
+
+  bool GlyphCache::lookup(const std::string& key, std::vector<OcrChar>& chars)
+  {
+    tthread::lock_guard<tthread::mutex> guard(cache_mutex);
+
+    std::map<std::string, std::list<GlyphEntry>::iterator>::iterator found = index.find(key);
+    if (found == index.end())
+    {
+      misses++;
+      return false;
+    }
+
+    // Move it to the front, as the most recently used
+    entries.splice(entries.begin(), entries, found->second);
+
+    chars = found->second->second;
+    hits++;
+    return true;
+  }
+
+  void GlyphCache::add(const std::string& key, const std::vector<OcrChar>& chars, double recognize_ms)
+  {
+    tthread::lock_guard<tthread::mutex> guard(cache_mutex);
+
+    miss_ms += recognize_ms;
+
+    // Another thread may have added it since the lookup
+    if (capacity <= 0 || index.find(key) != index.end())
+      return;
+
+    entries.push_front(GlyphEntry(key, chars));
+    index[key] = entries.begin();
+
+    while ((int) entries.size() > capacity)
+    {
+      index.erase(entries.back().first);
+      entries.pop_back();
+    }
+  }
+
+  GlyphCacheStats GlyphCache::getStats()
+  {
+    tthread::lock_guard<tthread::mutex> guard(cache_mutex);
+
+    GlyphCacheStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.size = entries.size();
+    stats.saved_ms = 0;
+    if (misses > 0)
+      stats.saved_ms = hits * (miss_ms / misses);
+
+    return stats;
+  }
+
+}
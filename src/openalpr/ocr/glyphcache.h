@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_GLYPHCACHE_H
+#define OPENALPR_GLYPHCACHE_H
+
+#include <list>
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+#include "ocr.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  struct GlyphCacheStats
+  {
+    int64_t hits;
+    int64_t misses;
+    int size;
+
+    // Estimated from the average time of the lookups that missed
+    double saved_ms;
+  };
+
+  // Remembers the OCR results for recently seen character images.  In video the same plate is read 
+  // on many frames in a row, and the same characters show up on many plates, so most character 
+  // images are close copies of one already recognized.
+  // Images are matched on a small black and white copy of the image plus its size, so near-identical 
+  // images share an entry.  The least recently used entry is dropped when the cache is full.
+  // Safe to share between threads.
+  class GlyphCache
+  {
+    public:
+      GlyphCache(int capacity);
+      virtual ~GlyphCache();
+
+      // The key for a character image (white text on black or black text on white, as long as it's consistent)
+      static std::string getKey(cv::Mat glyph);
+
+      // Returns true and fills in the characters if the key is in the cache.  The char_index of each
+      // character is not stored
+      bool lookup(const std::string& key, std::vector<OcrChar>& chars);
+
+      // Adds the characters recognized for a key that missed, and the time it took to recognize them
+      void add(const std::string& key, const std::vector<OcrChar>& chars, double recognize_ms);
+
+      GlyphCacheStats getStats();
+
+    private:
+      int capacity;
+
+      typedef std::pair<std::string, std::vector<OcrChar> > GlyphEntry;
+      std::list<GlyphEntry> entries;
+      std::map<std::string, std::list<GlyphEntry>::iterator> index;
+
+      int64_t hits;
+      int64_t misses;
+      double miss_ms;
+
+      tthread::mutex cache_mutex;
+  };
+
+}
+
+#endif // OPENALPR_GLYPHCACHE_H
@@ -19,49 +19,299 @@
 
 #include "ocr.h"
 
+#include <algorithm>
+#include <sstream>
+
 namespace alpr
 {
+
+  // How often getOrder() puts the least recognized threshold first
+  const int THRESHOLD_EXPLORE_INTERVAL = 20;
+
+  ThresholdStats::ThresholdStats() {
+    this->plates_read = 0;
+    this->orders_given = 0;
+  }
+
+  // Thresholds that are equally useful (e.g., before any plates are read) keep their order
+  std::vector<int> ThresholdStats::getOrder(int threshold_count)
+  {
+    tthread::lock_guard<tthread::mutex> guard(stats_mutex);
+
+    if (threshold_needed.size() != threshold_count)
+    {
+      threshold_needed.assign(threshold_count, 0);
+      threshold_usefulness.assign(threshold_count, 0);
+      plates_read = 0;
+      orders_given = 0;
+    }
+
+    // Ranked by the average rather than the total, so that the thresholds recognized first don't stay
+    // ahead just because they're recognized for every plate
+    std::vector<std::pair<float, int> > ranked;
+    for (int i = 0; i < threshold_count; i++)
+    {
+      float average = threshold_needed[i] > 0 ? threshold_usefulness[i] / threshold_needed[i] : 0;
+      ranked.push_back(std::make_pair(-average, i));
+    }
+    std::sort(ranked.begin(), ranked.end());
+
+    std::vector<int> order;
+    for (unsigned int i = 0; i < ranked.size(); i++)
+      order.push_back(ranked[i].second);
+
+    // A threshold that early exit always skips would never be scored, so it could never move up.
+    // Now and then the one recognized for the fewest plates goes first (the lowest ranked on a tie)
+    orders_given++;
+    if (orders_given % THRESHOLD_EXPLORE_INTERVAL == 0)
+    {
+      int least_read = order.size() - 1;
+      for (int i = order.size() - 2; i >= 0; i--)
+      {
+        if (threshold_needed[order[i]] < threshold_needed[order[least_read]])
+          least_read = i;
+      }
+
+      int threshold = order[least_read];
+      order.erase(order.begin() + least_read);
+      order.insert(order.begin(), threshold);
+    }
+
+    return order;
+  }
+
+  void ThresholdStats::addPlate(const std::vector<int>& recognized_thresholds, const std::vector<float>& usefulness)
+  {
+    tthread::lock_guard<tthread::mutex> guard(stats_mutex);
+
+    if (threshold_needed.size() != usefulness.size())
+      return;
+
+    for (unsigned int i = 0; i < recognized_thresholds.size(); i++)
+      threshold_needed[recognized_thresholds[i]]++;
+    for (unsigned int i = 0; i < usefulness.size(); i++)
+      threshold_usefulness[i] += usefulness[i];
+    plates_read++;
+  }
+
+  std::string ThresholdStats::describe()
+  {
+    tthread::lock_guard<tthread::mutex> guard(stats_mutex);
+
+    std::stringstream ss;
+    for (unsigned int i = 0; i < threshold_needed.size(); i++)
+      ss << (i > 0 ? ", " : "") << "threshold " << i << " " << threshold_needed[i] << "/" << plates_read << " plates";
+
+    return ss.str();
+  }
+
   
   OCR::OCR(Config* config) : postProcessor(config) {
     this->config = config;
+    this->threshold_stats = &own_threshold_stats;
+  }
+
+  OCR::OCR(Config* config, RegexRuleSet* rules) : postProcessor(config, rules) {
+    this->config = config;
+    this->threshold_stats = &own_threshold_stats;
   }
 
 
   OCR::~OCR() {
   }
 
+  void OCR::setThresholdStats(ThresholdStats* threshold_stats)
+  {
+    this->threshold_stats = threshold_stats;
+  }
+
   
-  void OCR::performOCR(PipelineData* pipeline_data)
+  void OCR::performOCR(PipelineData* pipeline_data, ThreadPool* threadPool)
   {
     
     timespec startTime;
     getTimeMonotonic(&startTime);
 
     segment(pipeline_data);
+
+    timespec ocrStartTime;
+    getTimeMonotonic(&ocrStartTime);
+    pipeline_data->stage_timing.segmentation = diffclock(startTime, ocrStartTime);
     
     postProcessor.clear();
 
+    prepare_thresholds(pipeline_data);
+
+    int threshold_count = pipeline_data->thresholds.size();
+    bool early_exit = config->ocrThresholdEarlyExitMargin > 0 && threshold_count > 1;
+
+    // The thresholds are recognized in stages.  Without early exit, they're all recognized at once.
+    // With it, the most useful threshold goes first and the rest are only recognized if it leaves a 
+    // character in doubt.  With a thread pool, the rest are recognized together
+    std::vector<std::vector<int> > stages;
+    if (early_exit)
+    {
+      std::vector<int> order = threshold_stats->getOrder(threshold_count);
+      for (unsigned int i = 0; i < order.size(); i++)
+      {
+        if (i == 0 || threadPool == NULL)
+          stages.push_back(std::vector<int>());
+        stages.back().push_back(order[i]);
+      }
+    }
+    else
+    {
+      stages.push_back(std::vector<int>());
+      for (int threshold_idx = 0; threshold_idx < threshold_count; threshold_idx++)
+        stages.back().push_back(threshold_idx);
+    }
+
+    std::vector<OcrTask> recognized_tasks;
+    std::vector<int> recognized_thresholds;
+    for (unsigned int stage = 0; stage < stages.size(); stage++)
+    {
+      std::vector<OcrTask> tasks = recognizeThresholds(pipeline_data, stages[stage], threadPool);
+      addLetters(tasks);
+
+      recognized_tasks.insert(recognized_tasks.end(), tasks.begin(), tasks.end());
+      recognized_thresholds.insert(recognized_thresholds.end(), stages[stage].begin(), stages[stage].end());
+
+      if (early_exit && allLettersDominant(pipeline_data))
+        break;
+    }
+
+    if (early_exit)
+      threshold_stats->addPlate(recognized_thresholds, getThresholdUsefulness(recognized_tasks, threshold_count));
 
-    int absolute_charpos = 0;
+    timespec endTime;
+    getTimeMonotonic(&endTime);
+    pipeline_data->stage_timing.ocr = diffclock(ocrStartTime, endTime);
+
+    if (config->debugTiming)
+    {
+      std::cout << "OCR Time: " << diffclock(startTime, endTime) << "ms." << std::endl;
+
+      if (early_exit)
+      {
+        std::cout << "OCR thresholds recognized: " << recognized_thresholds.size() << " of " << threshold_count << ".  Needed for: ";
+        std::cout << threshold_stats->describe() << std::endl;
+      }
+      print_timing_details();
+    }
+  }
+
+  void OCR::recognizeLineTask(void* arg)
+  {
+    OcrTask* task = (OcrTask*) arg;
+
+    try
+    {
+      task->chars = task->ocr->recognize_line(task->line_index, task->threshold_index, task->pipeline_data);
+    }
+    catch (cv::Exception& e)
+    {
+      task->failed = true;
+      task->exception = e;
+    }
+    catch (std::exception& e)
+    {
+      task->error.record(e);
+    }
+  }
+
+  std::vector<OcrTask> OCR::recognizeThresholds(PipelineData* pipeline_data, std::vector<int> thresholds, ThreadPool* threadPool)
+  {
+    std::vector<OcrTask> tasks;
     for (unsigned int line_idx = 0; line_idx < pipeline_data->textLines.size(); line_idx++)
     {
-      std::vector<OcrChar> chars = recognize_line(line_idx, pipeline_data);
-      
+      for (unsigned int i = 0; i < thresholds.size(); i++)
+      {
+        OcrTask task;
+        task.ocr = this;
+        task.pipeline_data = pipeline_data;
+        task.line_index = line_idx;
+        task.threshold_index = thresholds[i];
+        task.failed = false;
+        tasks.push_back(task);
+      }
+    }
+
+    std::vector<void*> task_args;
+    for (unsigned int i = 0; i < tasks.size(); i++)
+      task_args.push_back(&tasks[i]);
+
+    // The debug output of each line is only readable when they run one at a time
+    if (threadPool != NULL && tasks.size() > 1 && !config->debugOcr)
+      threadPool->runAll(recognizeLineTask, task_args);
+    else
+    {
+      for (unsigned int i = 0; i < task_args.size(); i++)
+        recognizeLineTask(task_args[i]);
+    }
+
+    return tasks;
+  }
+
+  void OCR::addLetters(std::vector<OcrTask>& tasks)
+  {
+    // Line by line, then threshold by threshold, the same order as recognizing them one at a time
+    for (unsigned int t = 0; t < tasks.size(); t++)
+    {
+      if (tasks[t].failed)
+        throw tasks[t].exception;
+      tasks[t].error.rethrow();
+
+      int line_idx = tasks[t].line_index;
+      std::vector<OcrChar>& chars = tasks[t].chars;
       for (uint32_t i = 0; i < chars.size(); i++)
       {
         // For multi-line plates, set the character indexes to sequential values based on the line number
         int line_ordered_index = (line_idx * config->postProcessMaxCharacters) + chars[i].char_index;
         postProcessor.addLetter(chars[i].letter, line_idx, line_ordered_index, chars[i].confidence);
-        absolute_charpos++;
       }
     }
-    
+  }
 
-    if (config->debugTiming)
+  // True if every character box has a best letter that is ahead of the next best by the early exit margin
+  bool OCR::allLettersDominant(PipelineData* pipeline_data)
+  {
+    for (unsigned int line_idx = 0; line_idx < pipeline_data->charRegions.size(); line_idx++)
     {
-      timespec endTime;
-      getTimeMonotonic(&endTime);
-      std::cout << "OCR Time: " << diffclock(startTime, endTime) << "ms." << std::endl;
+      for (unsigned int j = 0; j < pipeline_data->charRegions[line_idx].size(); j++)
+      {
+        int line_ordered_index = (line_idx * config->postProcessMaxCharacters) + j;
+
+        std::string letter;
+        float margin;
+        if (!postProcessor.getBestLetter(line_ordered_index, letter, margin))
+          return false;
+        if (margin < config->ocrThresholdEarlyExitMargin)
+          return false;
+      }
     }
+
+    return true;
+  }
+
+  // The confidence each threshold gave to the letters that ended up the best at each position
+  std::vector<float> OCR::getThresholdUsefulness(std::vector<OcrTask>& tasks, int threshold_count)
+  {
+    std::vector<float> usefulness(threshold_count, 0);
+
+    for (unsigned int t = 0; t < tasks.size(); t++)
+    {
+      std::vector<OcrChar>& chars = tasks[t].chars;
+      for (unsigned int i = 0; i < chars.size(); i++)
+      {
+        int line_ordered_index = (tasks[t].line_index * config->postProcessMaxCharacters) + chars[i].char_index;
+
+        std::string best_letter;
+        float margin;
+        if (postProcessor.getBestLetter(line_ordered_index, best_letter, margin) && best_letter == chars[i].letter)
+          usefulness[tasks[t].threshold_index] += chars[i].confidence;
+      }
+    }
+
+    return usefulness;
   }
 }
\ No newline at end of file
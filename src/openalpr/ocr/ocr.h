@@ -22,6 +22,7 @@
 
 #include "postprocess/postprocess.h"
 #include "pipeline_data.h"
+#include "support/threadpool.h"
 
 namespace alpr
 {
@@ -31,22 +32,99 @@ namespace alpr
     int char_index;
     float confidence;
   };
+
+  class OCR;
+
+  // For ocr_threshold_early_exit_margin.  The number of plates each threshold was recognized for, and
+  // the total confidence it gave to the letters that were chosen.  An OcrPool shares one with all of
+  // its OCR instances, so every instance learns the same order
+  class ThresholdStats
+  {
+    public:
+      ThresholdStats();
+
+      // Most useful first, by the average confidence per plate the threshold was recognized for.
+      // Every 20th order puts the threshold recognized for the fewest plates first instead
+      std::vector<int> getOrder(int threshold_count);
+
+      // Records one plate.  usefulness has an entry for every threshold
+      void addPlate(const std::vector<int>& recognized_thresholds, const std::vector<float>& usefulness);
+
+      // "threshold 0 12/20 plates, threshold 1 3/20 plates, ..."
+      std::string describe();
+
+    private:
+      std::vector<int> threshold_needed;
+      std::vector<float> threshold_usefulness;
+      int plates_read;
+      int orders_given;
+
+      tthread::mutex stats_mutex;
+
+      ThresholdStats(const ThresholdStats&);
+      ThresholdStats& operator=(const ThresholdStats&);
+  };
+
+  // One line of text in one threshold image, recognized by OCR::performOCR()
+  struct OcrTask
+  {
+    OCR* ocr;
+    PipelineData* pipeline_data;
+    int line_index;
+    int threshold_index;
+
+    std::vector<OcrChar> chars;
+
+    // Anything recognize_line() throws on a pool thread is kept here and rethrown on the calling thread.
+    // A cv::Exception is kept as is
+    bool failed;
+    cv::Exception exception;
+    TaskError error;
+  };
   
   class OCR {
   public:
     OCR(Config* config);
+    OCR(Config* config, RegexRuleSet* rules);
     virtual ~OCR();
 
-    void performOCR(PipelineData* pipeline_data);
+    // Every line of text in every threshold image is recognized separately.  If a thread pool is given,
+    // they are recognized at the same time.  The letters are added to the post processor in the same
+    // order either way.
+    // With ocr_threshold_early_exit_margin, the thresholds are recognized in order of how useful they
+    // have been, and the rest are skipped once every character has a clear best letter
+    void performOCR(PipelineData* pipeline_data, ThreadPool* threadPool = NULL);
+
+    // Learn the threshold order together with other instances.  Not owned.  Each instance keeps its own by default
+    void setThresholdStats(ThresholdStats* threshold_stats);
 
     PostProcess postProcessor;
 
   protected:
-    virtual std::vector<OcrChar> recognize_line(int line_index, PipelineData* pipeline_data)=0;
+    // Called from several threads at once when performOCR() is given a thread pool
+    virtual std::vector<OcrChar> recognize_line(int line_index, int threshold_index, PipelineData* pipeline_data)=0;
     virtual void segment(PipelineData* pipeline_data)=0;
+
+    // Called after segmenting and before recognizing any lines.  May change the threshold images
+    virtual void prepare_thresholds(PipelineData* pipeline_data) {}
+
+    // Prints any extra details after the OCR time when debug_timing is on
+    virtual void print_timing_details() {}
+
+    static void recognizeLineTask(void* arg);
     
     Config* config;
 
+  private:
+    ThresholdStats own_threshold_stats;
+    ThresholdStats* threshold_stats;
+
+    std::vector<OcrTask> recognizeThresholds(PipelineData* pipeline_data, std::vector<int> thresholds, ThreadPool* threadPool);
+    void addLetters(std::vector<OcrTask>& tasks);
+    bool allLettersDominant(PipelineData* pipeline_data);
+
+    std::vector<float> getThresholdUsefulness(std::vector<OcrTask>& tasks, int threshold_count);
+
   };
 }
 
@@ -1,12 +1,24 @@
 #include "ocrfactory.h"
 #include "tesseract_ocr.h"
+#include "classifier_ocr.h"
 
 namespace alpr
 {
   OCR* createOcr(Config* config)
   {
+    if (config->ocrEngine == OCR_CLASSIFIER)
+      return new ClassifierOcr(config);
+
     return new TesseractOcr(config);
   }
 
+  OCR* createOcr(Config* config, RegexRuleSet* rules)
+  {
+    if (config->ocrEngine == OCR_CLASSIFIER)
+      return new ClassifierOcr(config, rules);
+
+    return new TesseractOcr(config, rules);
+  }
+
 }
 
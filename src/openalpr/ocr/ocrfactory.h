@@ -27,6 +27,7 @@ namespace alpr
 {
 
   OCR* createOcr(Config* config);
+  OCR* createOcr(Config* config, RegexRuleSet* rules);
 
 }
 #endif	/* OPENALPR_DETECTORFACTORY_H */
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <sstream>
+
+#include "ocrpool.h"
+#include "ocrfactory.h"
+#include "support/filesystem.h"
+
+namespace alpr
+{
+
+  OcrPool::OcrPool(Config* config)
+  {
+    this->config = config;
+
+    // The rules depend on the letters and numbers used to expand the patterns as well as the file
+    std::stringstream patterns_file;
+    patterns_file << config->getPostProcessRuntimeDir() << "/" << config->country << ".patterns";
+    std::string key = ModelRegistry::getKey("patterns", patterns_file.str(), config->postProcessRegexLetters + "|" + config->postProcessRegexNumbers);
+
+    shared_rules = (SharedObject<RegexRuleSet>*) ModelRegistry::acquire(key);
+    if (shared_rules == NULL)
+    {
+      SharedObject<RegexRuleSet>* new_rules = new SharedObject<RegexRuleSet>(new RegexRuleSet(config));
+      shared_rules = (SharedObject<RegexRuleSet>*) ModelRegistry::add(key, new_rules, getFileInfo(patterns_file.str()).size);
+    }
+    this->rules = shared_rules->object;
+
+    // Load the first instance up front so that configuration problems show up at startup
+    OCR* first_ocr = createOcr(config, rules);
+    first_ocr->setThresholdStats(&threshold_stats);
+    all_ocr.push_back(first_ocr);
+    available_ocr.push_back(first_ocr);
+  }
+
+  OcrPool::~OcrPool()
+  {
+    for (unsigned int i = 0; i < all_ocr.size(); i++)
+      delete all_ocr[i];
+
+    ModelRegistry::release(shared_rules);
+  }
+
+  OCR* OcrPool::acquire()
+  {
+    {
+      tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+
+      if (available_ocr.size() > 0)
+      {
+        OCR* ocr = available_ocr.back();
+        available_ocr.pop_back();
+        return ocr;
+      }
+    }
+
+    // Every instance is busy.  Initialize a new one outside of the lock, since loading the
+    // OCR training data is slow
+    OCR* ocr = createOcr(config, rules);
+    ocr->setThresholdStats(&threshold_stats);
+
+    tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+    all_ocr.push_back(ocr);
+
+    if (config->debugGeneral)
+      std::cout << "Added OCR instance to the pool for " << config->country << " (" << all_ocr.size() << " total)" << std::endl;
+
+    return ocr;
+  }
+
+  void OcrPool::release(OCR* ocr)
+  {
+    tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+    available_ocr.push_back(ocr);
+  }
+
+  RegexRuleSet* OcrPool::getRules()
+  {
+    return rules;
+  }
+
+  int OcrPool::size()
+  {
+    tthread::lock_guard<tthread::mutex> guard(pool_mutex);
+    return all_ocr.size();
+  }
+
+}
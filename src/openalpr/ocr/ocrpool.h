@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_OCRPOOL_H
+#define	OPENALPR_OCRPOOL_H
+
+#include <vector>
+
+#include "config.h"
+#include "ocr.h"
+#include "modelregistry.h"
+#include "postprocess/regexruleset.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  // Lends out OCR instances for a single country.
+  // An OCR instance holds the per-plate scratch state (the Tesseract handle and the
+  // post processor letters), so it can only be used by one thread at a time.  The
+  // pattern rules are loaded once and shared read-only by every instance in the pool, and
+  // by any other pool in the process that uses the same patterns file.
+  // New instances are only created when all of the existing ones are in use.
+  class OcrPool
+  {
+    public:
+      OcrPool(Config* config);
+      virtual ~OcrPool();
+
+      // Borrow an OCR instance.  Must be handed back with release()
+      OCR* acquire();
+      void release(OCR* ocr);
+
+      RegexRuleSet* getRules();
+
+      // Total number of OCR instances created so far
+      int size();
+
+    private:
+      Config* config;
+      SharedObject<RegexRuleSet>* shared_rules;
+      RegexRuleSet* rules;
+
+      std::vector<OCR*> all_ocr;
+      std::vector<OCR*> available_ocr;
+
+      // Shared by every instance, so the threshold order and the debug_timing report cover all of them
+      ThresholdStats threshold_stats;
+
+      tthread::mutex pool_mutex;
+  };
+
+  // Borrows an OCR instance from the pool for the lifetime of the object
+  class ScopedOcr
+  {
+    public:
+      ScopedOcr(OcrPool* pool) { this->pool = pool; this->ocr = pool->acquire(); }
+      ~ScopedOcr() { pool->release(ocr); }
+
+      OCR* operator->() { return ocr; }
+      OCR* get() { return ocr; }
+
+    private:
+      OcrPool* pool;
+      OCR* ocr;
+
+      ScopedOcr(const ScopedOcr&);
+      ScopedOcr& operator=(const ScopedOcr&);
+  };
+
+}
+
+#endif	/* OPENALPR_OCRPOOL_H */
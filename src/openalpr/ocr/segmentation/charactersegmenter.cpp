@@ -43,7 +43,7 @@ namespace alpr
     if (pipeline_data->plate_inverted)
       bitwise_not(pipeline_data->crop_gray, pipeline_data->crop_gray);
     pipeline_data->clearThresholds();
-    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config);
+    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config, pipeline_data->mat_pool);
 
     // TODO: Perhaps a bilateral filter would be better here.
     medianBlur(pipeline_data->crop_gray, pipeline_data->crop_gray, 3);
@@ -64,7 +64,7 @@ namespace alpr
       displayImage(config, "CharacterSegmenter  Thresholds", drawImageDashboard(pipeline_data->thresholds, CV_8U, 3));
     }
 
-    Mat edge_filter_mask = Mat::zeros(pipeline_data->thresholds[0].size(), CV_8U);
+    Mat edge_filter_mask = pipeline_data->borrowZeros(pipeline_data->thresholds[0].size(), CV_8U);
     bitwise_not(edge_filter_mask, edge_filter_mask);
 
     for (unsigned int lineidx = 0; lineidx < pipeline_data->textLines.size(); lineidx++)
@@ -95,7 +95,7 @@ namespace alpr
       vector<Rect> lineBoxes;
       for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
       {
-        Mat histogramMask = Mat::zeros(pipeline_data->thresholds[i].size(), CV_8U);
+        Mat histogramMask = pipeline_data->borrowZeros(pipeline_data->thresholds[i].size(), CV_8U);
 
         fillConvexPoly(histogramMask, pipeline_data->textLines[lineidx].linePolygon.data(), pipeline_data->textLines[lineidx].linePolygon.size(), Scalar(255,255,255));
 
@@ -103,9 +103,8 @@ namespace alpr
 
 //        if (this->config->debugCharSegmenter)
 //        {
-//          Mat histoCopy(vertHistogram.histoImg.size(), vertHistogram.histoImg.type());
-//          //vertHistogram.copyTo(histoCopy);
-//          cvtColor(vertHistogram.histoImg, histoCopy, CV_GRAY2RGB);
+//          Mat histoCopy;
+//          cvtColor(vertHistogram.getHistogramImage(), histoCopy, CV_GRAY2RGB);
 //
 //          string label = "threshold: " + toString(i);
 //          allHistograms.push_back(addLabel(histoCopy, label));
@@ -147,7 +146,7 @@ namespace alpr
         // Setup the dashboard images to show the cleaning filters
         for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
         {
-          Mat cleanImg = Mat::zeros(pipeline_data->thresholds[i].size(), pipeline_data->thresholds[i].type());
+          Mat cleanImg = pipeline_data->borrowZeros(pipeline_data->thresholds[i].size(), pipeline_data->thresholds[i].type());
           Mat boxMask = getCharBoxMask(pipeline_data->thresholds[i], candidateBoxes);
           pipeline_data->thresholds[i].copyTo(cleanImg);
           bitwise_and(cleanImg, boxMask, cleanImg);
@@ -245,8 +244,9 @@ namespace alpr
       }
       else if (allBoxes[i].width > avgCharWidth * 2 && allBoxes[i].width < MAX_SEGMENT_WIDTH * 2 && allBoxes[i].height > MIN_HISTOGRAM_HEIGHT)
       {
-        //    rectangle(histogram.histoImg, allBoxes[i], Scalar(255, 0, 0) );
-        //    drawAndWait(&histogram.histoImg);
+        //    Mat histoImg = histogram.getHistogramImage();
+        //    rectangle(histoImg, allBoxes[i], Scalar(255, 0, 0) );
+        //    drawAndWait(&histoImg);
         // Try to split up doubles into two good char regions, check for a break between 40% and 60%
         int leftEdge = allBoxes[i].x + (int) (((float) allBoxes[i].width) * 0.4f);
         int rightEdge = allBoxes[i].x + (int) (((float) allBoxes[i].width) * 0.6f);
@@ -284,13 +284,11 @@ namespace alpr
     // This histogram is based on how many char boxes (from ALL of the many thresholded images) are covering each column
     // Makes a sort of histogram from all the previous char boxes.  Figures out the best fit from that.
 
-    Mat histoImg = Mat::zeros(Size(img.cols, img.rows), CV_8U);
-
-    int columnCount;
+    vector<int> colHeights(img.cols, 0);
 
     for (int col = 0; col < img.cols; col++)
     {
-      columnCount = 0;
+      int columnCount = 0;
 
       for (unsigned int i = 0; i < charBoxes.size(); i++)
       {
@@ -298,20 +296,19 @@ namespace alpr
           columnCount++;
       }
 
-      // Fill the line of the histogram
-      for (; columnCount > 0; columnCount--)
-        histoImg.at<uchar>(histoImg.rows -  columnCount, col) = 255;
+      // The histogram is no taller than the image
+      colHeights[col] = std::min(columnCount, img.rows);
     }
 
-    HistogramVertical histogram(histoImg, Mat::ones(histoImg.size(), CV_8U));
+    HistogramVertical histogram(colHeights);
 
-    // Go through each row in the histoImg and score it.  Try to find the single line that gives me the most right-sized character regions (based on avgCharWidth)
+    // Go through each row in the histogram and score it.  Try to find the single line that gives me the most right-sized character regions (based on avgCharWidth)
 
     int bestRowIndex = 0;
     float bestRowScore = 0;
     vector<Rect> bestBoxes;
 
-    for (int row = 0; row < histogram.histoImg.rows; row++)
+    for (int row = 0; row < histogram.getMaxHeight(); row++)
     {
       vector<Rect> validBoxes;
       
@@ -376,6 +373,7 @@ namespace alpr
 
     if (this->config->debugCharSegmenter)
     {
+      Mat histoImg = histogram.getHistogramImage();
       cvtColor(histoImg, histoImg, CV_GRAY2BGR);
       line(histoImg, Point(0, histoImg.rows - 1 - bestRowIndex), Point(histoImg.cols, histoImg.rows - 1 - bestRowIndex), Scalar(0, 255, 0));
 
@@ -398,14 +396,14 @@ namespace alpr
     //const float MIN_CHAR_AREA = 0.02 * avgCharWidth * avgCharHeight;	// To clear out the tiny specks
     const float MIN_CONTOUR_HEIGHT = config->segmentationMinSpeckleHeightPercent * avgCharHeight;
 
-    Mat textLineMask = Mat::zeros(thresholds[0].size(), CV_8U);
+    Mat textLineMask = pipeline_data->borrowZeros(thresholds[0].size(), CV_8U);
     fillConvexPoly(textLineMask, textLine.linePolygon.data(), textLine.linePolygon.size(), Scalar(255,255,255));
 
     for (unsigned int i = 0; i < thresholds.size(); i++)
     {
       vector<vector<Point> > contours;
       vector<Vec4i> hierarchy;
-      Mat thresholdsCopy = Mat::zeros(thresholds[i].size(), thresholds[i].type());
+      Mat thresholdsCopy = pipeline_data->borrowZeros(thresholds[i].size(), thresholds[i].type());
 
       thresholds[i].copyTo(thresholdsCopy, textLineMask);
       findContours(thresholdsCopy, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
@@ -649,7 +647,7 @@ namespace alpr
     {
       for (unsigned int j = 0; j < charRegions.size(); j++)
       {
-        Mat boxChar = Mat::zeros(thresholds[i].size(), CV_8U);
+        Mat boxChar = pipeline_data->borrowZeros(thresholds[i].size(), CV_8U);
         rectangle(boxChar, charRegions[j], Scalar(255,255,255), CV_FILLED);
 
         bitwise_and(thresholds[i], boxChar, boxChar);
@@ -712,7 +710,7 @@ namespace alpr
       {
         //float minArea = charRegions[j].area() * MIN_AREA_PERCENT;
 
-        Mat tempImg = Mat::zeros(thresholds[i].size(), thresholds[i].type());
+        Mat tempImg = pipeline_data->borrowZeros(thresholds[i].size(), thresholds[i].type());
         rectangle(tempImg, charRegions[j], Scalar(255,255,255), CV_FILLED);
         bitwise_and(thresholds[i], tempImg, tempImg);
 
@@ -799,7 +797,7 @@ namespace alpr
     if (alternate < MIN_CONNECTED_EDGE_PIXELS && alternate > avgCharHeight)
       MIN_CONNECTED_EDGE_PIXELS = alternate;
 
-    Mat empty_mask = Mat::zeros(thresholds[0].size(), CV_8U);
+    Mat empty_mask = pipeline_data->borrowZeros(thresholds[0].size(), CV_8U);
     bitwise_not(empty_mask, empty_mask);
     
     //
@@ -897,7 +895,7 @@ namespace alpr
 
     if (leftEdge != 0 || rightEdge != thresholds[0].cols)
     {
-      Mat mask = Mat::zeros(thresholds[0].size(), CV_8U);
+      Mat mask = pipeline_data->borrowZeros(thresholds[0].size(), CV_8U);
       bitwise_not(mask, mask);
       
       rectangle(mask, Point(0, charRegions[0].y), Point(leftEdge, charRegions[0].y+charRegions[0].height), Scalar(0,0,0), -1);
@@ -1012,7 +1010,7 @@ namespace alpr
       MIN_EDGE_CONTOUR_HEIGHT = alternate;
 
     Rect slightlySmallerBox(box.x, box.y, box.width, box.height);
-    Mat boxMask = Mat::zeros(threshold.size(), CV_8U);
+    Mat boxMask = pipeline_data->borrowZeros(threshold.size(), CV_8U);
     rectangle(boxMask, slightlySmallerBox, Scalar(255, 255, 255), -1);
 
     for (unsigned int i = 0; i < contours.size(); i++)
@@ -1021,7 +1019,7 @@ namespace alpr
       if (boundingRect(contours[i]).height < MIN_EDGE_CONTOUR_HEIGHT)
         continue;
 
-      Mat tempImg = Mat::zeros(threshold.size(), CV_8U);
+      Mat tempImg = pipeline_data->borrowZeros(threshold.size(), CV_8U);
       drawContours(tempImg, contours, i, Scalar(255,255,255), -1, 8, hierarchy, 1);
       bitwise_and(tempImg, boxMask, tempImg);
 
@@ -1061,7 +1059,7 @@ namespace alpr
 
   Mat CharacterSegmenter::getCharBoxMask(Mat img_threshold, vector<Rect> charBoxes)
   {
-    Mat mask = Mat::zeros(img_threshold.size(), CV_8U);
+    Mat mask = pipeline_data->borrowZeros(img_threshold.size(), CV_8U);
     for (unsigned int i = 0; i < charBoxes.size(); i++)
       rectangle(mask, charBoxes[i], Scalar(255, 255, 255), -1);
 
@@ -19,92 +19,205 @@
 
 #include "histogram.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OPENALPR_HISTOGRAM_SSE2
+#endif
+
 using namespace cv;
 using namespace std;
 
 namespace alpr
 {
 
-  Histogram::Histogram()
-  {
+  static bool reference_mode = false;
 
-  }
-  
-  Histogram::~Histogram()
+#ifdef OPENALPR_HISTOGRAM_SSE2
+  // 0xFF for each of the 16 pixels that is on in both the image and the mask, 0 otherwise
+  static inline __m128i bothOn(const uchar* image, const uchar* mask)
   {
-    histoImg.release();
-    colHeights.clear();
+    __m128i zero = _mm_setzero_si128();
+    __m128i image_off = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) image), zero);
+    __m128i mask_off = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) mask), zero);
+    return _mm_andnot_si128(_mm_or_si128(image_off, mask_off), _mm_cmpeq_epi8(zero, zero));
   }
+#endif
 
-  void Histogram::analyzeImage(cv::Mat inputImage, cv::Mat mask, bool use_y_axis)
+  // Counts the pixels that are on in both images for each column.  The image is read a row at a time.
+  // Each column is counted in a byte for up to 255 rows, so 16 columns can be counted at once
+  static void countColumns(const Mat& image, const Mat& mask, vector<int>& counts)
   {
+    const int BLOCK_ROWS = 255;
+    int cols = image.cols;
 
-    int max_col_size = 0;
+    counts.assign(cols, 0);
+    if (cols == 0)
+      return;
 
-    int columnCount;
+    vector<uchar> block_counts(cols);
+    uchar* block = &block_counts[0];
 
-    if (use_y_axis)
+    for (int block_start = 0; block_start < image.rows; block_start += BLOCK_ROWS)
     {
-      // Calculate the histogram for vertical stripes
-      for (int col = 0; col < inputImage.cols; col++)
+      int block_end = std::min(image.rows, block_start + BLOCK_ROWS);
+      std::fill(block_counts.begin(), block_counts.end(), 0);
+
+      for (int row = block_start; row < block_end; row++)
       {
-        columnCount = 0;
+        const uchar* image_row = image.ptr<uchar>(row);
+        const uchar* mask_row = mask.ptr<uchar>(row);
 
-        for (int row = 0; row < inputImage.rows; row++)
+        int col = 0;
+#ifdef OPENALPR_HISTOGRAM_SSE2
+        for (; col + 16 <= cols; col += 16)
         {
-          if (inputImage.at<uchar>(row, col) > 0 && mask.at<uchar>(row, col) > 0)
-            columnCount++;
+          // Subtracting 0xFF (-1) adds one to each column that is on
+          __m128i block_count = _mm_loadu_si128((const __m128i*) (block + col));
+          block_count = _mm_sub_epi8(block_count, bothOn(image_row + col, mask_row + col));
+          _mm_storeu_si128((__m128i*) (block + col), block_count);
         }
+#endif
+        for (; col < cols; col++)
+        {
+          if (image_row[col] > 0 && mask_row[col] > 0)
+            block[col]++;
+        }
+      }
+
+      for (int col = 0; col < cols; col++)
+        counts[col] += block[col];
+    }
+  }
+
+  // Counts the pixels that are on in both images for each row
+  static void countRows(const Mat& image, const Mat& mask, vector<int>& counts)
+  {
+    int cols = image.cols;
 
-        this->colHeights.push_back(columnCount);
+    counts.assign(image.rows, 0);
 
-        if (columnCount > max_col_size)
-          max_col_size = columnCount;
+    for (int row = 0; row < image.rows; row++)
+    {
+      const uchar* image_row = image.ptr<uchar>(row);
+      const uchar* mask_row = mask.ptr<uchar>(row);
+
+      int count = 0;
+      int col = 0;
+#ifdef OPENALPR_HISTOGRAM_SSE2
+      __m128i zero = _mm_setzero_si128();
+      __m128i one = _mm_set1_epi8(1);
+      __m128i total = zero;
+      for (; col + 16 <= cols; col += 16)
+      {
+        // Adds up the 16 ones and zeros into the two 64 bit halves of the total
+        __m128i on = _mm_and_si128(bothOn(image_row + col, mask_row + col), one);
+        total = _mm_add_epi64(total, _mm_sad_epu8(on, zero));
+      }
+      count = _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+#endif
+      for (; col < cols; col++)
+      {
+        if (image_row[col] > 0 && mask_row[col] > 0)
+          count++;
       }
+
+      counts[row] = count;
     }
-    else
+  }
+
+
+  // Reads one pixel at a time, a column at a time, and draws the histogram image that the heights used to be read from
+  static void countReference(const Mat& image, const Mat& mask, bool use_y_axis, vector<int>& counts)
+  {
+    counts.clear();
+    int max_height = 0;
+
+    int outer = use_y_axis ? image.cols : image.rows;
+    int inner = use_y_axis ? image.rows : image.cols;
+    for (int i = 0; i < outer; i++)
     {
-      // Calculate the histogram for horizontal stripes
-      for (int row = 0; row < inputImage.rows; row++)
+      int count = 0;
+      for (int j = 0; j < inner; j++)
       {
-        columnCount = 0;
+        int row = use_y_axis ? j : i;
+        int col = use_y_axis ? i : j;
+        if (image.at<uchar>(row, col) > 0 && mask.at<uchar>(row, col) > 0)
+          count++;
+      }
+      counts.push_back(count);
+      max_height = std::max(max_height, count);
+    }
 
-        for (int col = 0; col < inputImage.cols; col++)
-        {
-          if (inputImage.at<uchar>(row, col) > 0 && mask.at<uchar>(row, col) > 0)
-            columnCount++;
-        }
+    Mat histoImg = Mat::zeros(Size(counts.size(), max_height + 10), CV_8U);
+    for (unsigned int col = 0; col < counts.size(); col++)
+    {
+      for (int count = counts[col]; count > 0; count--)
+        histoImg.at<uchar>(histoImg.rows - count, col) = 255;
+    }
+  }
 
-        this->colHeights.push_back(columnCount);
+  void Histogram::setReferenceMode(bool reference)
+  {
+    reference_mode = reference;
+  }
 
-        if (columnCount > max_col_size)
-          max_col_size = columnCount;
-      }
+  Histogram::Histogram()
+  {
+    max_height = 0;
+  }
+  
+  Histogram::~Histogram()
+  {
+    colHeights.clear();
+  }
+
+  void Histogram::analyzeImage(cv::Mat inputImage, cv::Mat mask, bool use_y_axis)
+  {
+    vector<int> heights;
+
+    if (reference_mode)
+      countReference(inputImage, mask, use_y_axis, heights);
+    else if (use_y_axis)
+      countColumns(inputImage, mask, heights);    // Vertical stripes
+    else
+      countRows(inputImage, mask, heights);       // Horizontal stripes
+
+    setHeights(heights);
+  }
+
+  void Histogram::setHeights(std::vector<int> heights)
+  {
+    this->colHeights = heights;
+
+    max_height = 0;
+    for (unsigned int i = 0; i < colHeights.size(); i++)
+    {
+      if (colHeights[i] > max_height)
+        max_height = colHeights[i];
     }
-    
-    
+  }
+
+  Mat Histogram::getHistogramImage()
+  {
     int histo_width = this->colHeights.size();
-    int histo_height = max_col_size + 10;
+    int histo_height = max_height + 10;
         
-    histoImg = Mat::zeros(Size(histo_width, histo_height), CV_8U);
+    Mat histoImg = Mat::zeros(Size(histo_width, histo_height), CV_8U);
     
     // Draw the columns onto an Mat image
-    for (unsigned int col = 0; col < histoImg.cols; col++)
+    for (int col = 0; col < histo_width; col++)
     {
-      if (col >= this->colHeights.size())
-        break;
-      
       int columnCount = this->colHeights[col];
       for (; columnCount > 0; columnCount--)
         histoImg.at<uchar>(histo_height - columnCount, col) = 255;
     }
 
-    
+    return histoImg;
   }
 
   int Histogram::getLocalMinimum(int leftX, int rightX)
   {
-    int minimum = histoImg.rows + 1;
+    int minimum = max_height + 1;
     int lowestX = leftX;
 
     for (int i = leftX; i <= rightX; i++)
@@ -140,6 +253,11 @@ namespace alpr
   {
     return colHeights[x];
   }
+
+  int Histogram::getMaxHeight()
+  {
+    return max_height;
+  }
   
   
 
@@ -230,9 +348,11 @@ namespace alpr
     
     bool onSegment = false;
     int curSegmentLength = 0;
-    for (int col = 0; col < histoImg.cols; col++)
+    int histo_width = colHeights.size();
+    for (int col = 0; col < histo_width; col++)
     {
-      bool isOn = histoImg.at<uchar>(histoImg.rows - 1 - yOffset, col);
+      // The same as the pixel yOffset rows above the bottom of the histogram image
+      bool isOn = colHeights[col] > yOffset;
       if (isOn)
       {
         // We're on a segment.  Increment the length
@@ -240,7 +360,7 @@ namespace alpr
         curSegmentLength++;
       }
 
-      if (onSegment && (isOn == false || (col == histoImg.cols - 1)))
+      if (onSegment && (isOn == false || (col == histo_width - 1)))
       {
         
         // A segment just ended or we're at the very end of the row and we're on a segment
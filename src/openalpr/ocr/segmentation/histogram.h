@@ -32,7 +32,12 @@ namespace alpr
     Histogram();
     virtual ~Histogram();
 
-    cv::Mat histoImg;
+    // For benchmarks.  Histograms created afterwards read each pixel with at<>(), column by column, and draw
+    // the histogram image, the way they were made before they were vectorized.  Not thread safe
+    static void setReferenceMode(bool reference);
+
+    // Draws the histogram as white bars.  Only used for debugging, so it's drawn on request
+    cv::Mat getHistogramImage();
 
     // Returns the lowest X position between two points.
     int getLocalMinimum(int leftX, int rightX);
@@ -40,15 +45,19 @@ namespace alpr
     int getLocalMaximum(int leftX, int rightX);
 
     int getHeightAt(int x);
+    int getMaxHeight();
 
     std::vector<std::pair<int, int> > get1DHits(int yOffset);
 
   protected:
 
     std::vector<int> colHeights;
+    int max_height;
 
-
+    // Counts the pixels that are on in both the image and the mask, for each column (use_y_axis) or each row.
+    // Both must be CV_8U
     void analyzeImage(cv::Mat inputImage, cv::Mat mask, bool use_y_axis);
+    void setHeights(std::vector<int> heights);
 
     int detect_peak(const double *data, int data_count, int *emi_peaks,
                     int *num_emi_peaks, int max_emi_peaks, int *absop_peaks,
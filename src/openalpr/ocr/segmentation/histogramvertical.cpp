@@ -30,6 +30,11 @@ namespace alpr
     analyzeImage(inputImage, mask, true);
   }
 
+  HistogramVertical::HistogramVertical(vector<int> colHeights)
+  {
+    setHeights(colHeights);
+  }
+
 
 
 
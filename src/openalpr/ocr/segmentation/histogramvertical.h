@@ -34,6 +34,8 @@ namespace alpr
 
   public:
     HistogramVertical(cv::Mat inputImage, cv::Mat mask);
+    // A histogram of heights that were already counted
+    HistogramVertical(std::vector<int> colHeights);
 
 
   };
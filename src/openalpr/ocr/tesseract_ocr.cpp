@@ -31,127 +31,431 @@ namespace alpr
 
   TesseractOcr::TesseractOcr(Config* config)
   : OCR(config)
+  {
+    init();
+  }
+
+  TesseractOcr::TesseractOcr(Config* config, RegexRuleSet* rules)
+  : OCR(config, rules)
+  {
+    init();
+  }
+
+  TesseractHandlePool::TesseractHandlePool(std::string tessdata_prefix, std::string language)
+  {
+    this->tessdata_prefix = tessdata_prefix;
+    this->language = language;
+
+    this->copy_failed = false;
+
+    // Initialize the first handle up front so that configuration problems show up at startup
+    bool initialized;
+    tesseract::TessBaseAPI* first_handle = createHandle(initialized);
+    if (!initialized)
+      std::cerr << "Error initializing Tesseract with language " << language << " from " << tessdata_prefix << endl;
+
+    all_handles.push_back(first_handle);
+    available_handles.push_back(first_handle);
+  }
+
+  TesseractHandlePool::~TesseractHandlePool()
+  {
+    for (unsigned int i = 0; i < all_handles.size(); i++)
+    {
+      all_handles[i]->End();
+      delete all_handles[i];
+    }
+  }
+
+  tesseract::TessBaseAPI* TesseractHandlePool::createHandle(bool& initialized)
   {
     const string MINIMUM_TESSERACT_VERSION = "3.03";
 
-    this->postProcessor.setConfidenceThreshold(config->postProcessMinConfidence, config->postProcessConfidenceSkipLevel);
-    
-    if (cmpVersion(tesseract.Version(), MINIMUM_TESSERACT_VERSION.c_str()) < 0)
+    tesseract::TessBaseAPI* handle = new tesseract::TessBaseAPI();
+
+    if (cmpVersion(handle->Version(), MINIMUM_TESSERACT_VERSION.c_str()) < 0)
     {
       std::cerr << "Warning: You are running an unsupported version of Tesseract." << endl;
-      std::cerr << "Expecting at least " << MINIMUM_TESSERACT_VERSION << ", your version is: " << tesseract.Version() << endl;
+      std::cerr << "Expecting at least " << MINIMUM_TESSERACT_VERSION << ", your version is: " << handle->Version() << endl;
     }
 
     // Tesseract requires the prefix directory to be set as an env variable
-    tesseract.Init(config->getTessdataPrefix().c_str(), config->ocrLanguage.c_str() 	);
-    tesseract.SetVariable("save_blob_choices", "T");
-    tesseract.SetVariable("debug_file", "/dev/null");
-    tesseract.SetPageSegMode(PSM_SINGLE_CHAR);
+    initialized = handle->Init(tessdata_prefix.c_str(), language.c_str() 	) == 0;
+    handle->SetVariable("save_blob_choices", "T");
+    handle->SetVariable("debug_file", "/dev/null");
+    handle->SetPageSegMode(PSM_SINGLE_CHAR);
+
+    return handle;
+  }
+
+  tesseract::TessBaseAPI* TesseractHandlePool::acquire()
+  {
+    bool create_copy;
+    {
+      tthread::lock_guard<tthread::mutex> guard(handle_mutex);
+
+      if (available_handles.size() > 0)
+      {
+        tesseract::TessBaseAPI* handle = available_handles.back();
+        available_handles.pop_back();
+        return handle;
+      }
+
+      create_copy = !copy_failed;
+    }
+
+    // Loading the training data is slow, so do it outside of the lock
+    tesseract::TessBaseAPI* handle = NULL;
+    if (create_copy)
+    {
+      bool initialized;
+      handle = createHandle(initialized);
+      if (!initialized)
+      {
+        std::cerr << "Error initializing another Tesseract handle with language " << language << endl;
+        handle->End();
+        delete handle;
+        handle = NULL;
+      }
+    }
+
+    tthread::lock_guard<tthread::mutex> guard(handle_mutex);
+
+    if (handle != NULL)
+    {
+      all_handles.push_back(handle);
+      return handle;
+    }
+
+    // Stop creating handles after a failure and wait for one of the existing handles instead
+    copy_failed = true;
+    while (available_handles.size() == 0)
+      handle_released.wait(handle_mutex);
+
+    handle = available_handles.back();
+    available_handles.pop_back();
+    return handle;
+  }
+
+  void TesseractHandlePool::release(tesseract::TessBaseAPI* handle)
+  {
+    tthread::lock_guard<tthread::mutex> guard(handle_mutex);
+    available_handles.push_back(handle);
+    handle_released.notify_one();
+  }
+
+  int TesseractHandlePool::loadedCopies()
+  {
+    tthread::lock_guard<tthread::mutex> guard(handle_mutex);
+    return all_handles.size();
+  }
+
+
+  void TesseractOcr::init()
+  {
+    this->postProcessor.setConfidenceThreshold(config->postProcessMinConfidence, config->postProcessConfidenceSkipLevel);
+
+    string tessdata_file = config->getTessdataPrefix() + "tessdata/" + config->ocrLanguage + ".traineddata";
+    string key = ModelRegistry::getKey("tessdata", tessdata_file, config->getTessdataPrefix() + "|" + config->ocrLanguage);
+
+    handles = (TesseractHandlePool*) ModelRegistry::acquire(key);
+    if (handles == NULL)
+    {
+      TesseractHandlePool* new_handles = new TesseractHandlePool(config->getTessdataPrefix(), config->ocrLanguage);
+      handles = (TesseractHandlePool*) ModelRegistry::add(key, new_handles, getFileInfo(tessdata_file).size);
+    }
+
+    glyph_cache = NULL;
+    if (config->ocrGlyphCacheSize > 0)
+    {
+      // Cached results are only valid for the same training data and minimum font size
+      stringstream cache_settings;
+      cache_settings << config->getTessdataPrefix() << "|" << config->ocrLanguage << "|" << config->ocrMinFontSize << "|" << config->ocrGlyphCacheSize;
+      string cache_key = ModelRegistry::getKey("glyphcache", tessdata_file, cache_settings.str());
+
+      glyph_cache = (SharedObject<GlyphCache>*) ModelRegistry::acquire(cache_key);
+      if (glyph_cache == NULL)
+        glyph_cache = (SharedObject<GlyphCache>*) ModelRegistry::add(cache_key, new SharedObject<GlyphCache>(new GlyphCache(config->ocrGlyphCacheSize)), 0);
+    }
   }
 
   TesseractOcr::~TesseractOcr()
   {
-    tesseract.End();
+    ModelRegistry::release(handles);
+    ModelRegistry::release(glyph_cache);
   }
   
-  std::vector<OcrChar> TesseractOcr::recognize_line(int line_idx, PipelineData* pipeline_data) {
+  void TesseractOcr::prepare_thresholds(PipelineData* pipeline_data) {
+    // The boxes of each line used to be read after inverting the thresholds again, so the first line is read 
+    // as black text on white, the second in the original polarity, and so on.  Both copies are kept so that
+    // the lines can be read at the same time with the same results
+    original_thresholds.clear();
+    if (pipeline_data->textLines.size() > 1 && !config->ocrStripMode)
+    {
+      for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
+        original_thresholds.push_back(pipeline_data->thresholds[i].clone());
+    }
 
-    const int SPACE_CHAR_CODE = 32;
-    
-    std::vector<OcrChar> recognized_chars;
-    
+    // Make it black text on white background
     for (unsigned int i = 0; i < pipeline_data->thresholds.size(); i++)
-    {
-      // Make it black text on white background
       bitwise_not(pipeline_data->thresholds[i], pipeline_data->thresholds[i]);
-      tesseract.SetImage((uchar*) pipeline_data->thresholds[i].data, 
-                          pipeline_data->thresholds[i].size().width, pipeline_data->thresholds[i].size().height, 
-                          pipeline_data->thresholds[i].channels(), pipeline_data->thresholds[i].step1());
+  }
 
- 
-      int absolute_charpos = 0;
+  cv::Mat TesseractOcr::getLineThreshold(int line_idx, int threshold_idx, PipelineData* pipeline_data) {
+    if (line_idx % 2 == 1 && threshold_idx < original_thresholds.size())
+      return original_thresholds[threshold_idx];
 
-      for (unsigned int j = 0; j < pipeline_data->charRegions[line_idx].size(); j++)
-      {
-        Rect expandedRegion = expandRect( pipeline_data->charRegions[line_idx][j], 2, 2, pipeline_data->thresholds[i].cols, pipeline_data->thresholds[i].rows) ;
+    return pipeline_data->thresholds[threshold_idx];
+  }
 
-        tesseract.SetRectangle(expandedRegion.x, expandedRegion.y, expandedRegion.width, expandedRegion.height);
-        tesseract.Recognize(NULL);
+  std::vector<OcrChar> TesseractOcr::recognize_line(int line_idx, int threshold_idx, PipelineData* pipeline_data) {
 
-        tesseract::ResultIterator* ri = tesseract.GetIterator();
-        tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
-        do
-        {
-          const char* symbol = ri->GetUTF8Text(level);
-          float conf = ri->Confidence(level);
+    std::vector<OcrChar> recognized_chars;
 
-          bool dontcare;
-          int fontindex = 0;
-          int pointsize = 0;
-          const char* fontName = ri->WordFontAttributes(&dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &pointsize, &fontindex);
+    // Each thread recognizing a line borrows its own handle
+    ScopedTesseractHandle tess_api(handles);
 
-          // Ignore NULL pointers, spaces, and characters that are way too small to be valid
-          if(symbol != 0 && symbol[0] != SPACE_CHAR_CODE && pointsize >= config->ocrMinFontSize)
-          {
-            OcrChar c;
-            c.char_index = absolute_charpos;
-            c.confidence = conf;
-            c.letter = string(symbol);
-            recognized_chars.push_back(c);
-
-            if (this->config->debugOcr)
-              printf("charpos%d line%d: threshold %d:  symbol %s, conf: %f font: %s (index %d) size %dpx", absolute_charpos, line_idx, i, symbol, conf, fontName, fontindex, pointsize);
-
-            bool indent = false;
-            tesseract::ChoiceIterator ci(*ri);
-            do
-            {
-              const char* choice = ci.GetUTF8Text();
-              
-              OcrChar c2;
-              c2.char_index = absolute_charpos;
-              c2.confidence = ci.Confidence();
-              c2.letter = string(choice);
-              
-              //1/17/2016 adt adding check to avoid double adding same character if ci is same as symbol. Otherwise first choice from ResultsIterator will get added twice when choiceIterator run.
-              if (string(symbol) != string(choice))
-                recognized_chars.push_back(c2);
-              else
-              {
-                // Explictly double-adding the first character.  This leads to higher accuracy right now, likely because other sections of code
-                // have expected it and compensated. 
-                // TODO: Figure out how to remove this double-counting of the first letter without impacting accuracy
-                recognized_chars.push_back(c2);
-              }
-              if (this->config->debugOcr)
-              {
-                if (indent) printf("\t\t ");
-                printf("\t- ");
-                printf("%s conf: %f\n", choice, ci.Confidence());
-              }
-
-              indent = true;
-            }
-            while(ci.Next());
+    if (config->ocrStripMode)
+      recognize_strip(tess_api.get(), line_idx, threshold_idx, pipeline_data, recognized_chars);
+    else
+      recognize_boxes(tess_api.get(), line_idx, threshold_idx, pipeline_data, recognized_chars);
+
+    return recognized_chars;
+  }
 
+  // Recognizes each character box of the line with its own Recognize() call
+  void TesseractOcr::recognize_boxes(tesseract::TessBaseAPI* tess_api, int line_idx, int threshold_idx, PipelineData* pipeline_data, std::vector<OcrChar>& recognized_chars) {
+
+    Mat threshold = getLineThreshold(line_idx, threshold_idx, pipeline_data);
+    bool image_set = false;
+
+    for (unsigned int j = 0; j < pipeline_data->charRegions[line_idx].size(); j++)
+    {
+      Rect expandedRegion = expandRect( pipeline_data->charRegions[line_idx][j], 2, 2, threshold.cols, threshold.rows) ;
+
+      // Keyed on the character box alone.  The expanded region also holds pixels of the neighboring
+      // characters, which would make the same character miss the cache next to different neighbors
+      Rect charRegion = pipeline_data->charRegions[line_idx][j] & Rect(0, 0, threshold.cols, threshold.rows);
+
+      string glyph_key;
+      if (glyph_cache != NULL && charRegion.area() > 0)
+      {
+        glyph_key = GlyphCache::getKey(threshold(charRegion));
+
+        vector<OcrChar> cached_chars;
+        if (glyph_cache->object->lookup(glyph_key, cached_chars))
+        {
+          for (unsigned int k = 0; k < cached_chars.size(); k++)
+          {
+            cached_chars[k].char_index = j;
+            recognized_chars.push_back(cached_chars[k]);
           }
+          continue;
+        }
+      }
+
+      // Only hand the image to Tesseract once a character isn't found in the cache
+      if (!image_set)
+      {
+        tess_api->SetImage((uchar*) threshold.data, threshold.size().width, threshold.size().height, threshold.channels(), threshold.step1());
+        image_set = true;
+      }
+
+      timespec startTime;
+      getTimeMonotonic(&startTime);
+      unsigned int first_char = recognized_chars.size();
+
+      tess_api->SetRectangle(expandedRegion.x, expandedRegion.y, expandedRegion.width, expandedRegion.height);
+      tess_api->Recognize(NULL);
+
+      tesseract::ResultIterator* ri = tess_api->GetIterator();
+      tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
+      do
+      {
+        add_symbol(ri, j, line_idx, threshold_idx, recognized_chars);
+      }
+      while((ri->Next(level)));
 
-          if (this->config->debugOcr)
-            printf("---------------------------------------------\n");
+      delete ri;
+
+      if (!glyph_key.empty())
+      {
+        timespec endTime;
+        getTimeMonotonic(&endTime);
+
+        vector<OcrChar> new_chars(recognized_chars.begin() + first_char, recognized_chars.end());
+        glyph_cache->object->add(glyph_key, new_chars, diffclock(startTime, endTime));
+      }
+    }
+  }
+
+  // Copies every character box of the line side by side into one strip image and recognizes the strip with a 
+  // single Recognize() call.  Each symbol found is mapped back to the box it was copied from.
+  // The boxes keep their size and vertical position, so the strip looks like the plate with the gaps widened
+  void TesseractOcr::recognize_strip(tesseract::TessBaseAPI* tess_api, int line_idx, int threshold_idx, PipelineData* pipeline_data, std::vector<OcrChar>& recognized_chars) {
+
+    // Minimum white space around each box, so that Tesseract keeps the boxes apart
+    const int MIN_STRIP_GAP_PX = 4;
+
+    Mat threshold = pipeline_data->thresholds[threshold_idx];
+    std::vector<Rect>& char_regions = pipeline_data->charRegions[line_idx];
+    if (char_regions.size() == 0)
+      return;
+
+    std::vector<Rect> boxes;
+    int top = threshold.rows;
+    int bottom = 0;
+    for (unsigned int j = 0; j < char_regions.size(); j++)
+    {
+      Rect expandedRegion = expandRect( char_regions[j], 2, 2, threshold.cols, threshold.rows) ;
+      boxes.push_back(expandedRegion);
+      top = std::min(top, expandedRegion.y);
+      bottom = std::max(bottom, expandedRegion.y + expandedRegion.height);
+    }
+
+    int gap = std::max(MIN_STRIP_GAP_PX, (bottom - top) / 2);
+    int strip_width = gap;
+    for (unsigned int j = 0; j < boxes.size(); j++)
+      strip_width += boxes[j].width + gap;
+
+    Mat strip(bottom - top + 2 * gap, strip_width, CV_8U, Scalar(255));
+
+    // Where each box starts and ends in the strip
+    std::vector<int> box_starts;
+    std::vector<int> box_ends;
+    int x = gap;
+    for (unsigned int j = 0; j < boxes.size(); j++)
+    {
+      Rect strip_box(x, boxes[j].y - top + gap, boxes[j].width, boxes[j].height);
+      threshold(boxes[j]).copyTo(strip(strip_box));
+
+      box_starts.push_back(x);
+      box_ends.push_back(x + boxes[j].width);
+      x += boxes[j].width + gap;
+    }
 
-          delete[] symbol;
+    tess_api->SetPageSegMode(PSM_SINGLE_LINE);
+    tess_api->SetImage((uchar*) strip.data, strip.size().width, strip.size().height, strip.channels(), strip.step1());
+    tess_api->Recognize(NULL);
+
+    tesseract::ResultIterator* ri = tess_api->GetIterator();
+    tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
+    if (ri != NULL)
+    {
+      do
+      {
+        int left, symbol_top, right, symbol_bottom;
+        if (!ri->BoundingBox(level, &left, &symbol_top, &right, &symbol_bottom))
+          continue;
+
+        // The box that the middle of the symbol falls in, or the closest one
+        int center = (left + right) / 2;
+        int char_index = 0;
+        int closest_distance = strip_width;
+        for (unsigned int j = 0; j < boxes.size(); j++)
+        {
+          int distance = 0;
+          if (center < box_starts[j])
+            distance = box_starts[j] - center;
+          else if (center >= box_ends[j])
+            distance = center - box_ends[j] + 1;
+
+          if (distance < closest_distance)
+          {
+            closest_distance = distance;
+            char_index = j;
+          }
         }
-        while((ri->Next(level)));
 
-        delete ri;
+        add_symbol(ri, char_index, line_idx, threshold_idx, recognized_chars);
+      }
+      while((ri->Next(level)));
+    }
+
+    delete ri;
+
+    // The handles are shared, so put back the mode that the other recognition path expects
+    tess_api->SetPageSegMode(PSM_SINGLE_CHAR);
+  }
+
+  // Adds the symbol at the iterator's position, and each of the other choices for it, to the recognized characters
+  void TesseractOcr::add_symbol(tesseract::ResultIterator* ri, int char_index, int line_idx, int threshold_idx, std::vector<OcrChar>& recognized_chars) {
+
+    const int SPACE_CHAR_CODE = 32;
+
+    tesseract::PageIteratorLevel level = tesseract::RIL_SYMBOL;
+
+    const char* symbol = ri->GetUTF8Text(level);
+    float conf = ri->Confidence(level);
 
-        absolute_charpos++;
+    bool dontcare;
+    int fontindex = 0;
+    int pointsize = 0;
+    const char* fontName = ri->WordFontAttributes(&dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &dontcare, &pointsize, &fontindex);
+
+    // Ignore NULL pointers, spaces, and characters that are way too small to be valid
+    if(symbol != 0 && symbol[0] != SPACE_CHAR_CODE && pointsize >= config->ocrMinFontSize)
+    {
+      OcrChar c;
+      c.char_index = char_index;
+      c.confidence = conf;
+      c.letter = string(symbol);
+      recognized_chars.push_back(c);
+
+      if (this->config->debugOcr)
+        printf("charpos%d line%d: threshold %d:  symbol %s, conf: %f font: %s (index %d) size %dpx", char_index, line_idx, threshold_idx, symbol, conf, fontName, fontindex, pointsize);
+
+      bool indent = false;
+      tesseract::ChoiceIterator ci(*ri);
+      do
+      {
+        const char* choice = ci.GetUTF8Text();
+        
+        OcrChar c2;
+        c2.char_index = char_index;
+        c2.confidence = ci.Confidence();
+        c2.letter = string(choice);
+        
+        //1/17/2016 adt adding check to avoid double adding same character if ci is same as symbol. Otherwise first choice from ResultsIterator will get added twice when choiceIterator run.
+        if (string(symbol) != string(choice))
+          recognized_chars.push_back(c2);
+        else
+        {
+          // Explictly double-adding the first character.  This leads to higher accuracy right now, likely because other sections of code
+          // have expected it and compensated. 
+          // TODO: Figure out how to remove this double-counting of the first letter without impacting accuracy
+          recognized_chars.push_back(c2);
+        }
+        if (this->config->debugOcr)
+        {
+          if (indent) printf("\t\t ");
+          printf("\t- ");
+          printf("%s conf: %f\n", choice, ci.Confidence());
+        }
+
+        indent = true;
       }
-      
+      while(ci.Next());
+
     }
-    
-    return recognized_chars;
+
+    if (this->config->debugOcr)
+      printf("---------------------------------------------\n");
+
+    delete[] symbol;
   }
+
+  void TesseractOcr::print_timing_details() {
+    if (glyph_cache == NULL)
+      return;
+
+    GlyphCacheStats stats = glyph_cache->object->getStats();
+    int64_t lookups = stats.hits + stats.misses;
+    float hit_rate = lookups > 0 ? (100.0 * stats.hits) / lookups : 0;
+    std::cout << "Glyph Cache: " << hit_rate << "% hit rate (" << stats.hits << " of " << lookups << "), " 
+              << stats.size << " entries, about " << stats.saved_ms << "ms saved." << std::endl;
+  }
+
   void TesseractOcr::segment(PipelineData* pipeline_data) {
 
     CharacterSegmenter segmenter(pipeline_data);
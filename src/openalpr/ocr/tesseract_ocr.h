@@ -32,26 +32,89 @@
 #include "support/version.h"
 
 #include "ocr.h"
+#include "glyphcache.h"
+#include "modelregistry.h"
+#include "support/tinythread.h"
 #include "tesseract/baseapi.h"
 
 namespace alpr
 {
 
+  // Tesseract handles initialized with the same training data.  Shared through the ModelRegistry 
+  // by every TesseractOcr in the process.  A handle can only be used by one thread at a time, 
+  // so it is borrowed for each line of text.  New handles are only initialized when all of
+  // the existing ones are in use; if one fails to initialize, callers wait for a handle to be released.
+  class TesseractHandlePool : public SharedModel
+  {
+    public:
+      TesseractHandlePool(std::string tessdata_prefix, std::string language);
+      virtual ~TesseractHandlePool();
+
+      tesseract::TessBaseAPI* acquire();
+      void release(tesseract::TessBaseAPI* handle);
+
+      int loadedCopies();
+
+    private:
+      std::string tessdata_prefix;
+      std::string language;
+
+      std::vector<tesseract::TessBaseAPI*> all_handles;
+      std::vector<tesseract::TessBaseAPI*> available_handles;
+      tthread::mutex handle_mutex;
+      tthread::condition_variable handle_released;
+      bool copy_failed;
+
+      tesseract::TessBaseAPI* createHandle(bool& initialized);
+  };
+
+  // Borrows a Tesseract handle from the pool for the lifetime of the object
+  class ScopedTesseractHandle
+  {
+    public:
+      ScopedTesseractHandle(TesseractHandlePool* pool) { this->pool = pool; this->handle = pool->acquire(); }
+      ~ScopedTesseractHandle() { pool->release(handle); }
+
+      tesseract::TessBaseAPI* get() { return handle; }
+
+    private:
+      TesseractHandlePool* pool;
+      tesseract::TessBaseAPI* handle;
+
+      ScopedTesseractHandle(const ScopedTesseractHandle&);
+      ScopedTesseractHandle& operator=(const ScopedTesseractHandle&);
+  };
+
   class TesseractOcr : public OCR 
   {
 
     public:
       TesseractOcr(Config* config);
+      TesseractOcr(Config* config, RegexRuleSet* rules);
       virtual ~TesseractOcr();
 
 
 
     private:
 
-      std::vector<OcrChar> recognize_line(int line_index, PipelineData* pipeline_data);
+      std::vector<OcrChar> recognize_line(int line_index, int threshold_index, PipelineData* pipeline_data);
+      void prepare_thresholds(PipelineData* pipeline_data);
+      cv::Mat getLineThreshold(int line_idx, int threshold_idx, PipelineData* pipeline_data);
+      void print_timing_details();
+      void recognize_boxes(tesseract::TessBaseAPI* tess_api, int line_idx, int threshold_idx, PipelineData* pipeline_data, std::vector<OcrChar>& recognized_chars);
+      void recognize_strip(tesseract::TessBaseAPI* tess_api, int line_idx, int threshold_idx, PipelineData* pipeline_data, std::vector<OcrChar>& recognized_chars);
+      void add_symbol(tesseract::ResultIterator* ri, int char_index, int line_idx, int threshold_idx, std::vector<OcrChar>& recognized_chars);
       void segment(PipelineData* pipeline_data);
+
+      void init();
     
-      tesseract::TessBaseAPI tesseract;
+      TesseractHandlePool* handles;
+
+      // The thresholds before they were inverted, for the odd lines of multiline plates.  Empty otherwise
+      std::vector<cv::Mat> original_thresholds;
+
+      // Shared by every TesseractOcr with the same training data and settings.  NULL if disabled
+      SharedObject<GlyphCache>* glyph_cache;
 
   };
 
@@ -50,5 +50,20 @@ namespace alpr
     this->plate_inverted = false;
     this->disqualified = false;
     this->disqualify_reason = "";
+    this->mat_pool = NULL;
+  }
+
+  cv::Mat PipelineData::borrowImage(cv::Size size, int type) {
+    if (mat_pool == NULL)
+      return Mat(size, type);
+
+    return mat_pool->get(size, type);
+  }
+
+  cv::Mat PipelineData::borrowZeros(cv::Size size, int type) {
+    if (mat_pool == NULL)
+      return Mat::zeros(size, type);
+
+    return mat_pool->zeros(size, type);
   }
 }
@@ -8,6 +8,8 @@
 #include "textdetection/textline.h"
 #include "edges/scorekeeper.h"
 #include "prewarp.h"
+#include "alpr.h"
+#include "matpool.h"
 
 namespace alpr
 {
@@ -23,10 +25,18 @@ namespace alpr
       void init(cv::Mat colorImage, cv::Mat grayImage, cv::Rect regionOfInterest, Config* config);
       void clearThresholds();
 
+      // Scratch images for this plate.  Taken from mat_pool when one is set
+      cv::Mat borrowImage(cv::Size size, int type);
+      cv::Mat borrowZeros(cv::Size size, int type);
+
       // Inputs
       Config* config;
 
-      PreWarp* prewarp;
+      // The transform the image was prewarped with.  Empty if it wasn't
+      cv::Mat prewarp_transform;
+
+      // Optional.  Reuses scratch image buffers from previous plates
+      MatPool* mat_pool;
 
       cv::Mat colorImg;
       cv::Mat grayImg;
@@ -65,6 +75,8 @@ namespace alpr
       // Same data, just not broken down by line
       std::vector<cv::Rect> charRegionsFlat;
 
+      // Time spent in each stage while analyzing this plate region
+      AlprStageTiming stage_timing;
 
 
 
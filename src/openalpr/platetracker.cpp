@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "platetracker.h"
+#include "utility.h"
+
+using namespace cv;
+using namespace std;
+
+namespace alpr
+{
+
+  PlateTracker::PlateTracker(Config* config)
+  {
+    full_scan_interval = config->trackerFullScanInterval > 0 ? config->trackerFullScanInterval : 1;
+    roi_expansion = config->trackerRoiExpansion;
+    max_missed_frames = config->trackerMaxMissedFrames;
+
+    reset();
+  }
+
+  PlateTracker::~PlateTracker()
+  {
+
+  }
+
+  void PlateTracker::reset()
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+
+    tracks.clear();
+    frame_number = 0;
+    frame_width = 0;
+    frame_height = 0;
+    last_full_scan = -full_scan_interval;
+    full_scans = 0;
+    had_motion = false;
+  }
+
+  vector<AlprRegionOfInterest> PlateTracker::getRegionsOfInterest(int frame_width, int frame_height, cv::Rect motion)
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+
+    frame_number++;
+    this->frame_width = frame_width;
+    this->frame_height = frame_height;
+
+    // Drop the plates that have not been seen for a while
+    vector<PlateTrack> current_tracks;
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      if (frame_number - tracks[i].last_seen_frame <= max_missed_frames + 1)
+        current_tracks.push_back(tracks[i]);
+    }
+    tracks = current_tracks;
+
+    // New motion, or motion with nothing tracked, may be a new plate coming into view
+    bool has_motion = motion.area() > 0;
+    bool full_scan = frame_number - last_full_scan >= full_scan_interval;
+    if (has_motion && (!had_motion || tracks.size() == 0))
+      full_scan = true;
+    had_motion = has_motion;
+
+    vector<AlprRegionOfInterest> regionsOfInterest;
+    if (full_scan)
+    {
+      last_full_scan = frame_number;
+      full_scans++;
+      regionsOfInterest.push_back(AlprRegionOfInterest(0, 0, frame_width, frame_height));
+      return regionsOfInterest;
+    }
+
+    // Overlapping search areas are combined so that no plate is found twice
+    vector<Rect> search_rects;
+    for (unsigned int i = 0; i < tracks.size(); i++)
+    {
+      Rect search_rect = getSearchRect(tracks[i], frame_width, frame_height);
+      if (search_rect.area() <= 0)
+        continue;
+
+      bool merged = true;
+      while (merged)
+      {
+        merged = false;
+        for (unsigned int k = 0; k < search_rects.size(); k++)
+        {
+          if ((search_rect & search_rects[k]).area() > 0)
+          {
+            search_rect = search_rect | search_rects[k];
+            search_rects.erase(search_rects.begin() + k);
+            merged = true;
+            break;
+          }
+        }
+      }
+      search_rects.push_back(search_rect);
+    }
+
+    for (unsigned int i = 0; i < search_rects.size(); i++)
+      regionsOfInterest.push_back(AlprRegionOfInterest(search_rects[i].x, search_rects[i].y, search_rects[i].width, search_rects[i].height));
+
+    return regionsOfInterest;
+  }
+
+  void PlateTracker::update(AlprResults results)
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+
+    vector<bool> matched(tracks.size(), false);
+    for (unsigned int i = 0; i < results.plates.size(); i++)
+    {
+      vector<Point> points;
+      for (int k = 0; k < 4; k++)
+        points.push_back(Point(results.plates[i].plate_points[k].x, results.plates[i].plate_points[k].y));
+      Rect plate_rect = boundingRect(points);
+      Point2f plate_center(plate_rect.x + plate_rect.width / 2.0f, plate_rect.y + plate_rect.height / 2.0f);
+
+      // Match the plate to the closest track that expected a plate near here
+      int best_track = -1;
+      float best_distance = 0;
+      for (unsigned int k = 0; k < tracks.size(); k++)
+      {
+        if (matched[k])
+          continue;
+
+        Rect search_rect = getSearchRect(tracks[k], frame_width, frame_height);
+        if (!search_rect.contains(Point(plate_center.x, plate_center.y)))
+          continue;
+
+        Rect predicted = predictRect(tracks[k]);
+        Point2f predicted_center(predicted.x + predicted.width / 2.0f, predicted.y + predicted.height / 2.0f);
+        float distance = distanceBetweenPoints(plate_center, predicted_center);
+        if (best_track < 0 || distance < best_distance)
+        {
+          best_track = k;
+          best_distance = distance;
+        }
+      }
+
+      if (best_track < 0)
+      {
+        PlateTrack track;
+        track.rect = plate_rect;
+        track.last_seen_frame = frame_number;
+        track.velocity = Point2f(0, 0);
+        tracks.push_back(track);
+        continue;
+      }
+
+      PlateTrack& track = tracks[best_track];
+      int elapsed_frames = std::max(frame_number - track.last_seen_frame, 1);
+      Point2f last_center(track.rect.x + track.rect.width / 2.0f, track.rect.y + track.rect.height / 2.0f);
+
+      track.velocity = (plate_center - last_center) * (1.0f / elapsed_frames);
+      track.rect = plate_rect;
+      track.last_seen_frame = frame_number;
+      matched[best_track] = true;
+    }
+  }
+
+  int PlateTracker::getTrackCount()
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+    return tracks.size();
+  }
+
+  int PlateTracker::getFullScanCount()
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+    return full_scans;
+  }
+
+  int PlateTracker::getFrameCount()
+  {
+    tthread::lock_guard<tthread::mutex> guard(tracker_mutex);
+    return frame_number;
+  }
+
+  // Where the plate should be in the current frame, assuming it keeps moving at the same speed
+  Rect PlateTracker::predictRect(PlateTrack& track)
+  {
+    int elapsed_frames = frame_number - track.last_seen_frame;
+
+    Rect predicted = track.rect;
+    predicted.x += round(track.velocity.x * elapsed_frames);
+    predicted.y += round(track.velocity.y * elapsed_frames);
+    return predicted;
+  }
+
+  // The predicted location, with room on each side for the prediction to be wrong
+  Rect PlateTracker::getSearchRect(PlateTrack& track, int frame_width, int frame_height)
+  {
+    Rect predicted = predictRect(track);
+
+    Rect search_rect = expandRect(predicted, predicted.width * roi_expansion * 2, predicted.height * roi_expansion * 2, 
+                                  frame_width, frame_height);
+    return search_rect & Rect(0, 0, frame_width, frame_height);
+  }
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPENALPR_PLATETRACKER_H
+#define OPENALPR_PLATETRACKER_H
+
+#include <vector>
+
+#include "opencv2/core/core.hpp"
+
+#include "alpr.h"
+#include "config.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  struct PlateTrack
+  {
+    // Where the plate was last found
+    cv::Rect rect;
+    int last_seen_frame;
+
+    // Movement of the plate, in pixels per frame
+    cv::Point2f velocity;
+  };
+
+  // Follows the plates found in a video stream so that most frames only need to be searched where the 
+  // tracked plates are expected to be.  The whole frame is scanned every tracker_full_scan_interval frames, 
+  // and whenever motion appears.  Safe to share between threads, although frames that finish out of order 
+  // make the predictions less accurate.
+  class PlateTracker
+  {
+    public:
+      PlateTracker(Config* config);
+      virtual ~PlateTracker();
+
+      // Returns the regions to search in the next frame.  motion is the area of the frame that has motion, 
+      // or an empty rect if there is none.  Returns no regions if there is nothing to search in this frame
+      std::vector<AlprRegionOfInterest> getRegionsOfInterest(int frame_width, int frame_height, cv::Rect motion = cv::Rect());
+
+      // Updates the tracks with the plates found in the regions returned by getRegionsOfInterest()
+      void update(AlprResults results);
+
+      void reset();
+
+      int getTrackCount();
+      int getFullScanCount();
+      int getFrameCount();
+
+    private:
+      int full_scan_interval;
+      float roi_expansion;
+      int max_missed_frames;
+
+      std::vector<PlateTrack> tracks;
+      int frame_number;
+      int frame_width;
+      int frame_height;
+      int last_full_scan;
+      int full_scans;
+      bool had_motion;
+
+      tthread::mutex tracker_mutex;
+
+      cv::Rect predictRect(PlateTrack& track);
+      cv::Rect getSearchRect(PlateTrack& track, int frame_width, int frame_height);
+  };
+
+}
+
+#endif // OPENALPR_PLATETRACKER_H
@@ -30,50 +30,32 @@ namespace alpr
 
   PostProcess::PostProcess(Config* config)
   {
-    this->config = config;
+    init(config);
 
-    this->min_confidence = 0;
-    this->skip_level = 0;
-    
-    stringstream filename;
-    filename << config->getPostProcessRuntimeDir() << "/" << config->country << ".patterns";
-
-    std::ifstream infile(filename.str().c_str());
-
-    string region, pattern;
-    while (infile >> region >> pattern)
-    {
-      RegexRule* rule = new RegexRule(region, pattern, config->postProcessRegexLetters, config->postProcessRegexNumbers);
-      //cout << "REGION: " << region << " PATTERN: " << pattern << endl;
+    this->rules = new RegexRuleSet(config);
+    this->owns_rules = true;
+  }
 
-      if (rules.find(region) == rules.end())
-      {
-        vector<RegexRule*> newRule;
-        newRule.push_back(rule);
-        rules[region] = newRule;
-      }
-      else
-      {
-        vector<RegexRule*> oldRule = rules[region];
-        oldRule.push_back(rule);
-        rules[region] = oldRule;
-      }
-    }
+  PostProcess::PostProcess(Config* config, RegexRuleSet* rules)
+  {
+    init(config);
 
+    this->rules = rules;
+    this->owns_rules = false;
   }
 
   PostProcess::~PostProcess()
   {
-    // TODO: Delete all entries in rules vector
-    map<string, vector<RegexRule*> >::iterator iter;
+    if (owns_rules)
+      delete rules;
+  }
 
-    for (iter = rules.begin(); iter != rules.end(); ++iter)
-    {
-      for (int i = 0; i < iter->second.size(); i++)
-      {
-        delete iter->second[i];
-      }
-    }
+  void PostProcess::init(Config* config)
+  {
+    this->config = config;
+
+    this->min_confidence = 0;
+    this->skip_level = 0;
   }
   
   void PostProcess::setConfidenceThreshold(float min_confidence, float skip_level) {
@@ -161,7 +143,7 @@ namespace alpr
     matchesTemplate = false;
   }
 
-  void PostProcess::analyze(string templateregion, int topn)
+  void PostProcess::analyze(string templateregion, int topn, bool best_only)
   {
     timespec startTime;
     getTimeMonotonic(&startTime);
@@ -198,7 +180,7 @@ namespace alpr
     timespec permutationStartTime;
     getTimeMonotonic(&permutationStartTime);
 
-    findAllPermutations(templateregion, topn);
+    findAllPermutations(templateregion, topn, best_only);
 
     if (config->debugTiming)
     {
@@ -210,15 +192,16 @@ namespace alpr
     if (allPossibilities.size() > 0)
     {
 
-      bestChars = allPossibilities[0].letters;
+      int bestIndex = 0;
       for (int z = 0; z < allPossibilities.size(); z++)
       {
         if (allPossibilities[z].matchesTemplate)
         {
-          bestChars = allPossibilities[z].letters;
+          bestIndex = z;
           break;
         }
       }
+      bestChars = allPossibilities[bestIndex].letters;
 
       // Now adjust the confidence scores to a percentage value
       float maxPercentScore = calculateMaxConfidenceScore();
@@ -228,6 +211,12 @@ namespace alpr
       {
         allPossibilities[i].totalscore = maxPercentScore * (allPossibilities[i].totalscore / highestRelativeScore);
       }
+
+      if (best_only)
+      {
+        PPResult best = allPossibilities[bestIndex];
+        allPossibilities.assign(1, best);
+      }
     }
 
     if (this->config->debugPostProcess)
@@ -256,7 +245,7 @@ namespace alpr
 
   bool PostProcess::regionIsValid(std::string templateregion)
   {
-    return rules.find(templateregion) != rules.end();
+    return rules->regionIsValid(templateregion);
   }
   
   float PostProcess::calculateMaxConfidenceScore()
@@ -286,6 +275,35 @@ namespace alpr
     return this->allPossibilities;
   }
 
+  bool PostProcess::getBestLetter(int charposition, std::string& letter, float& margin)
+  {
+    if (charposition < 0 || charposition >= letters.size() || letters[charposition].size() == 0)
+      return false;
+
+    float best_score = 0;
+    float second_score = 0;
+    int best_index = -1;
+    for (unsigned int i = 0; i < letters[charposition].size(); i++)
+    {
+      float score = letters[charposition][i].totalscore;
+      if (best_index == -1 || score > best_score)
+      {
+        if (best_index != -1)
+          second_score = best_score;
+        best_score = score;
+        best_index = i;
+      }
+      else if (score > second_score)
+      {
+        second_score = score;
+      }
+    }
+
+    letter = letters[charposition][best_index].letter;
+    margin = best_score - second_score;
+    return true;
+  }
+
   struct PermutationCompare {
     bool operator() (pair<float,vector<int> > &a, pair<float,vector<int> > &b)
     {
@@ -293,7 +311,7 @@ namespace alpr
     }
   };
 
-  void PostProcess::findAllPermutations(string templateregion, int topn) {
+  void PostProcess::findAllPermutations(string templateregion, int topn, bool best_only) {
 
     // use a priority queue to process permutations in highest scoring order
     priority_queue<pair<float,vector<int> >, vector<pair<float,vector<int> > >, PermutationCompare> permutations;
@@ -315,7 +333,13 @@ namespace alpr
       // get the top permutation and analyze
       pair<float, vector<int> > topPermutation = permutations.top();
       if (analyzePermutation(topPermutation.second, templateregion, topn) == true)
+      {
         consecutiveNonMatches = 0;
+
+        // The best plate is the first one that matches the template, or the first one if none of them do
+        if (best_only && (templateregion == "" || allPossibilities.back().matchesTemplate))
+          break;
+      }
       else
         consecutiveNonMatches += 1;
       permutations.pop();
@@ -384,16 +408,7 @@ namespace alpr
     // Apply templates
     if (templateregion != "")
     {
-      vector<RegexRule*> regionRules = rules[templateregion];
-
-      for (int i = 0; i < regionRules.size(); i++)
-      {
-        possibility.matchesTemplate = regionRules[i]->match(possibility.letters);
-        if (possibility.matchesTemplate)
-        {
-          break;
-        }
-      }
+      possibility.matchesTemplate = rules->match(templateregion, possibility.letters);
     }
 
     // ignore duplicate words
@@ -414,12 +429,7 @@ namespace alpr
   }
 
   std::vector<string> PostProcess::getPatterns() {
-    vector<string> v;
-    for(map<string,std::vector<RegexRule*> >::iterator it = rules.begin(); it != rules.end(); ++it) {
-      v.push_back(it->first);
-    }
-    
-    return v;
+    return rules->getPatterns();
   }
 
   bool letterCompare( const Letter &left, const Letter &right )
@@ -21,6 +21,7 @@
 #define OPENALPR_POSTPROCESS_H
 
 #include "regexrule.h"
+#include "regexruleset.h"
 #include "constants.h"
 #include "utility.h"
 #include <set>
@@ -58,18 +59,25 @@ namespace alpr
   {
     public:
       PostProcess(Config* config);
+      // Shares an already loaded set of pattern rules.  The rules are not owned by this instance
+      PostProcess(Config* config, RegexRuleSet* rules);
       ~PostProcess();
 
       void addLetter(std::string letter, int line_index, int charposition, float score);
 
       void clear();
-      void analyze(std::string templateregion, int topn);
+      // With best_only, the search stops as soon as the best plate is known, and it is the only result kept
+      void analyze(std::string templateregion, int topn, bool best_only = false);
 
       std::string bestChars;
       bool matchesTemplate;
 
       const std::vector<PPResult> getResults();
 
+      // The highest scoring letter added so far at a character position, and how far its score is ahead
+      // of the next best letter (including the skip character).  Returns false if nothing was added there
+      bool getBestLetter(int charposition, std::string& letter, float& margin);
+
       bool regionIsValid(std::string templateregion);
       
       std::vector<std::string> getPatterns();
@@ -79,12 +87,15 @@ namespace alpr
     private:
       Config* config;
 
-      void findAllPermutations(std::string templateregion, int topn);
+      void findAllPermutations(std::string templateregion, int topn, bool best_only);
       bool analyzePermutation(std::vector<int> letterIndices, std::string templateregion, int topn);
 
       void insertLetter(std::string letter, int line_index, int charPosition, float score);
 
-      std::map<std::string, std::vector<RegexRule*> > rules;
+      RegexRuleSet* rules;
+      bool owns_rules;
+
+      void init(Config* config);
 
       float calculateMaxConfidenceScore();
 
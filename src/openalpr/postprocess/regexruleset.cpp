@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include "regexruleset.h"
+
+using namespace std;
+
+namespace alpr
+{
+
+  RegexRuleSet::RegexRuleSet(Config* config)
+  {
+    stringstream filename;
+    filename << config->getPostProcessRuntimeDir() << "/" << config->country << ".patterns";
+
+    std::ifstream infile(filename.str().c_str());
+
+    string region, pattern;
+    while (infile >> region >> pattern)
+    {
+      RegexRule* rule = new RegexRule(region, pattern, config->postProcessRegexLetters, config->postProcessRegexNumbers);
+      //cout << "REGION: " << region << " PATTERN: " << pattern << endl;
+
+      rules[region].push_back(rule);
+    }
+  }
+
+  RegexRuleSet::~RegexRuleSet()
+  {
+    map<string, vector<RegexRule*> >::iterator iter;
+
+    for (iter = rules.begin(); iter != rules.end(); ++iter)
+    {
+      for (unsigned int i = 0; i < iter->second.size(); i++)
+      {
+        delete iter->second[i];
+      }
+    }
+  }
+
+  bool RegexRuleSet::regionIsValid(std::string templateregion)
+  {
+    return rules.find(templateregion) != rules.end();
+  }
+
+  bool RegexRuleSet::match(std::string templateregion, std::string text)
+  {
+    // Use find() rather than operator[] so that lookups never modify the shared map
+    map<string, vector<RegexRule*> >::const_iterator region_rules = rules.find(templateregion);
+    if (region_rules == rules.end())
+      return false;
+
+    for (unsigned int i = 0; i < region_rules->second.size(); i++)
+    {
+      if (region_rules->second[i]->match(text))
+        return true;
+    }
+
+    return false;
+  }
+
+  std::vector<string> RegexRuleSet::getPatterns()
+  {
+    vector<string> v;
+    for (map<string, vector<RegexRule*> >::iterator it = rules.begin(); it != rules.end(); ++it)
+      v.push_back(it->first);
+
+    return v;
+  }
+
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPENALPR_REGEXRULESET_H
+#define	OPENALPR_REGEXRULESET_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "regexrule.h"
+#include "config.h"
+
+namespace alpr
+{
+
+  // The compiled plate patterns for a single country (e.g., runtime_data/postprocess/us.patterns)
+  // The rules are read-only once loaded, so one set may be shared by any number of PostProcess
+  // instances running on different threads.
+  class RegexRuleSet
+  {
+    public:
+      RegexRuleSet(Config* config);
+      virtual ~RegexRuleSet();
+
+      bool regionIsValid(std::string templateregion);
+
+      // Returns true if the text matches any of the patterns for the given region
+      bool match(std::string templateregion, std::string text);
+
+      std::vector<std::string> getPatterns();
+
+    private:
+      std::map<std::string, std::vector<RegexRule*> > rules;
+  };
+
+}
+
+#endif	/* OPENALPR_REGEXRULESET_H */
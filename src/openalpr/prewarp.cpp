@@ -139,29 +139,24 @@ namespace alpr
   }
   
   cv::Mat PreWarp::warpImage(Mat image) {
+    Mat image_transform;
+    return warpImage(image, image_transform);
+  }
+
+  cv::Mat PreWarp::warpImage(Mat image, Mat& image_transform) {
     if (!this->valid)
     {
       if (this->config->debugPrewarp)
         cout << "prewarp skipped due to missing prewarp config" << endl;
+      image_transform = Mat();
       return image;
     }
     
-      
-    float width_ratio = w / ((float)image.cols);
-    float height_ratio = h / ((float)image.rows);
-
-    float rx = rotationx * width_ratio;
-    float ry = rotationy * width_ratio;
-    float px = panX / width_ratio;
-    float py = panY / height_ratio;
-
-
-    transform = getTransform(image.cols, image.rows, rx, ry, rotationz, px, py, stretchX, dist);
-    
+    image_transform = getImageTransform(image.size());
     
     Mat warped_image;
   
-    warpPerspective(image, warped_image, transform, image.size(), INTER_CUBIC | WARP_INVERSE_MAP);
+    warpPerspective(image, warped_image, image_transform, image.size(), INTER_CUBIC | WARP_INVERSE_MAP);
 
     
     if (this->config->debugPrewarp && this->config->debugShowImages)
@@ -171,33 +166,49 @@ namespace alpr
     return warped_image;
   }
 
+  cv::Mat PreWarp::getImageTransform(cv::Size image_size) {
+    if (!this->valid)
+      return Mat();
+
+    // The prewarp is configured for an image of w x h.  Scale it to this image
+    float width_ratio = w / ((float)image_size.width);
+    float height_ratio = h / ((float)image_size.height);
+
+    float rx = rotationx * width_ratio;
+    float ry = rotationy * width_ratio;
+    float px = panX / width_ratio;
+    float py = panY / height_ratio;
+
+    return getTransform(image_size.width, image_size.height, rx, ry, rotationz, px, py, stretchX, dist);
+  }
+
   // Projects a "region of interest" into the new space
   // The rect needs to be converted to points, warped, then converted back into a 
   // bounding rectangle
-  vector<Rect> PreWarp::projectRects(vector<Rect> rects, int maxWidth, int maxHeight, bool inverse) {
+  vector<Rect> PreWarp::projectRects(vector<Rect> rects, Mat transform, int maxWidth, int maxHeight, bool inverse) {
     
-    if (!this->valid)
+    if (transform.empty())
       return rects;
     
     vector<Rect> projected_rects;
     
     for (unsigned int i = 0; i < rects.size(); i++)
     {
-      Rect r = projectRect(rects[i], maxWidth, maxHeight, inverse);
+      Rect r = projectRect(rects[i], transform, maxWidth, maxHeight, inverse);
       projected_rects.push_back(r);
     }
     
     return projected_rects;
   }
   
-  Rect PreWarp::projectRect(Rect rect, int maxWidth, int maxHeight, bool inverse) {
+  Rect PreWarp::projectRect(Rect rect, Mat transform, int maxWidth, int maxHeight, bool inverse) {
       vector<Point2f> points;
       points.push_back(Point(rect.x, rect.y));
       points.push_back(Point(rect.x + rect.width, rect.y));
       points.push_back(Point(rect.x + rect.width, rect.y + rect.height));
       points.push_back(Point(rect.x, rect.y + rect.height));
       
-      vector<Point2f> projectedPoints = projectPoints(points, inverse);
+      vector<Point2f> projectedPoints = projectPoints(points, transform, inverse);
       
       Rect projectedRect = boundingRect(projectedPoints);
       projectedRect = expandRect(projectedRect, 0, 0, maxWidth, maxHeight);
@@ -205,11 +216,11 @@ namespace alpr
       return projectedRect;
   }
 
-  vector<Point2f> PreWarp::projectPoints(vector<Point2f> points, bool inverse) {
+  vector<Point2f> PreWarp::projectPoints(vector<Point2f> points, Mat transform, bool inverse) {
     
-    if (!this->valid)
+    if (transform.empty())
       return points;
-    
+
     vector<Point2f> output;
     
     if (!inverse)
@@ -221,22 +232,22 @@ namespace alpr
   }
   
 
-  void PreWarp::projectPlateRegions(vector<PlateRegion>& plateRegions, int maxWidth, int maxHeight, bool inverse){
+  void PreWarp::projectPlateRegions(vector<PlateRegion>& plateRegions, Mat transform, int maxWidth, int maxHeight, bool inverse){
     
-    if (!this->valid)
+    if (transform.empty())
       return;
     
     for (unsigned int i = 0; i < plateRegions.size(); i++)
     {
       vector<Rect> singleRect;
       singleRect.push_back(plateRegions[i].rect);
-      vector<Rect> transformedRect = projectRects(singleRect, maxWidth, maxHeight, inverse);
+      vector<Rect> transformedRect = projectRects(singleRect, transform, maxWidth, maxHeight, inverse);
       plateRegions[i].rect.x = transformedRect[0].x;
       plateRegions[i].rect.y = transformedRect[0].y;
       plateRegions[i].rect.width = transformedRect[0].width;
       plateRegions[i].rect.height = transformedRect[0].height;
       
-      projectPlateRegions(plateRegions[i].children, maxWidth, maxHeight, inverse);
+      projectPlateRegions(plateRegions[i].children, transform, maxWidth, maxHeight, inverse);
     }
   }
   
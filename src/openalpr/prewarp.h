@@ -38,10 +38,20 @@ namespace alpr
     void clear();
     
     cv::Mat warpImage(cv::Mat image);
-    std::vector<cv::Point2f> projectPoints(std::vector<cv::Point2f> points, bool inverse);
-    std::vector<cv::Rect> projectRects(std::vector<cv::Rect> rects, int maxWidth, int maxHeight, bool inverse);
-    cv::Rect projectRect(cv::Rect rect, int maxWidth, int maxHeight, bool inverse);
-    void projectPlateRegions(std::vector<PlateRegion>& plateRegions, int maxWidth, int maxHeight, bool inverse);
+    // Also returns the transform used, for projecting points between the image and the warped image.
+    // Empty when there is no prewarp
+    cv::Mat warpImage(cv::Mat image, cv::Mat& image_transform);
+
+    // The transform that warpImage() uses for an image of this size.  Empty when there is no prewarp
+    cv::Mat getImageTransform(cv::Size image_size);
+
+    // Projects points between an image and its warped image, using the transform the image was warped with.
+    // The transform belongs to the image, since it depends on the image size.  An empty transform 
+    // leaves the points unchanged
+    static std::vector<cv::Point2f> projectPoints(std::vector<cv::Point2f> points, cv::Mat transform, bool inverse);
+    static std::vector<cv::Rect> projectRects(std::vector<cv::Rect> rects, cv::Mat transform, int maxWidth, int maxHeight, bool inverse);
+    static cv::Rect projectRect(cv::Rect rect, cv::Mat transform, int maxWidth, int maxHeight, bool inverse);
+    static void projectPlateRegions(std::vector<PlateRegion>& plateRegions, cv::Mat transform, int maxWidth, int maxHeight, bool inverse);
 
     void setTransform(float w, float h, float rotationx, float rotationy, float rotationz, float panX, float panY, float stretchX, float dist);
     
@@ -51,7 +61,6 @@ namespace alpr
     
   private:
     Config* config;
-    cv::Mat transform;
     
     cv::Mat getTransform(float w, float h, float rotationx, float rotationy, float rotationz, float panX, float panY, float stretchX, float dist);
     
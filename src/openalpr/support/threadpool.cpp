@@ -0,0 +1,128 @@
+#include "threadpool.h"
+
+#include <new>
+#include <stdexcept>
+
+namespace alpr
+{
+
+  struct ThreadPoolGroup
+  {
+    int pending;
+  };
+
+  void TaskError::record(const std::exception& e)
+  {
+    failed = true;
+    out_of_memory = dynamic_cast<const std::bad_alloc*>(&e) != NULL;
+    what = e.what();
+  }
+
+  void TaskError::rethrow()
+  {
+    if (out_of_memory)
+      throw std::bad_alloc();
+    if (failed)
+      throw std::runtime_error(what);
+  }
+
+  ThreadPool::ThreadPool(int num_threads)
+  {
+    stopping = false;
+
+    if (num_threads <= 0)
+      num_threads = (int) tthread::thread::hardware_concurrency();
+
+    // The thread calling runAll() does work too, so it doesn't need a worker of its own
+    for (int i = 1; i < num_threads; i++)
+      workers.push_back(new tthread::thread(ThreadPool::workerThread, (void*) this));
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    jobs_mutex.lock();
+    stopping = true;
+    jobs_available.notify_all();
+    jobs_mutex.unlock();
+
+    for (unsigned int i = 0; i < workers.size(); i++)
+    {
+      workers[i]->join();
+      delete workers[i];
+    }
+  }
+
+  int ThreadPool::size()
+  {
+    return workers.size() + 1;
+  }
+
+  void ThreadPool::runAll(ThreadPoolTask task, std::vector<void*> args)
+  {
+    if (args.size() == 0)
+      return;
+
+    ThreadPoolGroup group;
+    group.pending = args.size();
+
+    jobs_mutex.lock();
+
+    for (unsigned int i = 0; i < args.size(); i++)
+    {
+      ThreadPoolJob job;
+      job.task = task;
+      job.arg = args[i];
+      job.group = &group;
+      jobs.push(job);
+    }
+    jobs_available.notify_all();
+
+    // Help out until all of our own jobs are done
+    while (group.pending > 0)
+    {
+      if (!runNextJob())
+        jobs_finished.wait(jobs_mutex);
+    }
+
+    jobs_mutex.unlock();
+  }
+
+  // Must be called with jobs_mutex held.  Returns false if there was nothing to run
+  bool ThreadPool::runNextJob()
+  {
+    if (jobs.empty())
+      return false;
+
+    ThreadPoolJob job = jobs.front();
+    jobs.pop();
+
+    jobs_mutex.unlock();
+    job.task(job.arg);
+    jobs_mutex.lock();
+
+    job.group->pending--;
+    if (job.group->pending == 0)
+      jobs_finished.notify_all();
+
+    return true;
+  }
+
+  void ThreadPool::workerThread(void* arg)
+  {
+    ThreadPool* pool = (ThreadPool*) arg;
+
+    pool->jobs_mutex.lock();
+    while (true)
+    {
+      if (pool->runNextJob())
+        continue;
+
+      if (pool->stopping)
+        break;
+
+      pool->jobs_available.wait(pool->jobs_mutex);
+    }
+    pool->jobs_mutex.unlock();
+  }
+
+}
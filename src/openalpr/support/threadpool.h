@@ -0,0 +1,76 @@
+#ifndef OPENALPR_THREADPOOL_H
+#define OPENALPR_THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <string>
+#include <exception>
+
+#include "tinythread.h"
+
+namespace alpr
+{
+
+  typedef void (*ThreadPoolTask)(void* arg);
+
+  struct ThreadPoolGroup;
+
+  // An exception caught inside a task, kept so it can be rethrown on the thread that called runAll().
+  // std::bad_alloc is rethrown as itself and any other std::exception as a std::runtime_error with the same message
+  struct TaskError
+  {
+    TaskError() : failed(false), out_of_memory(false) {}
+
+    bool failed;
+    bool out_of_memory;
+    std::string what;
+
+    void record(const std::exception& e);
+
+    // Does nothing if no exception was recorded
+    void rethrow();
+  };
+
+  struct ThreadPoolJob
+  {
+    ThreadPoolTask task;
+    void* arg;
+    ThreadPoolGroup* group;
+  };
+
+  // A fixed set of worker threads that run tasks from a shared queue.
+  // runAll() blocks until every task it was given has finished.  The calling thread
+  // runs queued tasks while it waits, so tasks may themselves call runAll() on the same pool
+  // without deadlocking.  A pool of size 1 has no workers and runs everything on the calling thread.
+  // Tasks must not throw.  Catch errors inside the task and keep them (e.g., in a TaskError) for the caller to rethrow.
+  class ThreadPool
+  {
+    public:
+      // num_threads counts the calling thread.  0 uses one thread per hardware thread
+      ThreadPool(int num_threads = 0);
+      virtual ~ThreadPool();
+
+      void runAll(ThreadPoolTask task, std::vector<void*> args);
+
+      // Number of threads that can run tasks at once, including the calling thread
+      int size();
+
+    private:
+
+      std::vector<tthread::thread*> workers;
+      std::queue<ThreadPoolJob> jobs;
+
+      tthread::mutex jobs_mutex;
+      tthread::condition_variable jobs_available;
+      tthread::condition_variable jobs_finished;
+
+      bool stopping;
+
+      bool runNextJob();
+
+      static void workerThread(void* arg);
+  };
+
+}
+
+#endif // OPENALPR_THREADPOOL_H
@@ -55,7 +55,7 @@ namespace alpr
       bitwise_not(pipeline_data->crop_gray, pipeline_data->crop_gray);
 
     pipeline_data->clearThresholds();
-    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config);
+    pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, config, pipeline_data->mat_pool);
 
     timespec contoursStartTime;
     getTimeMonotonic(&contoursStartTime);
@@ -157,7 +157,7 @@ namespace alpr
     if (config->multiline && config->auto_invert && pipeline_data->plate_inverted)
     {
       bitwise_not(pipeline_data->crop_gray, pipeline_data->crop_gray);
-      pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, pipeline_data->config);
+      pipeline_data->thresholds = produceThresholds(pipeline_data->crop_gray, pipeline_data->config, pipeline_data->mat_pool);
     }
       
     
@@ -279,7 +279,7 @@ namespace alpr
 
   Mat CharacterAnalysis::getCharacterMask()
   {
-    Mat charMask = Mat::zeros(bestThreshold.size(), CV_8U);
+    Mat charMask = pipeline_data->borrowZeros(bestThreshold.size(), CV_8U);
 
     for (unsigned int i = 0; i < bestContours.size(); i++)
     {
@@ -497,7 +497,7 @@ namespace alpr
 
 
     // Create a white mask for the area inside the polygon
-    Mat outerMask = Mat::zeros(img.size(), CV_8U);
+    Mat outerMask = pipeline_data->borrowZeros(img.size(), CV_8U);
 
     for (unsigned int i = 0; i < textLines.size(); i++)
       fillConvexPoly(outerMask, textLines[i].linePolygon.data(), textLines[i].linePolygon.size(), Scalar(255,255,255));
@@ -575,8 +575,8 @@ namespace alpr
 
     cv::Mat plateMask = pipeline_data->plateBorderMask;
 
-    Mat tempMaskedContour = Mat::zeros(plateMask.size(), CV_8U);
-    Mat tempFullContour = Mat::zeros(plateMask.size(), CV_8U);
+    Mat tempMaskedContour = pipeline_data->borrowZeros(plateMask.size(), CV_8U);
+    Mat tempFullContour = pipeline_data->borrowZeros(plateMask.size(), CV_8U);
 
     int charsInsideMask = 0;
     int totalChars = 0;
@@ -591,7 +591,7 @@ namespace alpr
         continue;
 
       totalChars++;
-      tempFullContour = Mat::zeros(plateMask.size(), CV_8U);
+      tempFullContour = pipeline_data->borrowZeros(plateMask.size(), CV_8U);
       drawContours(tempFullContour, textContours.contours, i, Scalar(255,255,255), CV_FILLED, 8, textContours.hierarchy);
       bitwise_and(tempFullContour, plateMask, tempMaskedContour);
       
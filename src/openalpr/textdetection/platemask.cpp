@@ -112,7 +112,7 @@ namespace alpr
     if (winningIndex != -1 && bestCharCount >= 3)
     {
 
-      Mat mask = Mat::zeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
+      Mat mask = pipeline_data->borrowZeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
 
       // get rid of the outline by drawing a 1 pixel width black line
       drawContours(mask, contours[winningIndex].contours,
@@ -156,7 +156,7 @@ namespace alpr
 
       if (biggestContourIndex != -1)
       {
-        mask = Mat::zeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
+        mask = pipeline_data->borrowZeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
 
         vector<Point> smoothedMaskPoints;
         approxPolyDP(contoursSecondRound[biggestContourIndex], smoothedMaskPoints, 2, true);
@@ -177,7 +177,7 @@ namespace alpr
       if (pipeline_data->config->debugCharAnalysis)
       {
         vector<Mat> debugImgs;
-        Mat debugImgMasked = Mat::zeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
+        Mat debugImgMasked = pipeline_data->borrowZeros(pipeline_data->thresholds[winningIndex].size(), CV_8U);
 
         pipeline_data->thresholds[winningIndex].copyTo(debugImgMasked, mask);
 
@@ -193,7 +193,7 @@ namespace alpr
       this->plateMask = mask;
 	} else {
 	  hasPlateMask = false;
-	  Mat fullMask = Mat::zeros(pipeline_data->thresholds[0].size(), CV_8U);
+	  Mat fullMask = pipeline_data->borrowZeros(pipeline_data->thresholds[0].size(), CV_8U);
 	  bitwise_not(fullMask, fullMask);
 	  this->plateMask = fullMask;
 	}
@@ -119,7 +119,7 @@ namespace alpr
     }
   }
 
-  vector<Mat> produceThresholds(const Mat img_gray, Config* config)
+  vector<Mat> produceThresholds(const Mat img_gray, Config* config, MatPool* mat_pool)
   {
     const int THRESHOLD_COUNT = 3;
     //Mat img_equalized = equalizeBrightness(img_gray);
@@ -130,7 +130,12 @@ namespace alpr
     vector<Mat> thresholds;
 
     for (int i = 0; i < THRESHOLD_COUNT; i++)
-      thresholds.push_back(Mat(img_gray.size(), CV_8U));
+    {
+      if (mat_pool != NULL)
+        thresholds.push_back(mat_pool->get(img_gray.size(), CV_8U));
+      else
+        thresholds.push_back(Mat(img_gray.size(), CV_8U));
+    }
 
     int i = 0;
 
@@ -143,19 +148,19 @@ namespace alpr
     int k = 0, win=18;
     //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
     //bitwise_not(thresholds[i-1], thresholds[i-1]);
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
+    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35), BINARIZEWOLF_DEFAULTDR, mat_pool);
     bitwise_not(thresholds[i-1], thresholds[i-1]);
 
     k = 1;
     win = 22;
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
+    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35), BINARIZEWOLF_DEFAULTDR, mat_pool);
     bitwise_not(thresholds[i-1], thresholds[i-1]);
     //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], WOLFJOLION, win, win, 0.05 + (k * 0.35));
     //bitwise_not(thresholds[i-1], thresholds[i-1]);
 
     // Sauvola
     k = 1;
-    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], SAUVOLA, 12, 12, 0.18 * k);
+    NiblackSauvolaWolfJolion (img_gray, thresholds[i++], SAUVOLA, 12, 12, 0.18 * k, BINARIZEWOLF_DEFAULTDR, mat_pool);
     bitwise_not(thresholds[i-1], thresholds[i-1]);
     //k=2;
     //NiblackSauvolaWolfJolion (img_gray, thresholds[i++], SAUVOLA, 12, 12, 0.18 * k);
@@ -74,7 +74,8 @@ namespace alpr
 
   double median(int array[], int arraySize);
 
-  std::vector<cv::Mat> produceThresholds(const cv::Mat img_gray, Config* config);
+  // The thresholds are taken from mat_pool if one is given
+  std::vector<cv::Mat> produceThresholds(const cv::Mat img_gray, Config* config, MatPool* mat_pool = NULL);
 
   cv::Mat drawImageDashboard(std::vector<cv::Mat> images, int imageType, unsigned int numColumns);
 
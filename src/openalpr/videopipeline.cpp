@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "videopipeline.h"
+#include "alpr_impl.h"
+
+namespace alpr
+{
+
+  VideoPipeline::VideoPipeline(AlprImpl* impl, int queue_size)
+  {
+    this->impl = impl;
+    this->queue_size = queue_size > 0 ? queue_size : 1;
+
+    next_frame_number = 0;
+    pending_jobs = 0;
+    stopping = false;
+    detection_stopped = false;
+
+    detection_thread = new tthread::thread(VideoPipeline::detectionThread, (void*) this);
+    recognition_thread = new tthread::thread(VideoPipeline::recognitionThread, (void*) this);
+  }
+
+  VideoPipeline::~VideoPipeline()
+  {
+    std::deque<VideoPipelineJob> dropped_jobs;
+
+    jobs_mutex.lock();
+    stopping = true;
+    dropped_jobs.swap(detection_queue);
+    detection_available.notify_all();
+    detection_taken.notify_all();
+    recognition_taken.notify_all();
+    jobs_mutex.unlock();
+
+    // The detection thread hands its last frame to the recognition thread, which finishes everything it was given
+    detection_thread->join();
+    delete detection_thread;
+    recognition_thread->join();
+    delete recognition_thread;
+
+    // Dropped after the frames ahead of them, so the callbacks still run in order
+    for (unsigned int i = 0; i < dropped_jobs.size(); i++)
+      dropJob(dropped_jobs[i]);
+  }
+
+  bool VideoPipeline::submit(AlprFrame frame, AlprAsyncCallback callback, void* user_data)
+  {
+    VideoPipelineJob job(frame);
+    job.callback = callback;
+    job.user_data = user_data;
+    job.batch = NULL;
+    job.failed = false;
+    job.processed = true;
+
+    tthread::lock_guard<tthread::mutex> guard(jobs_mutex);
+
+    while ((int) detection_queue.size() >= queue_size && !stopping)
+      detection_taken.wait(jobs_mutex);
+
+    if (stopping)
+      return false;
+
+    job.frame_number = next_frame_number++;
+    detection_queue.push_back(job);
+    pending_jobs++;
+    detection_available.notify_one();
+
+    return true;
+  }
+
+  void VideoPipeline::waitForIdle()
+  {
+    tthread::lock_guard<tthread::mutex> guard(jobs_mutex);
+
+    while (pending_jobs > 0)
+      job_finished.wait(jobs_mutex);
+  }
+
+  // Decodes the frame and finds its plate regions for every country and analysis_count iteration.  
+  // Early exit needs the plates from one pass before starting the next, so it is not used here
+  void VideoPipeline::detectFrame(VideoPipelineJob& job)
+  {
+    job.batch = new AnalysisBatch();
+    job.batch->earlyExit = false;
+
+    ThreadPool* framePool = NULL;
+    if (impl->config->parallelAnalysisPasses)
+      framePool = impl->getThreadPool();
+
+    try
+    {
+      job.batch->frames.push_back(impl->createAnalysisFrame(job.frame));
+      impl->prepareBatch(*job.batch, framePool);
+      impl->detectPlates(impl->getBatchPasses(*job.batch), framePool);
+    }
+    catch (cv::Exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR video pipeline detection: " << e.msg << std::endl;
+      job.failed = true;
+    }
+    catch (std::exception& e)
+    {
+      std::cerr << "Caught exception in OpenALPR video pipeline detection: " << e.what() << std::endl;
+      job.failed = true;
+      job.processed = false;
+    }
+  }
+
+  // Reads the plates in the regions found by detectFrame() and returns the results
+  void VideoPipeline::recognizeFrame(VideoPipelineJob& job)
+  {
+    ThreadPool* regionPool = NULL;
+    if (impl->config->parallelAnalysisPasses || impl->config->parallelPlateRegions)
+      regionPool = impl->getThreadPool();
+
+    AlprResults results;
+    results.epoch_time = 0;
+    results.img_width = 0;
+    results.img_height = 0;
+    results.total_processing_time_ms = 0;
+
+    if (!job.failed)
+    {
+      try
+      {
+        impl->analyzePlateRegions(impl->getBatchPasses(*job.batch), regionPool);
+        results = impl->aggregateBatch(*job.batch)[0].results;
+      }
+      catch (cv::Exception& e)
+      {
+        std::cerr << "Caught exception in OpenALPR video pipeline recognition: " << e.msg << std::endl;
+      }
+      catch (std::exception& e)
+      {
+        std::cerr << "Caught exception in OpenALPR video pipeline recognition: " << e.what() << std::endl;
+        job.processed = false;
+      }
+    }
+
+    // Already released unless a stage failed.  Released before the callback, which may change the config
+    impl->releaseBatchFrames(*job.batch);
+    delete job.batch;
+    job.batch = NULL;
+
+    results.frame_number = job.frame_number;
+    job.callback(results, job.processed, job.user_data);
+  }
+
+  void VideoPipeline::dropJob(VideoPipelineJob& job)
+  {
+    AlprResults results;
+    results.frame_number = job.frame_number;
+    results.epoch_time = 0;
+    results.img_width = 0;
+    results.img_height = 0;
+    results.total_processing_time_ms = 0;
+
+    job.callback(results, false, job.user_data);
+  }
+
+  void VideoPipeline::detectionThread(void* arg)
+  {
+    VideoPipeline* pipeline = (VideoPipeline*) arg;
+
+    pipeline->jobs_mutex.lock();
+    while (true)
+    {
+      if (pipeline->detection_queue.empty())
+      {
+        if (pipeline->stopping)
+          break;
+
+        pipeline->detection_available.wait(pipeline->jobs_mutex);
+        continue;
+      }
+
+      VideoPipelineJob job = pipeline->detection_queue.front();
+      pipeline->detection_queue.pop_front();
+      pipeline->detection_taken.notify_one();
+      pipeline->jobs_mutex.unlock();
+
+      pipeline->detectFrame(job);
+
+      pipeline->jobs_mutex.lock();
+      while ((int) pipeline->recognition_queue.size() >= pipeline->queue_size && !pipeline->stopping)
+        pipeline->recognition_taken.wait(pipeline->jobs_mutex);
+
+      pipeline->recognition_queue.push_back(job);
+      pipeline->recognition_available.notify_one();
+    }
+
+    pipeline->detection_stopped = true;
+    pipeline->recognition_available.notify_all();
+    pipeline->jobs_mutex.unlock();
+  }
+
+  void VideoPipeline::recognitionThread(void* arg)
+  {
+    VideoPipeline* pipeline = (VideoPipeline*) arg;
+
+    pipeline->jobs_mutex.lock();
+    while (true)
+    {
+      if (pipeline->recognition_queue.empty())
+      {
+        if (pipeline->detection_stopped)
+          break;
+
+        pipeline->recognition_available.wait(pipeline->jobs_mutex);
+        continue;
+      }
+
+      VideoPipelineJob job = pipeline->recognition_queue.front();
+      pipeline->recognition_queue.pop_front();
+      pipeline->recognition_taken.notify_one();
+      pipeline->jobs_mutex.unlock();
+
+      pipeline->recognizeFrame(job);
+
+      pipeline->jobs_mutex.lock();
+      pipeline->pending_jobs--;
+      pipeline->job_finished.notify_all();
+    }
+    pipeline->jobs_mutex.unlock();
+  }
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2015 OpenALPR Technology, Inc.
+ * Open source Automated License Plate Recognition [http://www.openalpr.com]
+ *
+ * This file is part of OpenALPR.
+ *
+ * OpenALPR is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License
+ * version 3 as published by the Free Software Foundation
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef OPENALPR_VIDEOPIPELINE_H
+#define OPENALPR_VIDEOPIPELINE_H
+
+#include <deque>
+
+#include "alpr.h"
+#include "support/tinythread.h"
+
+namespace alpr
+{
+
+  class AlprImpl;
+  struct AnalysisBatch;
+
+  struct VideoPipelineJob
+  {
+    AlprFrame frame;
+    AlprAsyncCallback callback;
+    void* user_data;
+    int64_t frame_number;
+
+    // The frame and the plate regions found in it.  Set by the detection stage
+    AnalysisBatch* batch;
+    bool failed;
+
+    // False if a stage threw anything other than a cv::Exception (e.g., out of memory)
+    bool processed;
+
+    VideoPipelineJob(AlprFrame frame) : frame(frame) {}
+  };
+
+  // Runs Alpr::recognizeVideoFrame() requests as a two-stage pipeline.  One thread finds the plate 
+  // regions in a frame while a second thread reads the plates found in the frames before it.  
+  // Each stage has a queue of at most queue_size frames.  Frames pass through both stages in the order 
+  // they were submitted, so the results are returned in order.
+  class VideoPipeline
+  {
+    public:
+      VideoPipeline(AlprImpl* impl, int queue_size);
+
+      // Frames that are still waiting for detection are dropped.  Frames that have been detected are finished first
+      virtual ~VideoPipeline();
+
+      // Blocks while the detection queue is full.  Returns false if the pipeline is shutting down
+      bool submit(AlprFrame frame, AlprAsyncCallback callback, void* user_data);
+
+      // Blocks until every submitted frame has been returned.  Must not be called from a callback
+      void waitForIdle();
+
+    private:
+      AlprImpl* impl;
+      int queue_size;
+
+      tthread::thread* detection_thread;
+      tthread::thread* recognition_thread;
+
+      std::deque<VideoPipelineJob> detection_queue;
+      std::deque<VideoPipelineJob> recognition_queue;
+      int64_t next_frame_number;
+      int pending_jobs;
+      bool stopping;
+      bool detection_stopped;
+
+      tthread::mutex jobs_mutex;
+      tthread::condition_variable detection_available;
+      tthread::condition_variable detection_taken;
+      tthread::condition_variable recognition_available;
+      tthread::condition_variable recognition_taken;
+      tthread::condition_variable job_finished;
+
+      void detectFrame(VideoPipelineJob& job);
+      void recognizeFrame(VideoPipelineJob& job);
+
+      static void dropJob(VideoPipelineJob& job);
+      static void detectionThread(void* arg);
+      static void recognitionThread(void* arg);
+  };
+
+}
+
+#endif // OPENALPR_VIDEOPIPELINE_H
@@ -24,6 +24,9 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
   origResults.img_width = 640;
   origResults.img_height = 480;
   origResults.total_processing_time_ms = 100;
+  origResults.stage_timing.detection = 40.5;
+  origResults.stage_timing.ocr = 12.25;
+  origResults.stage_timing.aggregation = 0.5;
   origResults.regionsOfInterest.push_back(AlprRegionOfInterest(0,0,100,200));
   origResults.regionsOfInterest.push_back(AlprRegionOfInterest(259,260,50,150));
   
@@ -46,6 +49,8 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
   }
   
   apr.processing_time_ms = 30;
+  apr.stage_timing.char_analysis = 6.5;
+  apr.stage_timing.deskew = 1.25;
   apr.requested_topn = 10;
   apr.region = "mo";
   apr.regionConfidence = 80;
@@ -60,6 +65,10 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
   REQUIRE( roundTrip.img_width == origResults.img_width );
   REQUIRE( roundTrip.img_height == origResults.img_height );
   REQUIRE( roundTrip.total_processing_time_ms == origResults.total_processing_time_ms );
+  REQUIRE( roundTrip.stage_timing.detection == origResults.stage_timing.detection );
+  REQUIRE( roundTrip.stage_timing.ocr == origResults.stage_timing.ocr );
+  REQUIRE( roundTrip.stage_timing.aggregation == origResults.stage_timing.aggregation );
+  REQUIRE( roundTrip.stage_timing.segmentation == 0 );
   
   REQUIRE( roundTrip.regionsOfInterest.size() == origResults.regionsOfInterest.size() );
   for (int i = 0; i < roundTrip.regionsOfInterest.size(); i++)
@@ -74,6 +83,8 @@ TEST_CASE( "JSON Serialization/Deserialization", "[json]" ) {
   for (int i = 0; i < roundTrip.plates.size(); i++)
   {
     REQUIRE( roundTrip.plates[i].processing_time_ms == origResults.plates[i].processing_time_ms);
+    REQUIRE( roundTrip.plates[i].stage_timing.char_analysis == origResults.plates[i].stage_timing.char_analysis);
+    REQUIRE( roundTrip.plates[i].stage_timing.deskew == origResults.plates[i].stage_timing.deskew);
     REQUIRE( roundTrip.plates[i].region == origResults.plates[i].region);
     REQUIRE( roundTrip.plates[i].regionConfidence == origResults.plates[i].regionConfidence);
     REQUIRE( roundTrip.plates[i].requested_topn == origResults.plates[i].requested_topn);
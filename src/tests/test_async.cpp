@@ -0,0 +1,165 @@
+/*
+ * File:   test_async.cpp
+ *
+ * Tests for the queue and drop policies of asynchronous recognition
+ */
+
+#include <cstdlib>
+#include "catch.hpp"
+#include "alpr_impl.h"
+#include "asyncrecognizer.h"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// Collects the callbacks.  The callback for the first frame holds up the only recognition thread
+// until released, so that the queue fills up behind it
+struct AsyncRecorder
+{
+  AsyncRecorder() : first_started(false), released(false) {}
+
+  tthread::mutex mutex;
+  tthread::condition_variable changed;
+
+  bool first_started;
+  bool released;
+
+  vector<int64_t> processed_frames;
+  vector<int64_t> dropped_frames;
+};
+
+static void recordResults(AlprResults results, bool processed, void* user_data)
+{
+  AsyncRecorder* recorder = (AsyncRecorder*) user_data;
+  tthread::lock_guard<tthread::mutex> guard(recorder->mutex);
+
+  if (processed)
+    recorder->processed_frames.push_back(results.frame_number);
+  else
+    recorder->dropped_frames.push_back(results.frame_number);
+
+  if (!recorder->first_started)
+  {
+    recorder->first_started = true;
+    recorder->changed.notify_all();
+
+    while (!recorder->released)
+      recorder->changed.wait(recorder->mutex);
+  }
+}
+
+static void waitForFirstFrame(AsyncRecorder& recorder)
+{
+  tthread::lock_guard<tthread::mutex> guard(recorder.mutex);
+  while (!recorder.first_started)
+    recorder.changed.wait(recorder.mutex);
+}
+
+static void releaseFirstFrame(void* arg)
+{
+  AsyncRecorder* recorder = (AsyncRecorder*) arg;
+  tthread::lock_guard<tthread::mutex> guard(recorder->mutex);
+  recorder->released = true;
+  recorder->changed.notify_all();
+}
+
+static void releaseFirstFrameLater(void* arg)
+{
+  tthread::this_thread::sleep_for(tthread::chrono::milliseconds(100));
+  releaseFirstFrame(arg);
+}
+
+TEST_CASE( "Async drop newest", "[async]" ) {
+
+  AlprImpl alpr("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  Mat blank = Mat::zeros(120, 160, CV_8UC3);
+  AlprFrame frame(blank.data, blank.channels(), blank.cols, blank.rows);
+
+  AsyncRecorder recorder;
+  AsyncRecognizer recognizer(&alpr, 1, 2, ASYNC_DROP_NEWEST);
+
+  REQUIRE( recognizer.submit(frame, recordResults, &recorder) );
+  waitForFirstFrame(recorder);
+
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+  // The queue is full, so the new frame is turned away and its callback is never called
+  CHECK( recognizer.submit(frame, recordResults, &recorder) == false );
+
+  releaseFirstFrame(&recorder);
+  recognizer.waitForIdle();
+
+  REQUIRE( recorder.processed_frames.size() == 3 );
+  for (unsigned int i = 0; i < recorder.processed_frames.size(); i++)
+    REQUIRE( recorder.processed_frames[i] == (int64_t) i );
+  REQUIRE( recorder.dropped_frames.size() == 0 );
+}
+
+TEST_CASE( "Async drop oldest", "[async]" ) {
+
+  AlprImpl alpr("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  Mat blank = Mat::zeros(120, 160, CV_8UC3);
+  AlprFrame frame(blank.data, blank.channels(), blank.cols, blank.rows);
+
+  AsyncRecorder recorder;
+  AsyncRecognizer recognizer(&alpr, 1, 2, ASYNC_DROP_OLDEST);
+
+  REQUIRE( recognizer.submit(frame, recordResults, &recorder) );
+  waitForFirstFrame(recorder);
+
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+
+  // Frame 1 has waited longest, so it makes room and is returned unprocessed straight away
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+  {
+    tthread::lock_guard<tthread::mutex> guard(recorder.mutex);
+    CHECK( recorder.dropped_frames == vector<int64_t>(1, 1) );
+  }
+
+  releaseFirstFrame(&recorder);
+  recognizer.waitForIdle();
+
+  REQUIRE( recorder.processed_frames.size() == 3 );
+  REQUIRE( recorder.processed_frames[0] == 0 );
+  REQUIRE( recorder.processed_frames[1] == 2 );
+  REQUIRE( recorder.processed_frames[2] == 3 );
+  REQUIRE( recorder.dropped_frames.size() == 1 );
+}
+
+TEST_CASE( "Async block", "[async]" ) {
+
+  AlprImpl alpr("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  Mat blank = Mat::zeros(120, 160, CV_8UC3);
+  AlprFrame frame(blank.data, blank.channels(), blank.cols, blank.rows);
+
+  AsyncRecorder recorder;
+  AsyncRecognizer recognizer(&alpr, 1, 1, ASYNC_BLOCK);
+
+  REQUIRE( recognizer.submit(frame, recordResults, &recorder) );
+  waitForFirstFrame(recorder);
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+
+  // The queue only has space again once the recognition thread is released and takes frame 1
+  tthread::thread releaser(releaseFirstFrameLater, (void*) &recorder);
+  CHECK( recognizer.submit(frame, recordResults, &recorder) );
+  {
+    tthread::lock_guard<tthread::mutex> guard(recorder.mutex);
+    CHECK( recorder.released );
+  }
+  releaser.join();
+
+  recognizer.waitForIdle();
+
+  REQUIRE( recorder.processed_frames.size() == 3 );
+  for (unsigned int i = 0; i < recorder.processed_frames.size(); i++)
+    REQUIRE( recorder.processed_frames[i] == (int64_t) i );
+  REQUIRE( recorder.dropped_frames.size() == 0 );
+}
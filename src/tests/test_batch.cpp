@@ -0,0 +1,55 @@
+/* 
+ * File:   test_batch.cpp
+ *
+ * Tests for recognizing batches of frames
+ */
+
+#include <cstdlib>
+#include "catch.hpp"
+#include "alpr_impl.h"
+#include "opencv2/highgui/highgui.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+TEST_CASE( "Early exit in batches", "[batch]" ) {
+
+  AlprImpl alpr("us,eu", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  // Any plate that is found is good enough to stop at the first country
+  Config* config = alpr.getConfig();
+  config->skipDetection = true;
+  config->analysis_count = 1;
+  config->earlyExitConfidence = 1;
+  config->earlyExitMustMatchPattern = false;
+  config->parallelAnalysisPasses = false;
+  alpr.applyConfig();
+
+  // A clean, tightly cropped plate
+  Mat plate = imread(std::string(OPENALPR_TESTING_RUNTIME_DIR) + "keypoints/us/ct2000.jpg");
+  REQUIRE( plate.data != NULL );
+
+  vector<AlprFrame> frames;
+  frames.push_back(AlprFrame(plate.data, plate.channels(), plate.cols, plate.rows));
+  frames.push_back(AlprFrame(plate.data, plate.channels(), plate.cols, plate.rows));
+
+  vector<AlprFullDetails> details = alpr.recognizeBatchFullDetails(frames);
+  REQUIRE( details.size() == 2 );
+  for (unsigned int i = 0; i < details.size(); i++)
+  {
+    REQUIRE( details[i].results.plates.size() > 0 );
+    REQUIRE( details[i].passesAnalyzed == 1 );
+  }
+
+  // Every country is analyzed when the passes run at the same time
+  config = alpr.getConfig();
+  config->parallelAnalysisPasses = true;
+  alpr.applyConfig();
+
+  details = alpr.recognizeBatchFullDetails(frames);
+  REQUIRE( details.size() == 2 );
+  for (unsigned int i = 0; i < details.size(); i++)
+    REQUIRE( details[i].passesAnalyzed == 2 );
+}
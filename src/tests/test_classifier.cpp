@@ -0,0 +1,50 @@
+/* 
+ * File:   test_classifier.cpp
+ *
+ * Tests for the nearest-neighbor character classifier
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include "ocr/characterclassifier.h"
+#include "catch.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+TEST_CASE( "Character classifier", "[classifier]" ) {
+
+  // A bar and a ring, drawn white on black
+  Mat one = Mat::zeros(40, 24, CV_8U);
+  rectangle(one, Rect(10, 4, 5, 32), Scalar(255), -1);
+  Mat zero = Mat::zeros(40, 24, CV_8U);
+  rectangle(zero, Rect(4, 4, 16, 32), Scalar(255), 4);
+
+  CharacterClassifier classifier;
+  REQUIRE( classifier.addExample("1", one) == true );
+  REQUIRE( classifier.addExample("0", zero) == true );
+  // The same image again adds nothing
+  REQUIRE( classifier.addExample("1", one) == false );
+  REQUIRE( classifier.size() == 2 );
+
+  // Black on white and at another size still matches
+  Mat inverted_zero;
+  bitwise_not(zero, inverted_zero);
+  resize(inverted_zero, inverted_zero, Size(30, 50));
+
+  vector<CharacterMatch> matches = classifier.classify(inverted_zero, 4);
+  REQUIRE( matches.size() == 2 );
+  REQUIRE( matches[0].letter == "0" );
+  REQUIRE( matches[0].confidence > matches[1].confidence );
+
+  // Written to the directory the tests run from
+  std::string model_file = "openalpr_test.charmodel";
+  REQUIRE( classifier.save(model_file) == true );
+
+  CharacterClassifier loaded;
+  REQUIRE( loaded.load(model_file) == true );
+  REQUIRE( loaded.size() == 2 );
+  REQUIRE( loaded.classify(one, 1)[0].letter == "1" );
+  remove(model_file.c_str());
+}
@@ -0,0 +1,51 @@
+/* 
+ * File:   test_glyphcache.cpp
+ *
+ * Tests for the cache of recently recognized character images
+ */
+
+#include <cstdlib>
+#include "ocr/glyphcache.h"
+#include "catch.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+TEST_CASE( "Glyph cache eviction", "[glyphcache]" ) {
+
+  GlyphCache cache(2);
+
+  Mat glyph_a = Mat::zeros(40, 20, CV_8U);
+  Mat glyph_b = Mat::zeros(40, 20, CV_8U);
+  rectangle(glyph_b, Rect(5, 5, 10, 30), Scalar(255), -1);
+  Mat glyph_c = Mat::zeros(40, 28, CV_8U);
+
+  REQUIRE( GlyphCache::getKey(glyph_a) != GlyphCache::getKey(glyph_b) );
+  // The same image at a different size is a different glyph
+  REQUIRE( GlyphCache::getKey(glyph_a) != GlyphCache::getKey(glyph_c) );
+
+  vector<OcrChar> chars(1);
+  chars[0].letter = "A";
+  chars[0].char_index = 3;
+  chars[0].confidence = 90;
+
+  vector<OcrChar> found;
+  REQUIRE( cache.lookup(GlyphCache::getKey(glyph_a), found) == false );
+  cache.add(GlyphCache::getKey(glyph_a), chars, 10);
+  cache.add(GlyphCache::getKey(glyph_b), chars, 10);
+
+  REQUIRE( cache.lookup(GlyphCache::getKey(glyph_a), found) == true );
+  REQUIRE( found.size() == 1 );
+  REQUIRE( found[0].letter == "A" );
+
+  // b is the least recently used, so it is dropped to make room for c
+  cache.add(GlyphCache::getKey(glyph_c), chars, 10);
+  REQUIRE( cache.lookup(GlyphCache::getKey(glyph_b), found) == false );
+  REQUIRE( cache.lookup(GlyphCache::getKey(glyph_a), found) == true );
+
+  GlyphCacheStats stats = cache.getStats();
+  REQUIRE( stats.size == 2 );
+  REQUIRE( stats.hits == 2 );
+  REQUIRE( stats.misses == 2 );
+}
@@ -0,0 +1,171 @@
+/*
+ * File:   test_modelregistry.cpp
+ *
+ * Tests for the models shared between instances through the model registry
+ */
+
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include "modelregistry.h"
+#include "detection/detectorcpu.h"
+#include "ocr/tesseract_ocr.h"
+#include "support/tinythread.h"
+#include "catch.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// Tracks which copies of a pooled model are borrowed, to catch one being handed to two threads at once
+template <class Pool>
+struct PoolContention
+{
+  PoolContention(Pool* pool) : pool(pool), handed_out_twice(false), missing_copies(0) {}
+
+  Pool* pool;
+  tthread::mutex held_mutex;
+  std::set<void*> held;
+  bool handed_out_twice;
+  int missing_copies;
+};
+
+template <class Pool, class Copy>
+static void borrowRepeatedly(void* arg)
+{
+  PoolContention<Pool>* contention = (PoolContention<Pool>*) arg;
+
+  for (int i = 0; i < 25; i++)
+  {
+    Copy* copy = contention->pool->acquire();
+    {
+      tthread::lock_guard<tthread::mutex> guard(contention->held_mutex);
+      if (copy == NULL)
+        contention->missing_copies++;
+      else if (!contention->held.insert(copy).second)
+        contention->handed_out_twice = true;
+    }
+
+    tthread::this_thread::yield();
+
+    // Forget it before it goes back, since another thread may borrow it straight away
+    {
+      tthread::lock_guard<tthread::mutex> guard(contention->held_mutex);
+      contention->held.erase(copy);
+    }
+    contention->pool->release(copy);
+  }
+}
+
+template <class Pool, class Copy>
+static void borrowFromThreads(PoolContention<Pool>& contention, int num_threads)
+{
+  vector<tthread::thread*> threads;
+  for (int i = 0; i < num_threads; i++)
+    threads.push_back(new tthread::thread(borrowRepeatedly<Pool, Copy>, (void*) &contention));
+
+  for (unsigned int i = 0; i < threads.size(); i++)
+  {
+    threads[i]->join();
+    delete threads[i];
+  }
+}
+
+// Borrows every copy the pool holds.  If any copy had not been returned, the pool would load another
+template <class Pool, class Copy>
+static void requireAllReturned(Pool* pool)
+{
+  int copies = pool->loadedCopies();
+
+  vector<Copy*> borrowed;
+  for (int i = 0; i < copies; i++)
+    borrowed.push_back(pool->acquire());
+  REQUIRE( pool->loadedCopies() == copies );
+
+  for (unsigned int i = 0; i < borrowed.size(); i++)
+    pool->release(borrowed[i]);
+}
+
+TEST_CASE( "Model registry sharing", "[modelregistry]" ) {
+
+  std::string key = ModelRegistry::getKey("test", "/nonexistent/model.file", "settings");
+  REQUIRE( ModelRegistry::acquire(key) == NULL );
+
+  ModelRegistryStats before = ModelRegistry::getStats();
+
+  SharedModel* first = ModelRegistry::add(key, new SharedObject<int>(new int(5)), 1024);
+
+  // A second load of the same model is discarded in favor of the one already registered
+  SharedModel* duplicate = ModelRegistry::add(key, new SharedObject<int>(new int(6)), 1024);
+  REQUIRE( duplicate == first );
+  REQUIRE( ModelRegistry::acquire(key) == first );
+
+  ModelRegistryStats shared = ModelRegistry::getStats();
+  REQUIRE( shared.models == before.models + 1 );
+  REQUIRE( shared.references == before.references + 3 );
+  REQUIRE( shared.bytes_saved == before.bytes_saved + 2048 );
+
+  ModelRegistry::release(first);
+  ModelRegistry::release(first);
+  REQUIRE( ModelRegistry::acquire(key) == first );
+  ModelRegistry::release(first);
+  ModelRegistry::release(first);
+
+  REQUIRE( ModelRegistry::acquire(key) == NULL );
+  REQUIRE( ModelRegistry::getStats().models == before.models );
+}
+
+TEST_CASE( "Model registry file keys", "[modelregistry]" ) {
+
+  // Written to the directory the tests run from
+  std::string model_file = "openalpr_test.model";
+  {
+    std::ofstream out(model_file.c_str());
+    out << "first version";
+  }
+
+  std::string key = ModelRegistry::getKey("test", model_file);
+  REQUIRE( ModelRegistry::getKey("test", model_file) == key );
+  REQUIRE( ModelRegistry::getKey("test", model_file, "settings") != key );
+
+  // A different size means new contents, even if the modification time hasn't moved on
+  {
+    std::ofstream out(model_file.c_str());
+    out << "second, longer version";
+  }
+  REQUIRE( ModelRegistry::getKey("test", model_file) != key );
+
+  remove(model_file.c_str());
+  REQUIRE( ModelRegistry::getKey("test", model_file) != key );
+}
+
+TEST_CASE( "Cascade pool contention", "[modelregistry]" ) {
+
+  CascadePool cascades(std::string(OPENALPR_TESTING_RUNTIME_DIR) + "region/us.xml");
+  REQUIRE( cascades.isLoaded() );
+
+  PoolContention<CascadePool> contention(&cascades);
+  borrowFromThreads<CascadePool, cv::CascadeClassifier>(contention, 4);
+
+  REQUIRE( contention.handed_out_twice == false );
+  REQUIRE( contention.missing_copies == 0 );
+  // A copy is only loaded when all of the others are borrowed
+  REQUIRE( cascades.loadedCopies() >= 1 );
+  REQUIRE( cascades.loadedCopies() <= 4 );
+  requireAllReturned<CascadePool, cv::CascadeClassifier>(&cascades);
+}
+
+TEST_CASE( "Tesseract handle pool contention", "[modelregistry]" ) {
+
+  TesseractHandlePool handles(std::string(OPENALPR_TESTING_RUNTIME_DIR) + "ocr/", "lus");
+
+  PoolContention<TesseractHandlePool> contention(&handles);
+  borrowFromThreads<TesseractHandlePool, tesseract::TessBaseAPI>(contention, 4);
+
+  REQUIRE( contention.handed_out_twice == false );
+  REQUIRE( contention.missing_copies == 0 );
+  REQUIRE( handles.loadedCopies() >= 1 );
+  REQUIRE( handles.loadedCopies() <= 4 );
+  requireAllReturned<TesseractHandlePool, tesseract::TessBaseAPI>(&handles);
+}
@@ -0,0 +1,44 @@
+/*
+ * File:   test_ocr.cpp
+ *
+ * Tests for the order the OCR threshold images are read in
+ */
+
+#include <cstdlib>
+#include "ocr/ocr.h"
+#include "catch.hpp"
+
+using namespace std;
+using namespace alpr;
+
+TEST_CASE( "Threshold order", "[ocr]" ) {
+
+  ThresholdStats stats;
+
+  vector<int> first_only(1, 0);
+  vector<float> first_useful(3, 0);
+  first_useful[0] = 10;
+
+  // Threshold 0 is always good enough, so early exit never reads the others
+  for (int i = 1; i < 20; i++)
+  {
+    vector<int> order = stats.getOrder(3);
+    REQUIRE( order.size() == 3 );
+    REQUIRE( order[0] == 0 );
+    stats.addPlate(first_only, first_useful);
+  }
+
+  // Every 20th plate starts with a threshold that hasn't been read.  1 and 2 are tied, so the lower ranked one goes first
+  vector<int> order = stats.getOrder(3);
+  REQUIRE( order[0] == 2 );
+  REQUIRE( order[1] == 0 );
+  REQUIRE( order[2] == 1 );
+
+  // Once it turns out to be more useful, it stays first
+  vector<int> last_only(1, 2);
+  vector<float> last_useful(3, 0);
+  last_useful[2] = 30;
+  stats.addPlate(last_only, last_useful);
+
+  REQUIRE( stats.getOrder(3)[0] == 2 );
+}
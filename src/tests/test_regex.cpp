@@ -2,6 +2,8 @@
 #include "utility.h"
 #include "catch.hpp"
 #include "postprocess/regexrule.h"
+#include "postprocess/postprocess.h"
+#include "config.h"
 
 using namespace std;
 using namespace cv;
@@ -105,4 +107,36 @@ TEST_CASE( "Invalid tests", "[Regex]" ) {
   
   RegexRule rule2("us", "A####]", "\\pL", "\\pN");
   REQUIRE( rule2.match("A1234") == false);
-}
\ No newline at end of file
+}
+
+TEST_CASE( "Best plate only", "[PostProcess]" ) {
+  Config config("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+
+  // The same two choices for each of five characters, analyzed for every candidate and for the best plate only
+  PostProcess allPlates(&config);
+  PostProcess bestPlate(&config);
+  PostProcess* postProcessors[2] = { &allPlates, &bestPlate };
+
+  const char* best_letters[] = { "A", "B", "C", "1", "2" };
+  const char* other_letters[] = { "4", "8", "G", "I", "Z" };
+  for (int p = 0; p < 2; p++)
+  {
+    postProcessors[p]->setConfidenceThreshold(65, 80);
+    for (int i = 0; i < 5; i++)
+    {
+      postProcessors[p]->addLetter(best_letters[i], 0, i, 95 - i);
+      postProcessors[p]->addLetter(other_letters[i], 0, i, 85 - i);
+    }
+  }
+
+  allPlates.analyze("", 10);
+  bestPlate.analyze("", 10, true);
+
+  vector<PPResult> all_results = allPlates.getResults();
+  vector<PPResult> best_results = bestPlate.getResults();
+  REQUIRE( all_results.size() > 1 );
+  REQUIRE( best_results.size() == 1 );
+  REQUIRE( best_results[0].letters == "ABC12" );
+  REQUIRE( best_results[0].letters == all_results[0].letters );
+  REQUIRE( best_results[0].totalscore == all_results[0].totalscore );
+}
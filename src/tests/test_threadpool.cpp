@@ -0,0 +1,125 @@
+/*
+ * File:   test_threadpool.cpp
+ *
+ * Tests for the thread pool that batch and parallel recognition run on
+ */
+
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include "support/threadpool.h"
+#include "catch.hpp"
+
+using namespace std;
+using namespace alpr;
+
+struct CountingTask
+{
+  CountingTask() : runs(0), pool(NULL), children(0) {}
+
+  int runs;
+  tthread::thread::id ran_on;
+
+  // If set, the task runs this many children of its own on the pool
+  ThreadPool* pool;
+  int children;
+  vector<CountingTask> child_tasks;
+};
+
+static void countingTask(void* arg)
+{
+  CountingTask* task = (CountingTask*) arg;
+  task->runs++;
+  task->ran_on = tthread::this_thread::get_id();
+
+  if (task->pool == NULL || task->children == 0)
+    return;
+
+  task->child_tasks.resize(task->children);
+  vector<void*> args;
+  for (unsigned int i = 0; i < task->child_tasks.size(); i++)
+    args.push_back(&task->child_tasks[i]);
+  task->pool->runAll(countingTask, args);
+}
+
+static vector<void*> taskArgs(vector<CountingTask>& tasks)
+{
+  vector<void*> args;
+  for (unsigned int i = 0; i < tasks.size(); i++)
+    args.push_back(&tasks[i]);
+  return args;
+}
+
+TEST_CASE( "Thread pool runs every task once", "[threadpool]" ) {
+
+  ThreadPool pool(4);
+  REQUIRE( pool.size() == 4 );
+
+  vector<CountingTask> tasks(100);
+  pool.runAll(countingTask, taskArgs(tasks));
+
+  for (unsigned int i = 0; i < tasks.size(); i++)
+    REQUIRE( tasks[i].runs == 1 );
+
+  // Nothing to do returns straight away
+  pool.runAll(countingTask, vector<void*>());
+}
+
+TEST_CASE( "Thread pool nested runAll", "[threadpool]" ) {
+
+  // More outer tasks than threads, so every thread ends up waiting on its own children
+  ThreadPool pool(2);
+
+  vector<CountingTask> tasks(8);
+  for (unsigned int i = 0; i < tasks.size(); i++)
+  {
+    tasks[i].pool = &pool;
+    tasks[i].children = 5;
+  }
+  pool.runAll(countingTask, taskArgs(tasks));
+
+  for (unsigned int i = 0; i < tasks.size(); i++)
+  {
+    REQUIRE( tasks[i].runs == 1 );
+    REQUIRE( tasks[i].child_tasks.size() == 5 );
+    for (unsigned int j = 0; j < tasks[i].child_tasks.size(); j++)
+      REQUIRE( tasks[i].child_tasks[j].runs == 1 );
+  }
+}
+
+TEST_CASE( "Thread pool of size 1", "[threadpool]" ) {
+
+  ThreadPool pool(1);
+  REQUIRE( pool.size() == 1 );
+
+  vector<CountingTask> tasks(10);
+  tasks[0].pool = &pool;
+  tasks[0].children = 3;
+  pool.runAll(countingTask, taskArgs(tasks));
+
+  // There are no workers, so everything runs on the calling thread
+  for (unsigned int i = 0; i < tasks.size(); i++)
+  {
+    REQUIRE( tasks[i].runs == 1 );
+    REQUIRE( tasks[i].ran_on == tthread::this_thread::get_id() );
+  }
+  for (unsigned int i = 0; i < tasks[0].child_tasks.size(); i++)
+    REQUIRE( tasks[0].child_tasks[i].ran_on == tthread::this_thread::get_id() );
+}
+
+TEST_CASE( "Task errors are rethrown", "[threadpool]" ) {
+
+  TaskError none;
+  none.rethrow();
+
+  TaskError failure;
+  failure.record(std::runtime_error("bad region"));
+  REQUIRE( failure.failed );
+  REQUIRE( failure.out_of_memory == false );
+  REQUIRE_THROWS_AS( failure.rethrow(), std::runtime_error );
+
+  TaskError out_of_memory;
+  out_of_memory.record(std::bad_alloc());
+  REQUIRE( out_of_memory.out_of_memory );
+  REQUIRE_THROWS_AS( out_of_memory.rethrow(), std::bad_alloc );
+}
@@ -63,4 +63,4 @@ TEST_CASE( "Test Levenshtein Distance", "[levenshtein]" ) {
   
   REQUIRE( levenshteinDistance("", "AAAA", 2) == 2 );
   REQUIRE( levenshteinDistance("BA", "AAAA", 2) == 2 );
-}
\ No newline at end of file
+}
@@ -0,0 +1,129 @@
+/*
+ * File:   test_videopipeline.cpp
+ *
+ * Tests for the order and shutdown of the video pipeline
+ */
+
+#include <cstdlib>
+#include "catch.hpp"
+#include "alpr_impl.h"
+#include "videopipeline.h"
+#include "opencv2/highgui/highgui.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace alpr;
+
+// Collects the callbacks in the order they arrive.  If hold_first is set, the callback for the first
+// frame holds up the recognition thread until released, so that frames back up behind it
+struct VideoRecorder
+{
+  VideoRecorder(bool hold_first) : hold_first(hold_first), first_started(false), released(false) {}
+
+  tthread::mutex mutex;
+  tthread::condition_variable changed;
+
+  bool hold_first;
+  bool first_started;
+  bool released;
+
+  vector<int64_t> frame_numbers;
+  vector<bool> processed;
+};
+
+static void recordVideoResults(AlprResults results, bool processed, void* user_data)
+{
+  VideoRecorder* recorder = (VideoRecorder*) user_data;
+  tthread::lock_guard<tthread::mutex> guard(recorder->mutex);
+
+  recorder->frame_numbers.push_back(results.frame_number);
+  recorder->processed.push_back(processed);
+
+  if (recorder->hold_first && !recorder->first_started)
+  {
+    recorder->first_started = true;
+    recorder->changed.notify_all();
+
+    while (!recorder->released)
+      recorder->changed.wait(recorder->mutex);
+  }
+}
+
+static void releaseVideoLater(void* arg)
+{
+  VideoRecorder* recorder = (VideoRecorder*) arg;
+
+  tthread::this_thread::sleep_for(tthread::chrono::milliseconds(100));
+
+  tthread::lock_guard<tthread::mutex> guard(recorder->mutex);
+  recorder->released = true;
+  recorder->changed.notify_all();
+}
+
+TEST_CASE( "Video pipeline order", "[videopipeline]" ) {
+
+  AlprImpl alpr("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  // Frames with and without a plate take different times in each stage
+  Mat plate = imread(std::string(OPENALPR_TESTING_RUNTIME_DIR) + "keypoints/us/ct2000.jpg");
+  REQUIRE( plate.data != NULL );
+  Mat blank = Mat::zeros(120, 160, CV_8UC3);
+
+  VideoRecorder recorder(false);
+  VideoPipeline pipeline(&alpr, 2);
+
+  for (int i = 0; i < 12; i++)
+  {
+    Mat& image = (i % 3 == 0) ? plate : blank;
+    AlprFrame frame(image.data, image.channels(), image.cols, image.rows);
+    REQUIRE( pipeline.submit(frame, recordVideoResults, &recorder) );
+  }
+  pipeline.waitForIdle();
+
+  REQUIRE( recorder.frame_numbers.size() == 12 );
+  for (unsigned int i = 0; i < recorder.frame_numbers.size(); i++)
+  {
+    REQUIRE( recorder.frame_numbers[i] == (int64_t) i );
+    REQUIRE( recorder.processed[i] );
+  }
+}
+
+TEST_CASE( "Video pipeline shutdown", "[videopipeline]" ) {
+
+  AlprImpl alpr("us", OPENALPR_TESTING_CONFIG_PATH, OPENALPR_TESTING_RUNTIME_DIR);
+  REQUIRE( alpr.isLoaded() );
+
+  Mat blank = Mat::zeros(120, 160, CV_8UC3);
+  AlprFrame frame(blank.data, blank.channels(), blank.cols, blank.rows);
+
+  VideoRecorder recorder(true);
+  VideoPipeline* pipeline = new VideoPipeline(&alpr, 1);
+
+  CHECK( pipeline->submit(frame, recordVideoResults, &recorder) );
+  {
+    tthread::lock_guard<tthread::mutex> guard(recorder.mutex);
+    while (!recorder.first_started)
+      recorder.changed.wait(recorder.mutex);
+  }
+
+  // Frame 1 waits for recognition and frame 2 waits for space in the recognition queue, so frame 3
+  // is left waiting for detection
+  CHECK( pipeline->submit(frame, recordVideoResults, &recorder) );
+  CHECK( pipeline->submit(frame, recordVideoResults, &recorder) );
+  CHECK( pipeline->submit(frame, recordVideoResults, &recorder) );
+
+  // Shutting down finishes the frames that were detected and drops the rest, still in order
+  tthread::thread releaser(releaseVideoLater, (void*) &recorder);
+  delete pipeline;
+  releaser.join();
+
+  REQUIRE( recorder.frame_numbers.size() == 4 );
+  for (unsigned int i = 0; i < recorder.frame_numbers.size(); i++)
+    REQUIRE( recorder.frame_numbers[i] == (int64_t) i );
+
+  REQUIRE( recorder.processed[0] );
+  REQUIRE( recorder.processed[1] );
+  REQUIRE( recorder.processed[2] );
+  REQUIRE( recorder.processed[3] == false );
+}